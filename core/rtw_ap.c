@@ -98,10 +98,21 @@ static void update_BCNTIM(_adapter *padapter)
 	if(_TRUE)
 	{
 		u8 *p, *dst_ie, *premainder_ie=NULL, *pbackup_remainder_ie=NULL;
-		u16 tim_bitmap_le;
 		uint offset, tmp_len, tim_ielen, tim_ie_offset, remainder_ielen;
+		int i, n1 = -1, n2 = 0;
 
-		tim_bitmap_le = cpu_to_le16(pstapriv->tim_bitmap);
+		// partial virtual bitmap: octets n1~n2 of tim_bitmap, n1 even, AID 0 left to bitmap ctrl
+		for (i = 0; i < pstapriv->tim_bitmap_len; i++)
+		{
+			if (pstapriv->tim_bitmap[i] & (i == 0 ? 0xfe : 0xff))
+			{
+				if (n1 < 0)
+					n1 = i & ~1;
+				n2 = i;
+			}
+		}
+		if (n1 < 0)
+			n1 = 0;
 
 		p = rtw_get_ie(pie + _FIXED_IE_LENGTH_, _TIM_IE_, &tim_ielen, pnetwork_mlmeext->IELength - _FIXED_IE_LENGTH_);
 		if (p != NULL && tim_ielen>0)
@@ -158,30 +169,20 @@ static void update_BCNTIM(_adapter *padapter)
 
 		*dst_ie++=_TIM_IE_;
 
-		if((pstapriv->tim_bitmap&0xff00) && (pstapriv->tim_bitmap&0x00fc))
-			tim_ielen = 5;
-		else
-			tim_ielen = 4;
+		tim_ielen = 3 + (n2 - n1 + 1);
 
 		*dst_ie++= tim_ielen;
 
 		*dst_ie++=0;//DTIM count
 		*dst_ie++=1;//DTIM peroid
 
-		if(pstapriv->tim_bitmap&BIT(0))//for bc/mc frames
-			*dst_ie++ = BIT(0);//bitmap ctrl
+		if(rtw_tim_map_is_set(pstapriv->tim_bitmap, 0))//for bc/mc frames
+			*dst_ie++ = BIT(0) | n1;//bitmap ctrl, offset in bit1~7
 		else
-			*dst_ie++ = 0;
+			*dst_ie++ = n1;
 
-		if(tim_ielen==4)
-		{
-			*dst_ie++ = *(u8*)&tim_bitmap_le;
-		}
-		else if(tim_ielen==5)
-		{
-			memcpy(dst_ie, &tim_bitmap_le, 2);
-			dst_ie+=2;
-		}
+		for (i = n1; i <= n2; i++)
+			*dst_ie++ = (i == 0) ? (pstapriv->tim_bitmap[0] & 0xfe) : pstapriv->tim_bitmap[i];
 
 		//copy remainder IE
 		if(pbackup_remainder_ie)
@@ -351,8 +352,8 @@ void	expire_timeout_chk(_adapter *padapter)
 	u8 updated;
 	struct sta_info *psta=NULL;
 	struct sta_priv *pstapriv = &padapter->stapriv;
-	u8 chk_alive_num = 0;
-	char chk_alive_list[NUM_STA];
+	u16 chk_alive_num = 0;
+	u8 chk_alive_list[NUM_STA_LIMIT];
 	int i;
 
 	_enter_critical_bh(&pstapriv->auth_list_lock, &irqL);
@@ -470,7 +471,7 @@ void	expire_timeout_chk(_adapter *padapter)
 					//DBG_871X("alive chk, sta:" MAC_FMT " is at ps mode!\n", MAC_ARG(psta->hwaddr));
 
 					//to update bcn with tim_bitmap for this station
-					pstapriv->tim_bitmap |= BIT(psta->aid);
+					rtw_tim_map_set(pstapriv->tim_bitmap, psta->aid);
 					update_beacon(padapter, _TIM_IE_, NULL, _TRUE);
 
 					if(!pmlmeext->active_keep_alive_check)
@@ -482,7 +483,7 @@ void	expire_timeout_chk(_adapter *padapter)
 				int stainfo_offset;
 
 				stainfo_offset = rtw_stainfo_offset(pstapriv, psta);
-				if (stainfo_offset_valid(stainfo_offset)) {
+				if (stainfo_offset_valid(pstapriv, stainfo_offset)) {
 					chk_alive_list[chk_alive_num++] = stainfo_offset;
 				}
 
@@ -529,7 +530,7 @@ if (chk_alive_num) {
 		int ret = _FAIL;
 
 		psta = rtw_get_stainfo_by_offset(pstapriv, chk_alive_list[i]);
-		if(!(psta->state &_FW_LINKED))
+		if(psta == NULL || !(psta->state &_FW_LINKED))
 			continue;
 
 		if (psta->state & WIFI_SLEEP_STATE)
@@ -571,6 +572,8 @@ if (chk_alive_num) {
 #endif /* CONFIG_ACTIVE_KEEP_ALIVE_CHECK */
 
 	associated_clients_update(padapter, updated);
+
+	rtw_shrink_stainfo(pstapriv);
 }
 
 
@@ -592,6 +595,10 @@ static void add_RATid(_adapter *padapter, struct sta_info *psta)
 	else
 		return;
 
+#ifdef CONFIG_TX_TMPL_CACHE
+	rtw_tx_tmpl_invalidate(padapter);
+#endif
+
 	//b/g mode ra_bitmap
 	for (i=0; i<sizeof(psta->bssrateset); i++)
 	{
@@ -754,8 +761,10 @@ static void add_RATid(_adapter *padapter, struct sta_info *psta)
 
 	raid = networktype_to_raid(sta_band);
 	init_rate = get_highest_rate_idx(tx_ra_bitmap&0x0fffffff)&0x3f;
+	psta->ra_mask = tx_ra_bitmap&0x0fffffff;
 
-	if (psta->aid < NUM_STA)
+	// stations past the MACID entries share the bc/mc one and its rate table
+	if (psta->aid + 1 < NUM_STA)
 	{
 		u8 arg = 0;
 
@@ -814,6 +823,10 @@ void update_bmc_sta(_adapter *padapter)
 
 		psta->ieee8021x_blocked = 0;
 
+#ifdef CONFIG_TX_TMPL_CACHE
+		rtw_tx_tmpl_invalidate(padapter);
+#endif
+
 		_rtw_memset((void*)&psta->sta_stats, 0, sizeof(struct stainfo_stats));
 
 		//psta->dot118021XPrivacy = _NO_PRIVACY_;//!!! remove it, because it has been set before this.
@@ -910,7 +923,19 @@ void update_sta_info_apmode(_adapter *padapter, struct sta_info *psta)
 	//psta->intf_tag = 0;
 
 	//psta->mac_id = psta->aid+4;
-	psta->mac_id = psta->aid+1;
+	if (psta->aid + 1 < NUM_STA) {
+		psta->mac_id = psta->aid+1;
+		psta->no_hw_key = _FALSE;
+	} else {
+		// out of hardware MACID entries, tx with the bc/mc one; rtw_camid_alloc()
+		// has no pairwise entry for it either, so its keys stay in software
+		psta->mac_id = 1;
+		psta->no_hw_key = _TRUE;
+	}
+
+#ifdef CONFIG_TX_TMPL_CACHE
+	rtw_tx_tmpl_invalidate(padapter);
+#endif
 
 	if(psecuritypriv->dot11AuthAlgrthm==dot11AuthAlgrthm_8021X)
 		psta->ieee8021x_blocked = _TRUE;
@@ -2644,8 +2669,8 @@ int rtw_sta_flush(_adapter *padapter)
 	struct mlme_ext_priv *pmlmeext = &padapter->mlmeextpriv;
 	struct mlme_ext_info	*pmlmeinfo = &(pmlmeext->mlmext_info);
 	u8 bc_addr[ETH_ALEN] = {0xff,0xff,0xff,0xff,0xff,0xff};
-	u8 chk_alive_num = 0;
-	char chk_alive_list[NUM_STA];
+	u16 chk_alive_num = 0;
+	u8 chk_alive_list[NUM_STA_LIMIT];
 	int i;
 
 	DBG_871X(FUNC_NDEV_FMT"\n", FUNC_NDEV_ARG(padapter->pnetdev));
@@ -2669,7 +2694,7 @@ int rtw_sta_flush(_adapter *padapter)
 
 		/* Keep sta for ap_free_sta() beyond this asoc_list loop */
 		stainfo_offset = rtw_stainfo_offset(pstapriv, psta);
-		if (stainfo_offset_valid(stainfo_offset)) {
+		if (stainfo_offset_valid(pstapriv, stainfo_offset)) {
 			chk_alive_list[chk_alive_num++] = stainfo_offset;
 		}
 	}
@@ -2679,7 +2704,8 @@ int rtw_sta_flush(_adapter *padapter)
 	/* For each sta in chk_alive_list, call ap_free_sta */
 	for (i = 0; i < chk_alive_num; i++) {
 		psta = rtw_get_stainfo_by_offset(pstapriv, chk_alive_list[i]);
-		ap_free_sta(padapter, psta, _TRUE, WLAN_REASON_DEAUTH_LEAVING);
+		if (psta)
+			ap_free_sta(padapter, psta, _TRUE, WLAN_REASON_DEAUTH_LEAVING);
 	}
 
 	issue_deauth(padapter, bc_addr, WLAN_REASON_DEAUTH_LEAVING);
@@ -2750,8 +2776,8 @@ void rtw_ap_restore_network(_adapter *padapter)
 	struct security_priv* psecuritypriv=&(padapter->securitypriv);
 	_irqL irqL;
 	_list	*phead, *plist;
-	u8 chk_alive_num = 0;
-	char chk_alive_list[NUM_STA];
+	u16 chk_alive_num = 0;
+	u8 chk_alive_list[NUM_STA_LIMIT];
 	int i;
 
 	rtw_setopmode_cmd(padapter, Ndis802_11APMode, _FALSE);
@@ -2779,7 +2805,7 @@ void rtw_ap_restore_network(_adapter *padapter)
 		plist = get_next(plist);
 
 		stainfo_offset = rtw_stainfo_offset(pstapriv, psta);
-		if (stainfo_offset_valid(stainfo_offset)) {
+		if (stainfo_offset_valid(pstapriv, stainfo_offset)) {
 			chk_alive_list[chk_alive_num++] = stainfo_offset;
 		}
 	}
@@ -2837,8 +2863,9 @@ void start_ap_mode(_adapter *padapter)
 	pmlmepriv->ht_op_mode = 0;
 #endif
 
-	for(i=0; i<NUM_STA; i++)
+	for(i=0; i<pstapriv->max_stainfo; i++)
 		pstapriv->sta_aid[i] = NULL;
+	_rtw_memset(pstapriv->aid_bitmap, 0, BITS_TO_LONGS(pstapriv->max_stainfo) * sizeof(unsigned long));
 
 	pmlmepriv->wps_beacon_ie = NULL;
 	pmlmepriv->wps_probe_resp_ie = NULL;
@@ -2920,4 +2947,310 @@ void stop_ap_mode(_adapter *padapter)
 }
 
 #endif //CONFIG_NATIVEAP_MLME
+
+#ifdef CONFIG_TX_MCAST2UNI
+/*
+ * IGMP/MLD snooping for the multicast to unicast conversion. Members are kept
+ * per (group MAC, station) and expire after the default membership interval,
+ * the querier on the wired side keeps them refreshed. Groups are keyed by the
+ * MAC they map to, the level the conversion works on.
+ */
+static u8 mc2u_member_expired(struct mc2u_member *member)
+{
+	return rtw_get_passing_time_ms(member->time) > MC2U_MEMBER_TIMEOUT_MS ? _TRUE : _FALSE;
+}
+
+static void mc2u_member_update(struct sta_priv *pstapriv, u8 *group, u8 *sta, u8 join)
+{
+	struct mc2u_member *member, *found = NULL, *slot = NULL;
+	_irqL irqL;
+	int i;
+
+	_enter_critical_bh(&pstapriv->mc2u_lock, &irqL);
+
+	for (i = 0; i < MC2U_MEMBER_NUM; i++) {
+		member = &pstapriv->mc2u_member[i];
+
+		if (member->used && mc2u_member_expired(member))
+			member->used = 0;
+
+		if (!member->used) {
+			if (slot == NULL)
+				slot = member;
+			continue;
+		}
+
+		if (_rtw_memcmp(member->group, group, ETH_ALEN) == _TRUE
+			&& _rtw_memcmp(member->sta, sta, ETH_ALEN) == _TRUE) {
+			found = member;
+			break;
+		}
+	}
+
+	if (join == _FALSE) {
+		if (found)
+			found->used = 0;
+	} else {
+		if (found == NULL && slot) {
+			found = slot;
+			memcpy(found->group, group, ETH_ALEN);
+			memcpy(found->sta, sta, ETH_ALEN);
+			found->used = 1;
+		}
+
+		if (found) {
+			found->time = rtw_get_current_time();
+		} else {
+			// a subscriber is not tracked, stop trusting the table for a while
+			pstapriv->mc2u_overflow = 1;
+			pstapriv->mc2u_overflow_time = rtw_get_current_time();
+		}
+	}
+
+	pstapriv->mc2u_report_cnt++;
+
+	_exit_critical_bh(&pstapriv->mc2u_lock, &irqL);
+}
+
+// 224.0.0.0/24 is always flooded, not tracked
+static u8 mc2u_ipv4_group(u8 *addr, u8 *group)
+{
+	if (addr[0] == 224 && addr[1] == 0 && addr[2] == 0)
+		return _FALSE;
+
+	group[0] = 0x01;
+	group[1] = 0x00;
+	group[2] = 0x5e;
+	group[3] = addr[1] & 0x7f;
+	group[4] = addr[2];
+	group[5] = addr[3];
+
+	return _TRUE;
+}
+
+// interface and link-local scope are always flooded, not tracked
+static u8 mc2u_ipv6_group(u8 *addr, u8 *group)
+{
+	if (addr[0] != 0xff || (addr[1] & 0x0f) <= 2)
+		return _FALSE;
+
+	group[0] = 0x33;
+	group[1] = 0x33;
+	memcpy(group + 2, addr + 12, 4);
+
+	return _TRUE;
+}
+
+static void mc2u_snoop_igmp(struct sta_priv *pstapriv, u8 *sta, u8 *ip, uint len)
+{
+	u8 group[ETH_ALEN];
+	u8 *igmp, *rec;
+	uint ihl, rec_len;
+	u16 nrec, nsrc;
+
+	if (len < 20 || ip[9] != 2) // IPPROTO_IGMP
+		return;
+
+	ihl = (ip[0] & 0x0f) * 4;
+	if (ihl < 20 || len < ihl + 8)
+		return;
+
+	igmp = ip + ihl;
+	len -= ihl;
+
+	switch (igmp[0]) {
+	case 0x12: // v1 report
+	case 0x16: // v2 report
+		if (mc2u_ipv4_group(igmp + 4, group) == _TRUE)
+			mc2u_member_update(pstapriv, group, sta, _TRUE);
+		break;
+
+	case 0x17: // v2 leave
+		if (mc2u_ipv4_group(igmp + 4, group) == _TRUE)
+			mc2u_member_update(pstapriv, group, sta, _FALSE);
+		break;
+
+	case 0x22: // v3 report
+		nrec = RTW_GET_BE16(igmp + 6);
+		rec = igmp + 8;
+		len -= 8;
+
+		while (nrec-- && len >= 8) {
+			nsrc = RTW_GET_BE16(rec + 2);
+			rec_len = 8 + nsrc * 4 + rec[1] * 4;
+			if (len < rec_len)
+				break;
+
+			if (mc2u_ipv4_group(rec + 4, group) == _TRUE) {
+				// INCLUDE with no source is a leave, BLOCK_OLD only removes sources
+				if ((rec[0] == 1 || rec[0] == 3) && nsrc == 0)
+					mc2u_member_update(pstapriv, group, sta, _FALSE);
+				else if (rec[0] != 6)
+					mc2u_member_update(pstapriv, group, sta, _TRUE);
+			}
+
+			rec += rec_len;
+			len -= rec_len;
+		}
+		break;
+	}
+}
+
+static void mc2u_snoop_mld(struct sta_priv *pstapriv, u8 *sta, u8 *ip, uint len)
+{
+	u8 group[ETH_ALEN];
+	u8 *icmp, *rec;
+	uint rec_len, ext_len;
+	u8 next;
+	u16 nrec, nsrc;
+
+	if (len < 40)
+		return;
+
+	// MLD is sent with a router alert in a hop-by-hop header
+	next = ip[6];
+	icmp = ip + 40;
+	len -= 40;
+	if (next == 0) {
+		if (len < 8)
+			return;
+		ext_len = (icmp[1] + 1) * 8;
+		if (len < ext_len)
+			return;
+		next = icmp[0];
+		icmp += ext_len;
+		len -= ext_len;
+	}
+
+	if (next != 58 || len < 24) // IPPROTO_ICMPV6
+		return;
+
+	switch (icmp[0]) {
+	case 131: // v1 report
+		if (mc2u_ipv6_group(icmp + 8, group) == _TRUE)
+			mc2u_member_update(pstapriv, group, sta, _TRUE);
+		break;
+
+	case 132: // v1 done
+		if (mc2u_ipv6_group(icmp + 8, group) == _TRUE)
+			mc2u_member_update(pstapriv, group, sta, _FALSE);
+		break;
+
+	case 143: // v2 report
+		nrec = RTW_GET_BE16(icmp + 6);
+		rec = icmp + 8;
+		len -= 8;
+
+		while (nrec-- && len >= 20) {
+			nsrc = RTW_GET_BE16(rec + 2);
+			rec_len = 20 + nsrc * 16 + rec[1] * 4;
+			if (len < rec_len)
+				break;
+
+			if (mc2u_ipv6_group(rec + 4, group) == _TRUE) {
+				if ((rec[0] == 1 || rec[0] == 3) && nsrc == 0)
+					mc2u_member_update(pstapriv, group, sta, _FALSE);
+				else if (rec[0] != 6)
+					mc2u_member_update(pstapriv, group, sta, _TRUE);
+			}
+
+			rec += rec_len;
+			len -= rec_len;
+		}
+		break;
+	}
+}
+
+// learn from a multicast ethernet frame a station sent
+void rtw_mc2u_snoop(_adapter *padapter, u8 *sta, u8 *frame, uint len)
+{
+	struct sta_priv *pstapriv = &padapter->stapriv;
+	u16 eth_type;
+
+	if (len < ETH_HLEN)
+		return;
+
+	eth_type = RTW_GET_BE16(frame + 12);
+	if (eth_type == ETH_P_IP)
+		mc2u_snoop_igmp(pstapriv, sta, frame + ETH_HLEN, len - ETH_HLEN);
+	else if (eth_type == ETH_P_IPV6)
+		mc2u_snoop_mld(pstapriv, sta, frame + ETH_HLEN, len - ETH_HLEN);
+}
+
+void rtw_mc2u_sta_leave(_adapter *padapter, u8 *sta)
+{
+	struct sta_priv *pstapriv = &padapter->stapriv;
+	_irqL irqL;
+	int i;
+
+	_enter_critical_bh(&pstapriv->mc2u_lock, &irqL);
+	for (i = 0; i < MC2U_MEMBER_NUM; i++) {
+		if (_rtw_memcmp(pstapriv->mc2u_member[i].sta, sta, ETH_ALEN) == _TRUE)
+			pstapriv->mc2u_member[i].used = 0;
+	}
+	_exit_critical_bh(&pstapriv->mc2u_lock, &irqL);
+}
+
+/*
+ * Subscribers of the group a multicast ethernet frame is sent to, up to max
+ * of them copied to members. len is what can be read contiguously at frame.
+ * Returns the number of subscribers, or -1 when the group is not tracked and
+ * every station has to get the frame.
+ */
+int rtw_mc2u_get_members(_adapter *padapter, u8 *frame, uint len, u8 (*members)[ETH_ALEN], int max)
+{
+	struct sta_priv *pstapriv = &padapter->stapriv;
+	struct mc2u_member *member;
+	u8 group[ETH_ALEN];
+	u16 eth_type;
+	_irqL irqL;
+	int i, num = 0;
+
+	if (len < ETH_HLEN)
+		return -1;
+
+	eth_type = RTW_GET_BE16(frame + 12);
+	if (eth_type == ETH_P_IP && len >= ETH_HLEN + 20) {
+		if (mc2u_ipv4_group(frame + ETH_HLEN + 16, group) == _FALSE)
+			return -1;
+	} else if (eth_type == ETH_P_IPV6 && len >= ETH_HLEN + 40) {
+		if (mc2u_ipv6_group(frame + ETH_HLEN + 24, group) == _FALSE)
+			return -1;
+	} else {
+		return -1;
+	}
+
+	_enter_critical_bh(&pstapriv->mc2u_lock, &irqL);
+
+	if (pstapriv->mc2u_overflow) {
+		if (rtw_get_passing_time_ms(pstapriv->mc2u_overflow_time) <= MC2U_MEMBER_TIMEOUT_MS) {
+			num = -1;
+			goto exit;
+		}
+		pstapriv->mc2u_overflow = 0;
+	}
+
+	for (i = 0; i < MC2U_MEMBER_NUM; i++) {
+		member = &pstapriv->mc2u_member[i];
+
+		if (!member->used || _rtw_memcmp(member->group, group, ETH_ALEN) == _FALSE)
+			continue;
+
+		if (mc2u_member_expired(member)) {
+			member->used = 0;
+			continue;
+		}
+
+		if (num < max)
+			memcpy(members[num], member->sta, ETH_ALEN);
+		num++;
+	}
+
+exit:
+	_exit_critical_bh(&pstapriv->mc2u_lock, &irqL);
+
+	return num;
+}
+#endif	// CONFIG_TX_MCAST2UNI
+
 #endif //CONFIG_AP_MODE
@@ -24,6 +24,9 @@
 #include <net/ip.h>
 #include <linux/udp.h>
 #include <linux/if_pppox.h>
+#include <linux/jhash.h>
+#include <linux/percpu.h>
+#include <linux/random.h>
 #endif
 
 #if 1	// rtw_wifi_driver
@@ -82,8 +85,6 @@
 
 void dhcp_flag_bcast(_adapter *priv, struct sk_buff *skb);
 int nat25_handle_frame(_adapter *priv, struct sk_buff *skb);
-void *scdb_findEntry(_adapter *priv, unsigned char *macAddr,
-				unsigned char *ipAddr);
 void nat25_db_expire(_adapter *priv);
 int nat25_db_handle(_adapter *priv, struct sk_buff *skb, int method);
 
@@ -332,64 +333,10 @@ static void convert_ipv6_mac_to_mc(struct sk_buff *skb)
 #endif /* CL_IPV6_PASS */
 
 
-static __inline__ int __nat25_network_hash(unsigned char *networkAddr)
+static __inline__ int __nat25_network_hash(_adapter *priv, unsigned char *networkAddr)
 {
-	if(networkAddr[0] == NAT25_IPV4)
-	{
-		unsigned long x;
-
-		x = networkAddr[7] ^ networkAddr[8] ^ networkAddr[9] ^ networkAddr[10];
-
-		return x & (NAT25_HASH_SIZE - 1);
-	}
-	else if(networkAddr[0] == NAT25_IPX)
-	{
-		unsigned long x;
-
-		x = networkAddr[1] ^ networkAddr[2] ^ networkAddr[3] ^ networkAddr[4] ^ networkAddr[5] ^
-			networkAddr[6] ^ networkAddr[7] ^ networkAddr[8] ^ networkAddr[9] ^ networkAddr[10];
-
-		return x & (NAT25_HASH_SIZE - 1);
-	}
-	else if(networkAddr[0] == NAT25_APPLE)
-	{
-		unsigned long x;
-
-		x = networkAddr[1] ^ networkAddr[2] ^ networkAddr[3];
-
-		return x & (NAT25_HASH_SIZE - 1);
-	}
-	else if(networkAddr[0] == NAT25_PPPOE)
-	{
-		unsigned long x;
-
-		x = networkAddr[0] ^ networkAddr[1] ^ networkAddr[2] ^ networkAddr[3] ^ networkAddr[4] ^ networkAddr[5] ^ networkAddr[6] ^ networkAddr[7] ^ networkAddr[8];
-
-		return x & (NAT25_HASH_SIZE - 1);
-	}
-#ifdef CL_IPV6_PASS
-	else if(networkAddr[0] == NAT25_IPV6)
-	{
-		unsigned long x;
-
-		x = networkAddr[1] ^ networkAddr[2] ^ networkAddr[3] ^ networkAddr[4] ^ networkAddr[5] ^
-			networkAddr[6] ^ networkAddr[7] ^ networkAddr[8] ^ networkAddr[9] ^ networkAddr[10] ^
-			networkAddr[11] ^ networkAddr[12] ^ networkAddr[13] ^ networkAddr[14] ^ networkAddr[15] ^
-			networkAddr[16];
-
-		return x & (NAT25_HASH_SIZE - 1);
-	}
-#endif
-	else
-	{
-		unsigned long x = 0;
-		int i;
-
-		for (i=0; i<MAX_NETWORK_ADDR_LEN; i++)
-			x ^= networkAddr[i];
-
-		return x & (NAT25_HASH_SIZE - 1);
-	}
+	// unused tail bytes of networkAddr are always zeroed by the generators
+	return jhash(networkAddr, MAX_NETWORK_ADDR_LEN, priv->nat25_hash_seed) & (NAT25_HASH_SIZE - 1);
 }
 
 
@@ -403,8 +350,9 @@ static __inline__ void __network_hash_link(_adapter *priv,
 	ent->next_hash = priv->nethash[hash];
 	if(ent->next_hash != NULL)
 		ent->next_hash->pprev_hash = &ent->next_hash;
-	priv->nethash[hash] = ent;
 	ent->pprev_hash = &priv->nethash[hash];
+	// publish only after ent is fully set up, readers do not take the lock
+	rcu_assign_pointer(priv->nethash[hash], ent);
 
 	//_exit_critical_bh(&priv->br_ext_lock, &irqL);
 }
@@ -419,21 +367,92 @@ static __inline__ void __network_hash_unlink(struct nat25_network_db_entry *ent)
 	*(ent->pprev_hash) = ent->next_hash;
 	if(ent->next_hash != NULL)
 		ent->next_hash->pprev_hash = ent->pprev_hash;
-	ent->next_hash = NULL;
+	// keep ent->next_hash, an RCU reader may still be standing on ent
 	ent->pprev_hash = NULL;
 
 	//_exit_critical_bh(&priv->br_ext_lock, &irqL);
 }
 
 
+static void __nat25_db_free_rcu(struct rcu_head *head)
+{
+	struct nat25_network_db_entry *db = container_of(head, struct nat25_network_db_entry, rcu);
+
+	rtw_mfree((u8 *) db, sizeof(struct nat25_network_db_entry));
+}
+
+
+static __inline__ void __network_hash_unlink_free(_adapter *priv, struct nat25_network_db_entry *ent)
+{
+	// Caller must _enter_critical_bh already!
+	__network_hash_unlink(ent);
+
+	// invalidate every cached flow before the entry can be reclaimed;
+	// atomic_inc_return() orders the unlink and the bump against call_rcu()
+	atomic_inc_return(&priv->nat25_flow_gen);
+	call_rcu(&ent->rcu, __nat25_db_free_rcu);
+}
+
+
+/*
+ *	Per-CPU IPv4 flow cache, in front of the hash table on both the TX and
+ *	RX fast paths. Caller must hold rcu_read_lock() and have preemption off.
+ */
+static struct nat25_flow_entry *__nat25_flow_find(_adapter *priv,
+				struct nat25_flow_cache *fc, unsigned char *ipAddr, unsigned char *macAddr)
+{
+	struct nat25_flow_entry tmp;
+	u32 gen = atomic_read(&priv->nat25_flow_gen);
+	int i;
+
+	for (i=0; i<NAT25_FLOW_CACHE_NUM; i++)
+	{
+		struct nat25_flow_entry *fe = &fc->entry[i];
+
+		if (fe->gen != gen || memcmp(fe->ipAddr, ipAddr, 4))
+			continue;
+		if (macAddr && memcmp(fe->macAddr, macAddr, ETH_ALEN))
+			continue;
+
+		if (i) {
+			// move to front
+			tmp = *fe;
+			memmove(&fc->entry[1], &fc->entry[0], i * sizeof(struct nat25_flow_entry));
+			fc->entry[0] = tmp;
+		}
+		return &fc->entry[0];
+	}
+
+	return NULL;
+}
+
+
+static void __nat25_flow_add(_adapter *priv, struct nat25_flow_cache *fc,
+				struct nat25_network_db_entry *db, u32 gen)
+{
+	struct nat25_flow_entry *fe = &fc->entry[0];
+
+	// the least recently used entry falls off the tail
+	memmove(&fc->entry[1], &fc->entry[0], (NAT25_FLOW_CACHE_NUM - 1) * sizeof(struct nat25_flow_entry));
+	fe->db = db;
+	fe->gen = gen;
+	memcpy(fe->ipAddr, db->networkAddr+7, 4);
+	memcpy(fe->macAddr, db->macAddr, ETH_ALEN);
+}
+
+
 static int __nat25_db_network_lookup_and_replace(_adapter *priv,
 				struct sk_buff *skb, unsigned char *networkAddr)
 {
 	struct nat25_network_db_entry *db;
-	_irqL irqL;
-	_enter_critical_bh(&priv->br_ext_lock, &irqL);
+	u32 gen;
+
+	rcu_read_lock();
+	// sample gen before the walk, so a flow cached below is never newer than its entry
+	gen = atomic_read(&priv->nat25_flow_gen);
+	smp_rmb();
 
-	db = priv->nethash[__nat25_network_hash(networkAddr)];
+	db = rcu_dereference(priv->nethash[__nat25_network_hash(priv, networkAddr)]);
 	while (db != NULL)
 	{
 		if(!memcmp(db->networkAddr, networkAddr, MAX_NETWORK_ADDR_LEN))
@@ -444,6 +463,11 @@ static int __nat25_db_network_lookup_and_replace(_adapter *priv,
 				memcpy(skb->data, db->macAddr, ETH_ALEN);
 				atomic_inc(&db->use_count);
 
+				if (networkAddr[0] == NAT25_IPV4) {
+					__nat25_flow_add(priv, per_cpu_ptr(priv->nat25_flow, get_cpu()), db, gen);
+					put_cpu();
+				}
+
 #ifdef CL_IPV6_PASS
 				DEBUG_INFO("NAT25: Lookup M:%02x%02x%02x%02x%02x%02x N:%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x"
 							"%02x%02x%02x%02x%02x%02x\n",
@@ -491,14 +515,14 @@ static int __nat25_db_network_lookup_and_replace(_adapter *priv,
 					db->networkAddr[10]);
 #endif
 			}
-			_exit_critical_bh(&priv->br_ext_lock, &irqL);
+			rcu_read_unlock();
 			return 1;
 		}
 
-		db = db->next_hash;
+		db = rcu_dereference(db->next_hash);
 	}
 
-	_exit_critical_bh(&priv->br_ext_lock, &irqL);
+	rcu_read_unlock();
 	return 0;
 }
 
@@ -511,16 +535,22 @@ static void __nat25_db_network_insert(_adapter *priv,
 	_irqL irqL;
 	_enter_critical_bh(&priv->br_ext_lock, &irqL);
 
-	hash = __nat25_network_hash(networkAddr);
+	hash = __nat25_network_hash(priv, networkAddr);
 	db = priv->nethash[hash];
 	while (db != NULL)
 	{
 		if(!memcmp(db->networkAddr, networkAddr, MAX_NETWORK_ADDR_LEN))
 		{
-			memcpy(db->macAddr, macAddr, ETH_ALEN);
-			db->ageing_timer = jiffies;
-			_exit_critical_bh(&priv->br_ext_lock, &irqL);
-			return;
+			if (!memcmp(db->macAddr, macAddr, ETH_ALEN)) {
+				db->ageing_timer = jiffies;
+				_exit_critical_bh(&priv->br_ext_lock, &irqL);
+				return;
+			}
+
+			// the address moved to another host: replace the entry instead of
+			// rewriting macAddr under the feet of lockless readers
+			__network_hash_unlink_free(priv, db);
+			break;
 		}
 
 		db = db->next_hash;
@@ -632,6 +662,35 @@ static void __nat25_db_print(_adapter *priv)
  *	NAT2.5 interface
  */
 
+int nat25_db_init(_adapter *priv)
+{
+	priv->nat25_flow = alloc_percpu(struct nat25_flow_cache);
+	if (priv->nat25_flow == NULL)
+		return _FAIL;
+
+	// a zeroed flow cache entry (gen 0) never matches
+	atomic_set(&priv->nat25_flow_gen, 1);
+	priv->nat25_expire_idx = 0;
+	get_random_bytes(&priv->nat25_hash_seed, sizeof(priv->nat25_hash_seed));
+
+	return _SUCCESS;
+}
+
+
+void nat25_db_deinit(_adapter *priv)
+{
+	nat25_db_cleanup(priv);
+
+	// wait for the call_rcu() frees queued by the cleanup
+	rcu_barrier();
+
+	if (priv->nat25_flow) {
+		free_percpu(priv->nat25_flow);
+		priv->nat25_flow = NULL;
+	}
+}
+
+
 void nat25_db_cleanup(_adapter *priv)
 {
 	int i;
@@ -646,14 +705,7 @@ void nat25_db_cleanup(_adapter *priv)
 			struct nat25_network_db_entry *g;
 
 			g = f->next_hash;
-			if(priv->scdb_entry == f)
-			{
-				memset(priv->scdb_mac, 0, ETH_ALEN);
-				memset(priv->scdb_ip, 0, 4);
-				priv->scdb_entry = NULL;
-			}
-			__network_hash_unlink(f);
-			rtw_mfree((u8 *) f, sizeof(struct nat25_network_db_entry));
+			__network_hash_unlink_free(priv, f);
 
 			f = g;
 		}
@@ -663,17 +715,25 @@ void nat25_db_cleanup(_adapter *priv)
 }
 
 
+/*
+ *	Called from the periodic watchdog. Only NAT25_EXPIRE_BUCKETS buckets are
+ *	visited per call, so the lock hold time stays bounded as the table grows.
+ */
 void nat25_db_expire(_adapter *priv)
 {
-	int i;
+	int i, n;
 	_irqL irqL;
 	_enter_critical_bh(&priv->br_ext_lock, &irqL);
 
 	//if(!priv->ethBrExtInfo.nat25_disable)
 	{
-		for (i=0; i<NAT25_HASH_SIZE; i++)
+		for (n=0; n<NAT25_EXPIRE_BUCKETS; n++)
 		{
 			struct nat25_network_db_entry *f;
+
+			i = priv->nat25_expire_idx;
+			priv->nat25_expire_idx = (i + 1) & (NAT25_HASH_SIZE - 1);
+
 			f = priv->nethash[i];
 
 			while (f != NULL)
@@ -736,14 +796,7 @@ void nat25_db_expire(_adapter *priv)
 							f->networkAddr[10]);
 #endif
 #endif
-						if(priv->scdb_entry == f)
-						{
-							memset(priv->scdb_mac, 0, ETH_ALEN);
-							memset(priv->scdb_ip, 0, 4);
-							priv->scdb_entry = NULL;
-						}
-						__network_hash_unlink(f);
-						rtw_mfree((u8 *) f, sizeof(struct nat25_network_db_entry));
+						__network_hash_unlink_free(priv, f);
 					}
 				}
 
@@ -1260,25 +1313,28 @@ int nat25_handle_frame(_adapter *priv, struct sk_buff *skb)
 
 		if (!priv->ethBrExtInfo.nat25_disable)
 		{
-			_irqL irqL;
-			_enter_critical_bh(&priv->br_ext_lock, &irqL);
+			struct nat25_flow_entry *fe = NULL;
+
 			/*
 			 *	This function look up the destination network address from
 			 *	the NAT2.5 database. Return value = -1 means that the
 			 *	corresponding network protocol is NOT support.
 			 */
 			if (!priv->ethBrExtInfo.nat25sc_disable &&
-				(*((unsigned short *)(skb->data+ETH_ALEN*2)) == __constant_htons(ETH_P_IP)) &&
-				!memcmp(priv->scdb_ip, skb->data+ETH_HLEN+16, 4)) {
-				memcpy(skb->data, priv->scdb_mac, ETH_ALEN);
-
-				_exit_critical_bh(&priv->br_ext_lock, &irqL);
+				(*((unsigned short *)(skb->data+ETH_ALEN*2)) == __constant_htons(ETH_P_IP))) {
+				rcu_read_lock();
+				fe = __nat25_flow_find(priv, per_cpu_ptr(priv->nat25_flow, get_cpu()),
+						skb->data+ETH_HLEN+16, NULL);
+				if (fe && !__nat25_has_expired(priv, fe->db))
+					memcpy(skb->data, fe->macAddr, ETH_ALEN);
+				else
+					fe = NULL;
+				put_cpu();
+				rcu_read_unlock();
 			}
-			else {
-				_exit_critical_bh(&priv->br_ext_lock, &irqL);
 
+			if (fe == NULL)
 				retval = nat25_db_handle(priv, skb, NAT25_LOOKUP);
-			}
 		}
 		else {
 			if (((*((unsigned short *)(skb->data+ETH_ALEN*2)) == __constant_htons(ETH_P_IP)) &&
@@ -1410,30 +1466,53 @@ void dhcp_flag_bcast(_adapter *priv, struct sk_buff *skb)
 }
 
 
-void *scdb_findEntry(_adapter *priv, unsigned char *macAddr,
+/*
+ *	TX fast path: returns 1 when (macAddr, ipAddr) is a known IPv4 mapping,
+ *	refreshing its age, so the caller can skip nat25_db_handle().
+ */
+int nat25_flow_tx_lookup(_adapter *priv, unsigned char *macAddr,
 				unsigned char *ipAddr)
 {
 	unsigned char networkAddr[MAX_NETWORK_ADDR_LEN];
+	struct nat25_flow_cache *fc;
+	struct nat25_flow_entry *fe;
 	struct nat25_network_db_entry *db;
-	int hash;
-	//_irqL irqL;
-	//_enter_critical_bh(&priv->br_ext_lock, &irqL);
+	u32 gen;
+	int ret = 0;
+
+	rcu_read_lock();
+	fc = per_cpu_ptr(priv->nat25_flow, get_cpu());
+
+	fe = __nat25_flow_find(priv, fc, ipAddr, macAddr);
+	if (fe) {
+		fe->db->ageing_timer = jiffies;
+		ret = 1;
+		goto exit;
+	}
+
+	gen = atomic_read(&priv->nat25_flow_gen);
+	smp_rmb();
 
 	__nat25_generate_ipv4_network_addr(networkAddr, (unsigned int *)ipAddr);
-	hash = __nat25_network_hash(networkAddr);
-	db = priv->nethash[hash];
+	db = rcu_dereference(priv->nethash[__nat25_network_hash(priv, networkAddr)]);
 	while (db != NULL)
 	{
 		if(!memcmp(db->networkAddr, networkAddr, MAX_NETWORK_ADDR_LEN)) {
-			//_exit_critical_bh(&priv->br_ext_lock, &irqL);
-			return (void *)db;
+			if (!memcmp(db->macAddr, macAddr, ETH_ALEN)) {
+				db->ageing_timer = jiffies;
+				__nat25_flow_add(priv, fc, db, gen);
+				ret = 1;
+			}
+			break;
 		}
 
-		db = db->next_hash;
+		db = rcu_dereference(db->next_hash);
 	}
 
-	//_exit_critical_bh(&priv->br_ext_lock, &irqL);
-	return NULL;
+exit:
+	put_cpu();
+	rcu_read_unlock();
+	return ret;
 }
 
 #endif	// CONFIG_BR_EXT
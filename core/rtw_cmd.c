@@ -121,6 +121,7 @@ exit:
 #ifdef CONFIG_C2H_WK
 	_init_workitem(&pevtpriv->c2h_wk, c2h_wk_callback, NULL);
 	pevtpriv->c2h_wk_alive = _FALSE;
+	pevtpriv->cpwm_pending = _FALSE;
 	pevtpriv->c2h_queue = rtw_cbuf_alloc(C2H_QUEUE_MAX_LEN+1);
 #endif
 
@@ -1455,6 +1456,13 @@ _func_enter_;
 		memcpy(&psetstakey_para->key, &psecuritypriv->dot118021XGrpKey[psecuritypriv->dot118021XGrpKeyid].skey, 16);
 	}
 
+	if (psetstakey_para->algorithm == _AES_) {
+		if (unicast_key == _TRUE)
+			rtw_aes_key_setup(sta->aes_rk, psetstakey_para->key);
+		else
+			rtw_aes_key_setup(psecuritypriv->dot118021XGrpKey_rk[psecuritypriv->dot118021XGrpKeyid], psetstakey_para->key);
+	}
+
 	//jeff: set this becasue at least sw key is ready
 	padapter->securitypriv.busetkipkey=_TRUE;
 
@@ -2538,11 +2546,11 @@ static void rtw_chk_hi_queue_hdl(_adapter *padapter)
 		{
 			bool update_tim = _FALSE;
 
-			if (pstapriv->tim_bitmap & BIT(0))
+			if (rtw_tim_map_is_set(pstapriv->tim_bitmap, 0))
 				update_tim = _TRUE;
 
-			pstapriv->tim_bitmap &= ~BIT(0);
-			pstapriv->sta_dz_bitmap &= ~BIT(0);
+			rtw_tim_map_clear(pstapriv->tim_bitmap, 0);
+			rtw_tim_map_clear(pstapriv->sta_dz_bitmap, 0);
 
 			if (update_tim == _TRUE)
 				_update_beacon(padapter, _TIM_IE_, NULL, _TRUE, "bmc sleepq and HIQ empty");
@@ -2650,41 +2658,73 @@ exit:
 }
 
 #ifdef CONFIG_C2H_WK
+static void c2h_wk_dispatch(_adapter *adapter, struct c2h_evt_hdr *c2h_evt, c2h_id_filter ccx_id_filter)
+{
+	if (!c2h_evt_exist(c2h_evt)) {
+		rtw_mfree((u8*)c2h_evt, 16);
+		return;
+	}
+
+	if (ccx_id_filter(c2h_evt->id) == _TRUE) {
+		/* Handle CCX report here */
+		rtw_hal_c2h_handler(adapter, c2h_evt);
+		rtw_mfree((u8*)c2h_evt, 16);
+	} else {
+		/* Enqueue into cmd_thread for others */
+		rtw_c2h_wk_cmd(adapter, (u8 *)c2h_evt);
+	}
+}
+
 static void c2h_wk_callback(_workitem *work)
 {
 	struct evt_priv *evtpriv = container_of(work, struct evt_priv, c2h_wk);
 	_adapter *adapter = container_of(evtpriv, _adapter, evtpriv);
 	struct c2h_evt_hdr *c2h_evt;
 	c2h_id_filter ccx_id_filter = rtw_hal_c2h_id_filter_ccx(adapter);
+	int i;
 
 	evtpriv->c2h_wk_alive = _TRUE;
 
+#ifdef CONFIG_LPS_LCLK
+	if (evtpriv->cpwm_pending == _TRUE) {
+		struct reportpwrstate_parm report;
+
+		evtpriv->cpwm_pending = _FALSE;
+		rtw_hal_get_hwreg(adapter, HW_VAR_CPWM, &report.state);
+		cpwm_int_hdl(adapter, &report);
+	}
+#else
+	evtpriv->cpwm_pending = _FALSE;
+#endif
+
 	while (!rtw_cbuf_empty(evtpriv->c2h_queue)) {
 		if ((c2h_evt = (struct c2h_evt_hdr *)rtw_cbuf_pop(evtpriv->c2h_queue)) != NULL) {
 			/* This C2H event is read, clear it */
 			c2h_evt_clear(adapter);
-		} else if ((c2h_evt = kzalloc(16), in_interrupt() ? GFP_ATOMIC : GFP_KERNEL) != NULL) {
-			/* This C2H event is not read, read & clear now */
-			if (c2h_evt_read(adapter, (u8*)c2h_evt) != _SUCCESS)
-				continue;
-		}
 
-		/* Special pointer to trigger c2h_evt_clear only */
-		if ((void *)c2h_evt == (void *)evtpriv)
-			continue;
+			/* Special pointer to trigger c2h_evt_clear only */
+			if ((void *)c2h_evt == (void *)evtpriv)
+				continue;
 
-		if (!c2h_evt_exist(c2h_evt)) {
-			rtw_mfree((u8*)c2h_evt, 16);
+			c2h_wk_dispatch(adapter, c2h_evt, ccx_id_filter);
 			continue;
 		}
 
-		if (ccx_id_filter(c2h_evt->id) == _TRUE) {
-			/* Handle CCX report here */
-			rtw_hal_c2h_handler(adapter, c2h_evt);
-			rtw_mfree((u8*)c2h_evt, 16);
-		} else {
-			/* Enqueue into cmd_thread for others */
-			rtw_c2h_wk_cmd(adapter, (u8 *)c2h_evt);
+		/*
+		 * This C2H event is not read, read & clear now. FW posts the next
+		 * event as soon as the previous one is cleared, so keep draining
+		 * until nothing is pending instead of waiting for another kick.
+		 */
+		for (i = 0; i < C2H_EVT_BATCH_MAX; i++) {
+			if ((c2h_evt = kzalloc(16, in_interrupt() ? GFP_ATOMIC : GFP_KERNEL)) == NULL)
+				break;
+
+			if (c2h_evt_read(adapter, (u8*)c2h_evt) != _SUCCESS) {
+				rtw_mfree((u8*)c2h_evt, 16);
+				break;
+			}
+
+			c2h_wk_dispatch(adapter, c2h_evt, ccx_id_filter);
 		}
 	}
 
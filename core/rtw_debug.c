@@ -584,7 +584,325 @@ int proc_get_trx_info(struct seq_file *m, void *v)
 		phwxmit = pxmitpriv->hwxmits + i;
 		DBG_871X_SEL_NL(m, "%d, hwq.accnt=%d\n", i, phwxmit->accnt);
 	}
-	DBG_871X_SEL_NL(m, "rx_urb_pending_cnt=%d\n", precvpriv->rx_pending_cnt);
+	DBG_871X_SEL_NL(m, "rx_urb_pending_cnt=%d\n", ATOMIC_READ(&precvpriv->rx_pending_cnt));
+#ifdef CONFIG_TX_TMPL_CACHE
+	DBG_871X_SEL_NL(m, "tx_tmpl_gen=%u, tx_tmpl_hit=%u, tx_tmpl_miss=%u\n"
+		, pxmitpriv->tx_tmpl_gen, pxmitpriv->tx_tmpl_hit, pxmitpriv->tx_tmpl_miss);
+#endif
+#ifdef CONFIG_USB_TX_SG
+	DBG_871X_SEL_NL(m, "tx_sg_en=%u, tx_sg_pkt_cnt=%u, tx_sg_bytes=%llu\n"
+		, pxmitpriv->tx_sg_en, pxmitpriv->tx_sg_pkt_cnt, (unsigned long long)pxmitpriv->tx_sg_bytes);
+#endif
+#ifdef CONFIG_RTW_TX_GSO
+	DBG_871X_SEL_NL(m, "tx_gso_cnt=%u, tx_gso_segs=%u, tx_gso_busy=%u\n"
+		, pxmitpriv->tx_gso_cnt, pxmitpriv->tx_gso_segs, pxmitpriv->tx_gso_busy);
+#endif
+#ifdef CONFIG_RTW_NAPI
+	DBG_871X_SEL_NL(m, "napi_en=%u, gro_en=%u, napi_poll_cnt=%u, napi_budget_cnt=%u, gro_merged_cnt=%u, rx_napi_skb_queue=%u\n"
+		, precvpriv->napi_en, precvpriv->gro_en, precvpriv->napi_poll_cnt, precvpriv->napi_budget_cnt
+		, precvpriv->gro_merged_cnt, skb_queue_len(&precvpriv->rx_napi_skb_queue));
+#endif
+
+	return 0;
+}
+
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+int proc_get_tx_agg(struct seq_file *m, void *v)
+{
+	struct net_device *dev = m->private;
+	_adapter *padapter = (_adapter *)rtw_netdev_priv(dev);
+	struct xmit_priv *pxmitpriv = &padapter->xmitpriv;
+	const char *ac_str[] = {"VO", "VI", "BE", "BK"};
+	int i;
+
+	DBG_871X_SEL_NL(m, "%-3s %7s %8s %9s %7s %10s %10s %9s %9s %8s %8s\n"
+		, "ac", "max_len", "max_desc", "budget_us", "lat_us"
+		, "urb_cnt", "pkt_cnt", "len_stop", "desc_stop", "grow", "shrink");
+
+	for (i = VO_QUEUE_INX; i <= BK_QUEUE_INX; i++) {
+		struct tx_agg_ctrl *pctrl = &pxmitpriv->tx_agg_ctrl[i];
+
+		DBG_871X_SEL_NL(m, "%-3s %7u %8u %9u %7u %10u %10u %9u %9u %8u %8u\n"
+			, ac_str[i], pctrl->max_len, pctrl->max_desc, pctrl->budget_us, pctrl->lat_us
+			, pctrl->urb_cnt, pctrl->pkt_cnt, pctrl->len_stop_cnt, pctrl->desc_stop_cnt
+			, pctrl->grow_cnt, pctrl->shrink_cnt);
+	}
+
+	return 0;
+}
+
+ssize_t proc_set_tx_agg(struct file *file, const char __user *buffer, size_t count, loff_t *pos, void *data)
+{
+	struct net_device *dev = data;
+	_adapter *padapter = (_adapter *)rtw_netdev_priv(dev);
+	char tmp[32];
+	u32 budget_us;
+
+	if (count < 1)
+		return -EFAULT;
+
+	if (count > sizeof(tmp) - 1)
+		count = sizeof(tmp) - 1;
+
+	if (buffer && !copy_from_user(tmp, buffer, count)) {
+		tmp[count] = '\0';
+
+		if (sscanf(tmp, "%u", &budget_us) != 1) {
+			DBG_871X("invalid tx_agg parameter, usage: <BE/BK latency budget in us>\n");
+			return count;
+		}
+
+		padapter->registrypriv.tx_agg_budget = budget_us;
+		rtw_tx_agg_set_budget(padapter, budget_us);
+	}
+
+	return count;
+}
+#endif //CONFIG_USB_TX_AGG_ADAPTIVE
+
+#ifdef CONFIG_USB_RX_AGG_TUNE
+static const char *rx_agg_lvl_str(u8 level)
+{
+	switch (level) {
+	case RX_AGG_LVL_LATENCY:
+		return "latency";
+	case RX_AGG_LVL_MID:
+		return "mid";
+	case RX_AGG_LVL_BULK:
+		return "bulk";
+	default:
+		return "unknown";
+	}
+}
+
+int proc_get_rx_agg(struct seq_file *m, void *v)
+{
+	struct net_device *dev = m->private;
+	_adapter *padapter = (_adapter *)rtw_netdev_priv(dev);
+	struct rx_agg_tune *ptune = &padapter->recvpriv.rx_agg_tune;
+	u32 now = rtw_get_current_time();
+	int i, idx;
+
+	DBG_871X_SEL_NL(m, "level=%s%s%s, pps=%u, avg_sz=%u, change_cnt=%u\n"
+		, rx_agg_lvl_str(ptune->level), ptune->fixed >= 0 ? " (fixed)" : ""
+		, ptune->force_off ? " (off by mlme)" : ""
+		, ptune->pps, ptune->avg_sz, ptune->change_cnt);
+
+	DBG_871X_SEL_NL(m, "%8s %-8s %-8s %8s %6s\n", "ago_ms", "from", "to", "pps", "avg_sz");
+	for (i = 0; i < RX_AGG_HIST_NUM; i++) {
+		struct rx_agg_hist *phist;
+
+		// newest first
+		idx = (ptune->hist_idx + RX_AGG_HIST_NUM - 1 - i) % RX_AGG_HIST_NUM;
+		phist = &ptune->hist[idx];
+		if (phist->time == 0)
+			break;
+
+		DBG_871X_SEL_NL(m, "%8d %-8s %-8s %8u %6u\n"
+			, rtw_get_time_interval_ms(phist->time, now)
+			, rx_agg_lvl_str(phist->from), rx_agg_lvl_str(phist->to)
+			, phist->pps, phist->avg_sz);
+	}
+
+	return 0;
+}
+
+ssize_t proc_set_rx_agg(struct file *file, const char __user *buffer, size_t count, loff_t *pos, void *data)
+{
+	struct net_device *dev = data;
+	_adapter *padapter = (_adapter *)rtw_netdev_priv(dev);
+	char tmp[32];
+	int level;
+	s8 val;
+
+	if (count < 1)
+		return -EFAULT;
+
+	if (count > sizeof(tmp) - 1)
+		count = sizeof(tmp) - 1;
+
+	if (buffer && !copy_from_user(tmp, buffer, count)) {
+		tmp[count] = '\0';
+
+		if (sscanf(tmp, "%d", &level) != 1) {
+			DBG_871X("invalid rx_agg parameter, usage: <-1:auto, 0:latency, 1:mid, 2:bulk>\n");
+			return count;
+		}
+
+		val = (level < 0 || level >= RX_AGG_LVL_NUM) ? -1 : (s8)level;
+		rtw_hal_set_hwreg(padapter, HW_VAR_RX_AGG_LEVEL, (u8 *)&val);
+	}
+
+	return count;
+}
+#endif //CONFIG_USB_RX_AGG_TUNE
+
+#ifdef CONFIG_USB_RX_URB_SCALE
+int proc_get_rx_urb(struct seq_file *m, void *v)
+{
+	struct net_device *dev = m->private;
+	_adapter *padapter = (_adapter *)rtw_netdev_priv(dev);
+	struct recv_priv *precvpriv = &padapter->recvpriv;
+	struct rx_urb_scale *pscale = &precvpriv->rx_urb_scale;
+
+	DBG_871X_SEL_NL(m, "depth=%u/%u%s, posted=%u, skb_pool=%u%s, free_skb=%u\n"
+		, pscale->depth, pscale->depth_max, pscale->depth_fixed ? " (fixed)" : ""
+		, ATOMIC_READ(&precvpriv->rx_pending_cnt)
+		, pscale->skb_pool, pscale->skb_pool_fixed ? " (fixed)" : ""
+		, skb_queue_len(&precvpriv->free_recv_skb_queue));
+	DBG_871X_SEL_NL(m, "idle_cnt=%u, idle_us=%llu, idle_max_us=%u, fifo_ovf_periods=%u\n"
+		, pscale->idle_cnt, pscale->idle_us, pscale->idle_max_us, pscale->fifo_ovf_cnt);
+	DBG_871X_SEL_NL(m, "spare=%u, alloc=%u, defer=%u, park=%u, grow=%u, shrink=%u\n"
+		, pscale->spare_cnt, pscale->alloc_cnt, pscale->defer_cnt, pscale->park_cnt
+		, pscale->grow_cnt, pscale->shrink_cnt);
+	DBG_871X_SEL_NL(m, "latency avg=%uus, max=%uus, <250us:%u <1ms:%u <4ms:%u <16ms:%u >=16ms:%u\n"
+		, pscale->lat_avg_us, pscale->lat_max_us
+		, pscale->lat_hist[RX_URB_LAT_250US], pscale->lat_hist[RX_URB_LAT_1MS]
+		, pscale->lat_hist[RX_URB_LAT_4MS], pscale->lat_hist[RX_URB_LAT_16MS]
+		, pscale->lat_hist[RX_URB_LAT_LONG]);
+
+	return 0;
+}
+
+ssize_t proc_set_rx_urb(struct file *file, const char __user *buffer, size_t count, loff_t *pos, void *data)
+{
+	struct net_device *dev = data;
+	_adapter *padapter = (_adapter *)rtw_netdev_priv(dev);
+	struct rx_urb_scale *pscale = &padapter->recvpriv.rx_urb_scale;
+	char tmp[32];
+	u32 depth, pool = 0;
+	int num;
+
+	if (count < 1)
+		return -EFAULT;
+
+	if (count > sizeof(tmp) - 1)
+		count = sizeof(tmp) - 1;
+
+	if (buffer && !copy_from_user(tmp, buffer, count)) {
+		tmp[count] = '\0';
+
+		num = sscanf(tmp, "%u %u", &depth, &pool);
+		if (num < 1) {
+			DBG_871X("invalid rx_urb parameter, usage: <depth, 0:auto> [<skb_pool, 0:auto>]\n");
+			return count;
+		}
+
+		if (depth > pscale->depth_max)
+			depth = pscale->depth_max;
+		if (pool > pscale->depth_max * 2)
+			pool = pscale->depth_max * 2;
+
+		// applied by the next DM watchdog run, a write also restarts the maxima
+		pscale->depth_fixed = depth;
+		pscale->skb_pool_fixed = pool;
+		pscale->idle_max_us = 0;
+		pscale->lat_max_us = 0;
+	}
+
+	return count;
+}
+#endif //CONFIG_USB_RX_URB_SCALE
+
+#ifdef CONFIG_RTW_TX_AQM
+int proc_get_tx_aqm(struct seq_file *m, void *v)
+{
+	struct net_device *dev = m->private;
+	_adapter *padapter = (_adapter *)rtw_netdev_priv(dev);
+	struct xmit_priv *pxmitpriv = &padapter->xmitpriv;
+	struct tx_aqm_stat *stat;
+	static const char *ac_str[HWXMIT_ENTRY] = {"VO", "VI", "BE", "BK"};
+	int i;
+
+	DBG_871X_SEL_NL(m, "target=%uus%s, interval=%uus\n"
+		, pxmitpriv->tx_aqm_target_us, pxmitpriv->tx_aqm_target_us ? "" : " (off)"
+		, pxmitpriv->tx_aqm_interval_us);
+
+	for (i = 0; i < HWXMIT_ENTRY; i++) {
+		stat = &pxmitpriv->tx_aqm_stat[i];
+		DBG_871X_SEL_NL(m, "%s: queued=%d, sojourn avg=%uus, max=%uus, dequeued=%u, drops=%u, marks=%u\n"
+			, ac_str[i], pxmitpriv->hwxmits[i].accnt
+			, stat->sojourn_avg_us, stat->sojourn_max_us
+			, stat->dequeued, stat->drops, stat->marks);
+	}
+
+#ifdef CONFIG_BQL
+	for (i = 0; i < dev->real_num_tx_queues; i++) {
+		struct dql *dql = &netdev_get_tx_queue(dev, i)->dql;
+
+		DBG_871X_SEL_NL(m, "txq%d: bql limit=%u, inflight=%u\n"
+			, i, dql->limit, dql->num_queued - dql->num_completed);
+	}
+#endif
+
+	return 0;
+}
+
+ssize_t proc_set_tx_aqm(struct file *file, const char __user *buffer, size_t count, loff_t *pos, void *data)
+{
+	struct net_device *dev = data;
+	_adapter *padapter = (_adapter *)rtw_netdev_priv(dev);
+	struct xmit_priv *pxmitpriv = &padapter->xmitpriv;
+	char tmp[32];
+	u32 target, interval = 0;
+	int i, num;
+
+	if (count < 1)
+		return -EFAULT;
+
+	if (count > sizeof(tmp) - 1)
+		count = sizeof(tmp) - 1;
+
+	if (buffer && !copy_from_user(tmp, buffer, count)) {
+		tmp[count] = '\0';
+
+		num = sscanf(tmp, "%u %u", &target, &interval);
+		if (num < 1) {
+			DBG_871X("invalid tx_aqm parameter, usage: <target_us, 0:off> [<interval_us>]\n");
+			return count;
+		}
+
+		if (num < 2 || interval == 0)
+			interval = pxmitpriv->tx_aqm_interval_us;
+		if (target > interval)
+			target = interval;
+
+		pxmitpriv->tx_aqm_target_us = target;
+		pxmitpriv->tx_aqm_interval_us = interval;
+
+		// a write also restarts the maxima
+		for (i = 0; i < HWXMIT_ENTRY; i++)
+			pxmitpriv->tx_aqm_stat[i].sojourn_max_us = 0;
+	}
+
+	return count;
+}
+#endif //CONFIG_RTW_TX_AQM
+
+int proc_get_io_stat(struct seq_file *m, void *v)
+{
+	struct net_device *dev = m->private;
+	_adapter *padapter = (_adapter *)rtw_netdev_priv(dev);
+	struct io_priv *pio_priv = &padapter->iopriv;
+
+#ifdef CONFIG_IO_BATCH
+	DBG_871X_SEL_NL(m, "batch_write_cnt=%u, batch_xfer_cnt=%u\n"
+		, pio_priv->batch.write_cnt, pio_priv->batch.xfer_cnt);
+#endif
+#ifdef CONFIG_IO_SHADOW
+	DBG_871X_SEL_NL(m, "shadow_reg_num=%u, shadow_write_saved_cnt=%u, shadow_read_saved_cnt=%u\n"
+		, pio_priv->shadow.num, pio_priv->shadow.write_saved_cnt, pio_priv->shadow.read_saved_cnt);
+#endif
+	DBG_871X_SEL_NL(m, "vendor_req_cnt=%u\n", pio_priv->vendor_req_cnt);
+	DBG_871X_SEL_NL(m, "last_hal_init: %u ms, %u vendor requests\n"
+		, pio_priv->init_time_ms, pio_priv->init_vendor_req_cnt);
+	DBG_871X_SEL_NL(m, "last_fwdl: %u ms, %u vendor requests, %u retries\n"
+		, pio_priv->fwdl_time_ms, pio_priv->fwdl_vendor_req_cnt, pio_priv->fwdl_retry);
+#ifdef CONFIG_USB_INTERRUPT_IN_PIPE
+	DBG_871X_SEL_NL(m, "int_in_active=%u, int_cnt=%u, int_c2h_cnt=%u, int_cpwm_cnt=%u\n"
+		, padapter->recvpriv.int_in_active, padapter->recvpriv.int_cnt
+		, padapter->recvpriv.int_c2h_cnt, padapter->recvpriv.int_cpwm_cnt);
+#endif
 
 	return 0;
 }
@@ -956,7 +1274,7 @@ int proc_get_all_sta_info(struct seq_file *m, void *v)
 	_list	*plist, *phead;
 	struct recv_reorder_ctrl *preorder_ctrl;
 
-	DBG_871X_SEL_NL(m, "sta_dz_bitmap=0x%x, tim_bitmap=0x%x\n", pstapriv->sta_dz_bitmap, pstapriv->tim_bitmap);
+	DBG_871X_SEL_NL(m, "sta_dz_bitmap=%*ph, tim_bitmap=%*ph\n", pstapriv->tim_bitmap_len, pstapriv->sta_dz_bitmap, pstapriv->tim_bitmap_len, pstapriv->tim_bitmap);
 
 	_enter_critical_bh(&pstapriv->sta_hash_lock, &irqL);
 
@@ -983,6 +1301,12 @@ int proc_get_all_sta_info(struct seq_file *m, void *v)
 				DBG_871X_SEL_NL(m, "agg_enable_bitmap=%x, candidate_tid_bitmap=%x\n", psta->htpriv.agg_enable_bitmap, psta->htpriv.candidate_tid_bitmap);
 #endif //CONFIG_80211N_HT
 				DBG_871X_SEL_NL(m, "sleepq_len=%d\n", psta->sleepq_len);
+#ifdef CONFIG_TX_AIRTIME_DRR
+				DBG_871X_SEL_NL(m, "airtime rate=%ukbps, used=%lluus, deficit VO/VI/BE/BK=%d/%d/%d/%dus\n"
+					, psta->sta_xmitpriv.airtime_kbps, (unsigned long long)psta->sta_xmitpriv.airtime_us
+					, psta->sta_xmitpriv.vo_q.deficit_us, psta->sta_xmitpriv.vi_q.deficit_us
+					, psta->sta_xmitpriv.be_q.deficit_us, psta->sta_xmitpriv.bk_q.deficit_us);
+#endif
 				DBG_871X_SEL_NL(m, "capability=0x%x\n", psta->capability);
 				DBG_871X_SEL_NL(m, "flags=0x%x\n", psta->flags);
 				DBG_871X_SEL_NL(m, "wpa_psk=0x%x\n", psta->wpa_psk);
@@ -1010,6 +1334,34 @@ int proc_get_all_sta_info(struct seq_file *m, void *v)
 
 	return 0;
 }
+
+#ifdef CONFIG_TX_MCAST2UNI
+int proc_get_mc2u(struct seq_file *m, void *v)
+{
+	struct net_device *dev = m->private;
+	_adapter *padapter = (_adapter *)rtw_netdev_priv(dev);
+	struct sta_priv *pstapriv = &padapter->stapriv;
+	struct mc2u_member *member;
+	_irqL irqL;
+	int i;
+
+	DBG_871X_SEL_NL(m, "reports=%u, unicast=%u, mcast=%u, flood=%u, overflow=%u\n"
+		, pstapriv->mc2u_report_cnt, pstapriv->mc2u_unicast_cnt
+		, pstapriv->mc2u_mcast_cnt, pstapriv->mc2u_flood_cnt, pstapriv->mc2u_overflow);
+
+	_enter_critical_bh(&pstapriv->mc2u_lock, &irqL);
+	for (i = 0; i < MC2U_MEMBER_NUM; i++) {
+		member = &pstapriv->mc2u_member[i];
+		if (!member->used)
+			continue;
+		DBG_871X_SEL_NL(m, "group=" MAC_FMT ", sta=" MAC_FMT ", age=%ums\n"
+			, MAC_ARG(member->group), MAC_ARG(member->sta), rtw_get_passing_time_ms(member->time));
+	}
+	_exit_critical_bh(&pstapriv->mc2u_lock, &irqL);
+
+	return 0;
+}
+#endif // CONFIG_TX_MCAST2UNI
 #endif /* CONFIG_AP_MODE */
 
 #ifdef CONFIG_FIND_BEST_CHANNEL
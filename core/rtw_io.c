@@ -48,6 +48,299 @@ jackson@realtek.com.tw
 
 #include <usb_ops.h>
 
+#ifdef CONFIG_IO_BATCH
+static u8 io_batch_owned(struct io_priv *pio_priv)
+{
+	struct io_batch *pbatch = &pio_priv->batch;
+
+	if (pbatch->depth == 0 || in_interrupt())
+		return _FALSE;
+
+	return pbatch->owner == (void *)current ? _TRUE : _FALSE;
+}
+
+// send the pending run with the narrowest op that covers it
+static int io_batch_xfer(struct io_priv *pio_priv)
+{
+	struct io_batch *pbatch = &pio_priv->batch;
+	struct intf_hdl *pintfhdl = &(pio_priv->intf);
+	struct _io_ops *pops = &pintfhdl->io_ops;
+	u8 *buf = pbatch->buf;
+	int ret;
+
+	if (pbatch->len == 0)
+		return 0;
+
+	switch (pbatch->len) {
+	case 1:
+		ret = pops->_write8(pintfhdl, pbatch->addr, buf[0]);
+		break;
+	case 2:
+		ret = pops->_write16(pintfhdl, pbatch->addr, buf[0] | (buf[1] << 8));
+		break;
+	case 4:
+		ret = pops->_write32(pintfhdl, pbatch->addr,
+			buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((u32)buf[3] << 24));
+		break;
+	default:
+		ret = pops->_writeN(pintfhdl, pbatch->addr, pbatch->len, buf);
+		break;
+	}
+
+	pbatch->xfer_cnt++;
+	pbatch->len = 0;
+
+	return ret;
+}
+
+static int io_batch_write(struct io_priv *pio_priv, u32 addr, u32 val, u8 width)
+{
+	struct io_batch *pbatch = &pio_priv->batch;
+	int ret = 0;
+	u8 i;
+
+	if (pbatch->len && (addr != pbatch->addr + pbatch->len
+		|| pbatch->len + width > IO_BATCH_MAX_LEN))
+		ret = io_batch_xfer(pio_priv);
+
+	if (pbatch->len == 0)
+		pbatch->addr = addr;
+
+	for (i = 0; i < width; i++)
+		pbatch->buf[pbatch->len++] = (u8)(val >> (i * 8));
+
+	pbatch->write_cnt++;
+
+	return ret;
+}
+
+void rtw_io_batch_begin(_adapter *adapter)
+{
+	struct io_priv *pio_priv = &adapter->iopriv;
+	struct io_batch *pbatch = &pio_priv->batch;
+	_irqL irqL;
+
+	if (in_interrupt())
+		return;
+
+	_enter_critical_bh(&pbatch->lock, &irqL);
+
+	// nested begin from the owner only deepens the batch,
+	// a second task keeps doing plain synchronous writes
+	if (pbatch->depth) {
+		if (pbatch->owner == (void *)current)
+			pbatch->depth++;
+	} else {
+		pbatch->owner = (void *)current;
+		pbatch->len = 0;
+		pbatch->depth = 1;
+	}
+
+	_exit_critical_bh(&pbatch->lock, &irqL);
+}
+
+void rtw_io_batch_end(_adapter *adapter)
+{
+	struct io_priv *pio_priv = &adapter->iopriv;
+	struct io_batch *pbatch = &pio_priv->batch;
+	_irqL irqL;
+
+	if (io_batch_owned(pio_priv) == _FALSE)
+		return;
+
+	// only the owner changes depth once the batch is taken
+	if (pbatch->depth > 1) {
+		pbatch->depth--;
+		return;
+	}
+
+	// still owned while the run goes out, nobody else can reset it
+	io_batch_xfer(pio_priv);
+
+	_enter_critical_bh(&pbatch->lock, &irqL);
+	pbatch->owner = NULL;
+	pbatch->depth = 0;
+	_exit_critical_bh(&pbatch->lock, &irqL);
+}
+
+void rtw_io_batch_flush(_adapter *adapter)
+{
+	struct io_priv *pio_priv = &adapter->iopriv;
+
+	if (io_batch_owned(pio_priv) == _TRUE)
+		io_batch_xfer(pio_priv);
+}
+#endif //CONFIG_IO_BATCH
+
+#ifdef CONFIG_IO_SHADOW
+static struct io_shadow_reg *io_shadow_find(struct io_priv *pio_priv, u32 addr)
+{
+	struct io_shadow *pshadow = &pio_priv->shadow;
+	u8 i;
+
+	addr &= ~0x3;
+	for (i = 0; i < pshadow->num; i++) {
+		if (pshadow->reg[i].addr == addr)
+			return &pshadow->reg[i];
+	}
+
+	return NULL;
+}
+
+// take the shadow lock if [addr, addr + len) touches a shadowed register
+static u8 io_shadow_lock(struct io_priv *pio_priv, u32 addr, u32 len, _irqL *pirqL)
+{
+	struct io_shadow *pshadow = &pio_priv->shadow;
+	u32 i;
+
+	if (pshadow->num == 0)
+		return _FALSE;
+
+	for (i = addr & ~0x3; i < addr + len; i += 4) {
+		if (io_shadow_find(pio_priv, i) != NULL) {
+			_enter_critical_mutex(&pshadow->lock, pirqL);
+			return _TRUE;
+		}
+	}
+
+	return _FALSE;
+}
+
+static void io_shadow_unlock(struct io_priv *pio_priv, _irqL *pirqL)
+{
+	_exit_critical_mutex(&pio_priv->shadow.lock, pirqL);
+}
+
+static void io_shadow_forget(struct io_priv *pio_priv, u32 addr, u32 len)
+{
+	struct io_shadow_reg *preg;
+	u32 i;
+
+	for (i = addr & ~0x3; i < addr + len; i += 4) {
+		if ((preg = io_shadow_find(pio_priv, i)) != NULL)
+			preg->valid = _FALSE;
+	}
+}
+
+// shadow lock held, return _TRUE if the register already holds val
+static u8 io_shadow_redundant(struct io_priv *pio_priv, u32 addr, u32 val, u8 width)
+{
+	struct io_shadow_reg *preg;
+	u8 shift = (addr & 0x3) * 8;
+	u32 mask;
+
+	if (shift + width * 8 > 32)
+		return _FALSE;
+
+	preg = io_shadow_find(pio_priv, addr);
+	if (preg == NULL || preg->valid == _FALSE)
+		return _FALSE;
+
+	mask = (width == 4) ? 0xFFFFFFFF : ((1 << (width * 8)) - 1) << shift;
+	if ((preg->val & mask) != ((val << shift) & mask))
+		return _FALSE;
+
+	pio_priv->shadow.write_saved_cnt++;
+	return _TRUE;
+}
+
+// shadow lock held, record a write once its outcome is known
+static void io_shadow_update(struct io_priv *pio_priv, u32 addr, u32 val, u8 width, int ret)
+{
+	struct io_shadow_reg *preg;
+	u8 shift = (addr & 0x3) * 8;
+	u32 mask;
+
+	// a failed write leaves the register unknown, so does one still sitting
+	// in the batch buffer; straddling writes aren't worth merging
+	if (ret != _SUCCESS
+#ifdef CONFIG_IO_BATCH
+		|| io_batch_owned(pio_priv) == _TRUE
+#endif
+		|| shift + width * 8 > 32) {
+		io_shadow_forget(pio_priv, addr, width);
+		return;
+	}
+
+	preg = io_shadow_find(pio_priv, addr);
+	if (preg == NULL)
+		return;
+
+	if (width == 4) {
+		preg->val = val;
+		preg->valid = _TRUE;
+		return;
+	}
+
+	// a byte/word write can only be merged into a known dword
+	if (preg->valid == _FALSE)
+		return;
+
+	mask = ((1 << (width * 8)) - 1) << shift;
+	preg->val = (preg->val & ~mask) | ((val << shift) & mask);
+}
+
+void rtw_io_shadow_add(_adapter *adapter, u32 addr)
+{
+	struct io_priv *pio_priv = &adapter->iopriv;
+	struct io_shadow *pshadow = &pio_priv->shadow;
+	struct io_shadow_reg *preg;
+	_irqL irqL;
+
+	if (io_shadow_find(pio_priv, addr) != NULL)
+		return;
+
+	if (pshadow->num >= IO_SHADOW_NUM) {
+		DBG_871X("%s: no room for 0x%04x\n", __FUNCTION__, addr);
+		return;
+	}
+
+	_enter_critical_mutex(&pshadow->lock, &irqL);
+	preg = &pshadow->reg[pshadow->num];
+	preg->addr = addr & ~0x3;
+	preg->valid = _FALSE;
+	pshadow->num++;
+	_exit_critical_mutex(&pshadow->lock, &irqL);
+}
+
+void rtw_io_shadow_invalidate(_adapter *adapter)
+{
+	struct io_shadow *pshadow = &adapter->iopriv.shadow;
+	_irqL irqL;
+	u8 i;
+
+	_enter_critical_mutex(&pshadow->lock, &irqL);
+	for (i = 0; i < pshadow->num; i++)
+		pshadow->reg[i].valid = _FALSE;
+	_exit_critical_mutex(&pshadow->lock, &irqL);
+}
+
+u8 rtw_io_shadow_read32(_adapter *adapter, u32 addr, u32 *pval)
+{
+	struct io_priv *pio_priv = &adapter->iopriv;
+	struct io_shadow_reg *preg;
+	_irqL irqL;
+	u8 hit = _FALSE;
+
+	if (addr & 0x3)
+		return _FALSE;
+
+	if (io_shadow_lock(pio_priv, addr, 4, &irqL) == _FALSE)
+		return _FALSE;
+
+	preg = io_shadow_find(pio_priv, addr);
+	if (preg->valid == _TRUE) {
+		*pval = preg->val;
+		pio_priv->shadow.read_saved_cnt++;
+		hit = _TRUE;
+	}
+
+	io_shadow_unlock(pio_priv, &irqL);
+
+	return hit;
+}
+#endif //CONFIG_IO_SHADOW
+
 u8 _rtw_read8(_adapter *adapter, u32 addr)
 {
 	u8 r_val;
@@ -58,6 +351,11 @@ u8 _rtw_read8(_adapter *adapter, u32 addr)
 	_func_enter_;
 	_read8 = pintfhdl->io_ops._read8;
 
+#ifdef CONFIG_IO_BATCH
+	if (io_batch_owned(pio_priv) == _TRUE)
+		io_batch_xfer(pio_priv);
+#endif
+
 	r_val = _read8(pintfhdl, addr);
 	_func_exit_;
 	return r_val;
@@ -73,6 +371,11 @@ u16 _rtw_read16(_adapter *adapter, u32 addr)
 	_func_enter_;
 	_read16 = pintfhdl->io_ops._read16;
 
+#ifdef CONFIG_IO_BATCH
+	if (io_batch_owned(pio_priv) == _TRUE)
+		io_batch_xfer(pio_priv);
+#endif
+
 	r_val = _read16(pintfhdl, addr);
 	_func_exit_;
 	return r_val;
@@ -85,10 +388,30 @@ u32 _rtw_read32(_adapter *adapter, u32 addr)
 	struct io_priv *pio_priv = &adapter->iopriv;
 	struct	intf_hdl		*pintfhdl = &(pio_priv->intf);
 	u32	(*_read32)(struct intf_hdl *pintfhdl, u32 addr);
+#ifdef CONFIG_IO_SHADOW
+	_irqL irqL;
+#endif
 	_func_enter_;
 	_read32 = pintfhdl->io_ops._read32;
 
+#ifdef CONFIG_IO_BATCH
+	if (io_batch_owned(pio_priv) == _TRUE)
+		io_batch_xfer(pio_priv);
+#endif
+
+#ifdef CONFIG_IO_SHADOW
+	// a write can't slip in between the read and the shadow refresh
+	if ((addr & 0x3) == 0 && io_shadow_lock(pio_priv, addr, 4, &irqL) == _TRUE) {
+		struct io_shadow_reg *preg = io_shadow_find(pio_priv, addr);
+
+		r_val = _read32(pintfhdl, addr);
+		preg->val = r_val;
+		preg->valid = _TRUE;
+		io_shadow_unlock(pio_priv, &irqL);
+	} else
+#endif
 	r_val = _read32(pintfhdl, addr);
+
 	_func_exit_;
 	return r_val;
 
@@ -101,10 +424,35 @@ int _rtw_write8(_adapter *adapter, u32 addr, u8 val)
 	struct	intf_hdl		*pintfhdl = &(pio_priv->intf);
 	int (*_write8)(struct intf_hdl *pintfhdl, u32 addr, u8 val);
 	int ret;
+#ifdef CONFIG_IO_SHADOW
+	_irqL irqL;
+	u8 shadowed;
+#endif
 	_func_enter_;
 	_write8 = pintfhdl->io_ops._write8;
 
+#ifdef CONFIG_IO_SHADOW
+	shadowed = io_shadow_lock(pio_priv, addr, 1, &irqL);
+	if (shadowed == _TRUE && io_shadow_redundant(pio_priv, addr, val, 1) == _TRUE) {
+		io_shadow_unlock(pio_priv, &irqL);
+		_func_exit_;
+		return _SUCCESS;
+	}
+#endif
+
+#ifdef CONFIG_IO_BATCH
+	if (io_batch_owned(pio_priv) == _TRUE)
+		ret = io_batch_write(pio_priv, addr, val, 1);
+	else
+#endif
 	ret = _write8(pintfhdl, addr, val);
+
+#ifdef CONFIG_IO_SHADOW
+	if (shadowed == _TRUE) {
+		io_shadow_update(pio_priv, addr, val, 1, RTW_STATUS_CODE(ret));
+		io_shadow_unlock(pio_priv, &irqL);
+	}
+#endif
 	_func_exit_;
 
 	return RTW_STATUS_CODE(ret);
@@ -116,10 +464,35 @@ int _rtw_write16(_adapter *adapter, u32 addr, u16 val)
 	struct	intf_hdl		*pintfhdl = &(pio_priv->intf);
 	int (*_write16)(struct intf_hdl *pintfhdl, u32 addr, u16 val);
 	int ret;
+#ifdef CONFIG_IO_SHADOW
+	_irqL irqL;
+	u8 shadowed;
+#endif
 	_func_enter_;
 	_write16 = pintfhdl->io_ops._write16;
 
+#ifdef CONFIG_IO_SHADOW
+	shadowed = io_shadow_lock(pio_priv, addr, 2, &irqL);
+	if (shadowed == _TRUE && io_shadow_redundant(pio_priv, addr, val, 2) == _TRUE) {
+		io_shadow_unlock(pio_priv, &irqL);
+		_func_exit_;
+		return _SUCCESS;
+	}
+#endif
+
+#ifdef CONFIG_IO_BATCH
+	if (io_batch_owned(pio_priv) == _TRUE)
+		ret = io_batch_write(pio_priv, addr, val, 2);
+	else
+#endif
 	ret = _write16(pintfhdl, addr, val);
+
+#ifdef CONFIG_IO_SHADOW
+	if (shadowed == _TRUE) {
+		io_shadow_update(pio_priv, addr, val, 2, RTW_STATUS_CODE(ret));
+		io_shadow_unlock(pio_priv, &irqL);
+	}
+#endif
 	_func_exit_;
 
 	return RTW_STATUS_CODE(ret);
@@ -131,10 +504,35 @@ int _rtw_write32(_adapter *adapter, u32 addr, u32 val)
 	struct	intf_hdl		*pintfhdl = &(pio_priv->intf);
 	int (*_write32)(struct intf_hdl *pintfhdl, u32 addr, u32 val);
 	int ret;
+#ifdef CONFIG_IO_SHADOW
+	_irqL irqL;
+	u8 shadowed;
+#endif
 	_func_enter_;
 	_write32 = pintfhdl->io_ops._write32;
 
+#ifdef CONFIG_IO_SHADOW
+	shadowed = io_shadow_lock(pio_priv, addr, 4, &irqL);
+	if (shadowed == _TRUE && io_shadow_redundant(pio_priv, addr, val, 4) == _TRUE) {
+		io_shadow_unlock(pio_priv, &irqL);
+		_func_exit_;
+		return _SUCCESS;
+	}
+#endif
+
+#ifdef CONFIG_IO_BATCH
+	if (io_batch_owned(pio_priv) == _TRUE)
+		ret = io_batch_write(pio_priv, addr, val, 4);
+	else
+#endif
 	ret = _write32(pintfhdl, addr, val);
+
+#ifdef CONFIG_IO_SHADOW
+	if (shadowed == _TRUE) {
+		io_shadow_update(pio_priv, addr, val, 4, RTW_STATUS_CODE(ret));
+		io_shadow_unlock(pio_priv, &irqL);
+	}
+#endif
 	_func_exit_;
 
 	return RTW_STATUS_CODE(ret);
@@ -147,10 +545,30 @@ int _rtw_writeN(_adapter *adapter, u32 addr ,u32 length , u8 *pdata)
         struct	intf_hdl	*pintfhdl = (struct intf_hdl*)(&(pio_priv->intf));
 	int (*_writeN)(struct intf_hdl *pintfhdl, u32 addr,u32 length, u8 *pdata);
 	int ret;
+#ifdef CONFIG_IO_SHADOW
+	_irqL irqL;
+	u8 shadowed;
+#endif
 	_func_enter_;
 	_writeN = pintfhdl->io_ops._writeN;
 
+#ifdef CONFIG_IO_SHADOW
+	shadowed = io_shadow_lock(pio_priv, addr, length, &irqL);
+#endif
+
+#ifdef CONFIG_IO_BATCH
+	if (io_batch_owned(pio_priv) == _TRUE)
+		io_batch_xfer(pio_priv);
+#endif
+
 	ret = _writeN(pintfhdl, addr,length,pdata);
+
+#ifdef CONFIG_IO_SHADOW
+	if (shadowed == _TRUE) {
+		io_shadow_forget(pio_priv, addr, length);
+		io_shadow_unlock(pio_priv, &irqL);
+	}
+#endif
 	_func_exit_;
 
 	return RTW_STATUS_CODE(ret);
@@ -223,9 +641,10 @@ void _rtw_read_mem(_adapter *adapter, u32 addr, u32 cnt, u8 *pmem)
 
 }
 
-void _rtw_write_mem(_adapter *adapter, u32 addr, u32 cnt, u8 *pmem)
+int _rtw_write_mem(_adapter *adapter, u32 addr, u32 cnt, u8 *pmem)
 {
-	void (*_write_mem)(struct intf_hdl *pintfhdl, u32 addr, u32 cnt, u8 *pmem);
+	int (*_write_mem)(struct intf_hdl *pintfhdl, u32 addr, u32 cnt, u8 *pmem);
+	int ret;
 	//struct	io_queue	*pio_queue = (struct io_queue *)adapter->pio_queue;
 	struct io_priv *pio_priv = &adapter->iopriv;
 	struct	intf_hdl		*pintfhdl = &(pio_priv->intf);
@@ -234,10 +653,11 @@ void _rtw_write_mem(_adapter *adapter, u32 addr, u32 cnt, u8 *pmem)
 
 	_write_mem = pintfhdl->io_ops._write_mem;
 
-	_write_mem(pintfhdl, addr, cnt, pmem);
+	ret = _write_mem(pintfhdl, addr, cnt, pmem);
 
 	_func_exit_;
 
+	return ret;
 }
 
 void _rtw_read_port(_adapter *adapter, u32 addr, u32 cnt, u8 *pmem)
@@ -339,6 +759,14 @@ int rtw_init_io_priv(_adapter *padapter, void (*set_intf_ops)(struct _io_ops *po
 
 	set_intf_ops(&pintf->io_ops);
 
+#ifdef CONFIG_IO_BATCH
+	_rtw_spinlock_init(&piopriv->batch.lock);
+#endif
+
+#ifdef CONFIG_IO_SHADOW
+	_rtw_mutex_init(&piopriv->shadow.lock);
+#endif
+
 	return _SUCCESS;
 }
 
@@ -3098,6 +3098,7 @@ _func_enter_;
 			keylen=16;
 			memcpy(&psetkeyparm->key, &psecuritypriv->dot118021XGrpKey[keyid], keylen);
 			psetkeyparm->grpkey=1;
+			rtw_aes_key_setup(psecuritypriv->dot118021XGrpKey_rk[keyid], psetkeyparm->key);
 			break;
 		default:
 			RT_TRACE(_module_rtl871x_mlme_c_,_drv_err_,("\n rtw_set_key:psecuritypriv->dot11PrivacyAlgrthm = %x (must be 1 or 2 or 4 or 5)\n",psecuritypriv->dot11PrivacyAlgrthm));
@@ -987,16 +987,10 @@ _continue:
 			if (psta->aid > 0) {
 				DBG_871X("old AID %d\n", psta->aid);
 			} else {
-				for (psta->aid = 1; psta->aid <= NUM_STA; psta->aid++)
-					if (pstapriv->sta_aid[psta->aid - 1] == NULL)
-						break;
-
-				if (psta->aid > pstapriv->max_num_sta) {
-					psta->aid = 0;
+				if (rtw_alloc_aid(pstapriv, psta) == 0) {
 					DBG_871X("no room for more AIDs\n");
 					return _SUCCESS;
 				} else {
-					pstapriv->sta_aid[psta->aid - 1] = psta;
 					DBG_871X("allocate new AID = (%d)\n", psta->aid);
 				}
 			}
@@ -2194,14 +2188,7 @@ unsigned int OnAssocReq(_adapter *padapter, union recv_frame *precv_frame)
 	if (pstat->aid > 0) {
 		DBG_871X("  old AID %d\n", pstat->aid);
 	} else {
-		for (pstat->aid = 1; pstat->aid <= NUM_STA; pstat->aid++)
-			if (pstapriv->sta_aid[pstat->aid - 1] == NULL)
-				break;
-
-		//if (pstat->aid > NUM_STA) {
-		if (pstat->aid > pstapriv->max_num_sta) {
-
-			pstat->aid = 0;
+		if (rtw_alloc_aid(pstapriv, pstat) == 0) {
 
 			DBG_871X("  no room for more AIDs\n");
 
@@ -2211,7 +2198,6 @@ unsigned int OnAssocReq(_adapter *padapter, union recv_frame *precv_frame)
 
 
 		} else {
-			pstapriv->sta_aid[pstat->aid - 1] = pstat;
 			DBG_871X("allocate new AID = (%d)\n", pstat->aid);
 		}
 	}
@@ -10442,6 +10428,10 @@ void update_sta_info(_adapter *padapter, struct sta_info *psta)
 	struct mlme_ext_priv	*pmlmeext = &padapter->mlmeextpriv;
 	struct mlme_ext_info	*pmlmeinfo = &(pmlmeext->mlmext_info);
 
+#ifdef CONFIG_TX_TMPL_CACHE
+	rtw_tx_tmpl_invalidate(padapter);
+#endif
+
 	//ERP
 	VCS_update(padapter, psta);
 
@@ -10496,6 +10486,10 @@ void mlmeext_joinbss_event_callback(_adapter *padapter, int join_res)
 	struct sta_priv		*pstapriv = &padapter->stapriv;
 	u8	join_type;
 
+#ifdef CONFIG_TX_TMPL_CACHE
+	rtw_tx_tmpl_invalidate(padapter);
+#endif
+
 	if(join_res < 0)
 	{
 		join_type = 1;
@@ -10601,6 +10595,10 @@ void mlmeext_sta_add_event_callback(_adapter *padapter, struct sta_info *psta)
 
 	DBG_871X("%s\n", __FUNCTION__);
 
+#ifdef CONFIG_TX_TMPL_CACHE
+	rtw_tx_tmpl_invalidate(padapter);
+#endif
+
 	if((pmlmeinfo->state&0x03) == WIFI_FW_ADHOC_STATE)
 	{
 		if(pmlmeinfo->state & WIFI_FW_ASSOC_SUCCESS)//adhoc master or sta_count>1
@@ -11913,6 +11911,11 @@ u8 setkey_hdl(_adapter *padapter, u8 *pbuf)
 		rtw_hal_set_hwreg(padapter, HW_VAR_SEC_DK_CFG, (u8*)_TRUE);
 	#endif
 
+	// key index and algorithm feed the TX templates
+#ifdef CONFIG_TX_TMPL_CACHE
+	rtw_tx_tmpl_invalidate(padapter);
+#endif
+
 	//allow multicast packets to driver
 	rtw_hal_set_hwreg(padapter, HW_VAR_ON_RCR_AM, null_addr);
 
@@ -11963,6 +11966,10 @@ write_to_cam:
 	}
 	ret = H2C_SUCCESS_RSP;
 
+#ifdef CONFIG_TX_TMPL_CACHE
+	rtw_tx_tmpl_invalidate(padapter);
+#endif
+
 exit:
 	return ret;
 }
@@ -12165,7 +12172,7 @@ u8 chk_bmc_sleepq_hdl(_adapter *padapter, unsigned char *pbuf)
 	if(!psta_bmc)
 		return H2C_SUCCESS;
 
-	if((pstapriv->tim_bitmap&BIT(0)) && (psta_bmc->sleepq_len>0))
+	if(rtw_tim_map_is_set(pstapriv->tim_bitmap, 0) && (psta_bmc->sleepq_len>0))
 	{
 		rtw_msleep_os(10);// 10ms, ATIM(HIQ) Windows
 		//_enter_critical_bh(&psta_bmc->sleep_q.lock, &irqL);
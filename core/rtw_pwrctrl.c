@@ -427,6 +427,9 @@ _func_enter_;
 		return;
 	}
 
+	// firmware owns the chip while in LPS, don't trust the register shadow across it
+	rtw_io_shadow_invalidate(padapter);
+
 	//if(pwrpriv->pwr_mode == PS_MODE_ACTIVE)
 	if(ps_mode == PS_MODE_ACTIVE)
 	{
@@ -111,7 +111,7 @@ _func_enter_;
 
 	}
 
-	precvpriv->rx_pending_cnt=1;
+	ATOMIC_SET(&precvpriv->rx_pending_cnt, 0);
 
 	_rtw_init_sema(&precvpriv->allrxreturnevt, 0);
 
@@ -606,7 +606,9 @@ union recv_frame * decryptor(_adapter *padapter,union recv_frame *precv_frame)
 
 	struct rx_pkt_attrib *prxattrib = &precv_frame->u.hdr.attrib;
 	struct security_priv *psecuritypriv=&padapter->securitypriv;
+	struct sta_info *psta = precv_frame->u.hdr.psta;
 	union recv_frame *return_packet=precv_frame;
+	u8	no_hw_key = (psta && psta->no_hw_key && !IS_MCAST(prxattrib->ra)) ? _TRUE : _FALSE;
 	u32	 res=_SUCCESS;
 _func_enter_;
 
@@ -635,9 +637,11 @@ _func_enter_;
 		}
 	}
 
-	if((prxattrib->encrypt>0) && ((prxattrib->bdecrypted==0) ||(psecuritypriv->sw_decrypt==_TRUE)))
+	if((prxattrib->encrypt>0) && ((prxattrib->bdecrypted==0) ||(psecuritypriv->sw_decrypt==_TRUE) || no_hw_key))
 	{
 
+		// a station without a CAM entry says nothing about the others
+		if (!no_hw_key)
 #ifdef CONFIG_CONCURRENT_MODE
 		if(!IS_MCAST(prxattrib->ra))//bc/mc packets use sw decryption for concurrent mode
 #endif
@@ -1687,7 +1691,7 @@ sint validate_recv_ctrl_frame(_adapter *padapter, union recv_frame *precv_frame)
 			psta->state ^= WIFI_STA_ALIVE_CHK_STATE;
 		}
 
-		if((psta->state&WIFI_SLEEP_STATE) && (pstapriv->sta_dz_bitmap&BIT(psta->aid)))
+		if((psta->state&WIFI_SLEEP_STATE) && rtw_tim_map_is_set(pstapriv->sta_dz_bitmap, psta->aid))
 		{
 			_irqL irqL;
 			_list	*xmitframe_plist, *xmitframe_phead;
@@ -1731,7 +1735,7 @@ sint validate_recv_ctrl_frame(_adapter *padapter, union recv_frame *precv_frame)
 
 				if(psta->sleepq_len==0)
 				{
-					pstapriv->tim_bitmap &= ~BIT(psta->aid);
+					rtw_tim_map_clear(pstapriv->tim_bitmap, psta->aid);
 
 					//DBG_871X("after handling ps-poll, tim=%x\n", pstapriv->tim_bitmap);
 
@@ -1750,7 +1754,7 @@ sint validate_recv_ctrl_frame(_adapter *padapter, union recv_frame *precv_frame)
 				_exit_critical_bh(&pxmitpriv->lock, &irqL);
 
 				//DBG_871X("no buffered packets to xmit\n");
-				if(pstapriv->tim_bitmap&BIT(psta->aid))
+				if(rtw_tim_map_is_set(pstapriv->tim_bitmap, psta->aid))
 				{
 					if(psta->sleepq_len==0)
 					{
@@ -1765,7 +1769,7 @@ sint validate_recv_ctrl_frame(_adapter *padapter, union recv_frame *precv_frame)
 						psta->sleepq_len=0;
 					}
 
-					pstapriv->tim_bitmap &= ~BIT(psta->aid);
+					rtw_tim_map_clear(pstapriv->tim_bitmap, psta->aid);
 
 					//upate BCN for TIM IE
 					//update_BCNTIM(padapter);
@@ -2948,7 +2952,7 @@ int amsdu_to_msdu(_adapter *padapter, union recv_frame *prframe)
 			sub_skb->ip_summed = CHECKSUM_NONE;
 #endif //CONFIG_TCP_CSUM_OFFLOAD_RX
 
-			rtw_netif_rx(padapter->pnetdev, sub_skb);
+			rtw_os_recv_indicate_skb(padapter, sub_skb);
 		}
 	}
 
@@ -3294,62 +3298,93 @@ int check_indicate_seq(struct recv_reorder_ctrl *preorder_ctrl, u16 seq_num)
 	return _TRUE;
 }
 
-int enqueue_reorder_recvframe(struct recv_reorder_ctrl *preorder_ctrl, union recv_frame *prframe);
-int enqueue_reorder_recvframe(struct recv_reorder_ctrl *preorder_ctrl, union recv_frame *prframe)
+static void recv_indicate_reorder_frame(_adapter *padapter, union recv_frame *prframe)
 {
+	struct recv_priv *precvpriv = &padapter->recvpriv;
 	struct rx_pkt_attrib *pattrib = &prframe->u.hdr.attrib;
-	_queue *ppending_recvframe_queue = &preorder_ctrl->pending_recvframe_queue;
-	_list	*phead, *plist;
-	union recv_frame *pnextrframe;
-	struct rx_pkt_attrib *pnextattrib;
-
-	//DbgPrint("+enqueue_reorder_recvframe()\n");
-
-	//_enter_critical_ex(&ppending_recvframe_queue->lock, &irql);
-	//_rtw_spinlock_ex(&ppending_recvframe_queue->lock);
-
 
-	phead = get_list_head(ppending_recvframe_queue);
-	plist = get_next(phead);
-
-	while(rtw_end_of_queue_search(phead, plist) == _FALSE)
+	//indicate this recv_frame
+	if(!pattrib->amsdu)
 	{
-		pnextrframe = LIST_CONTAINOR(plist, union recv_frame, u);
-		pnextattrib = &pnextrframe->u.hdr.attrib;
-
-		if(SN_LESS(pnextattrib->seq_num, pattrib->seq_num))
+		if ((padapter->bDriverStopped == _FALSE) &&
+		    (padapter->bSurpriseRemoved == _FALSE))
 		{
-			plist = get_next(plist);
+			rtw_recv_indicatepkt(padapter, prframe);//indicate this recv_frame
 		}
-		else if( SN_EQUAL(pnextattrib->seq_num, pattrib->seq_num))
+	}
+	else if(pattrib->amsdu==1)
+	{
+		if(amsdu_to_msdu(padapter, prframe)!=_SUCCESS)
 		{
-			//Duplicate entry is found!! Do not insert current entry.
-			//RT_TRACE(COMP_RX_REORDER, DBG_TRACE, ("InsertRxReorderList(): Duplicate packet is dropped!! IndicateSeq: %d, NewSeq: %d\n", pTS->RxIndicateSeq, SeqNum));
+			rtw_free_recvframe(prframe, &precvpriv->free_recv_queue);
+		}
+	}
+	else
+	{
+		//error condition;
+	}
+}
 
-			//_exit_critical_ex(&ppending_recvframe_queue->lock, &irql);
+//
+// Indicate the buffered frames the window has already slid past, i.e. those
+// between ring_seq and indicate_seq, and bring ring_seq up to indicate_seq.
+// Afterwards every buffered frame lies in [indicate_seq, indicate_seq + REORDER_RING_SIZE).
+//
+static void recv_reorder_flush_stale(_adapter *padapter, struct recv_reorder_ctrl *preorder_ctrl)
+{
+	union recv_frame *prframe;
+	u16 distance, i, slot;
 
-			return _FALSE;
-		}
-		else
+	if (preorder_ctrl->pending_cnt)
+	{
+		distance = (preorder_ctrl->indicate_seq - preorder_ctrl->ring_seq) & 0xFFF;
+		// a jump of a whole ring or more (or a restarted session) makes every slot stale
+		if (distance > REORDER_RING_SIZE)
+			distance = REORDER_RING_SIZE;
+
+		for (i = 0; i < distance && preorder_ctrl->pending_cnt; i++)
 		{
-			break;
+			slot = (preorder_ctrl->ring_seq + i) & (REORDER_RING_SIZE - 1);
+			prframe = preorder_ctrl->reorder_ring[slot];
+			if (prframe == NULL)
+				continue;
+
+			preorder_ctrl->reorder_ring[slot] = NULL;
+			preorder_ctrl->pending_cnt--;
+			recv_indicate_reorder_frame(padapter, prframe);
 		}
+	}
 
-		//DbgPrint("enqueue_reorder_recvframe():while\n");
+	preorder_ctrl->ring_seq = preorder_ctrl->indicate_seq;
+}
 
-	}
+int enqueue_reorder_recvframe(struct recv_reorder_ctrl *preorder_ctrl, union recv_frame *prframe);
+int enqueue_reorder_recvframe(struct recv_reorder_ctrl *preorder_ctrl, union recv_frame *prframe)
+{
+	struct rx_pkt_attrib *pattrib = &prframe->u.hdr.attrib;
+	u16 slot = pattrib->seq_num & (REORDER_RING_SIZE - 1);
 
+	//DbgPrint("+enqueue_reorder_recvframe()\n");
 
-	//_enter_critical_ex(&ppending_recvframe_queue->lock, &irql);
-	//_rtw_spinlock_ex(&ppending_recvframe_queue->lock);
+	// make room: a window shift may have left frames older than indicate_seq behind
+	recv_reorder_flush_stale(preorder_ctrl->padapter, preorder_ctrl);
 
-	rtw_list_delete(&(prframe->u.hdr.list));
+	if (preorder_ctrl->reorder_ring[slot] != NULL)
+	{
+		//Duplicate entry is found!! Do not insert current entry.
+		//RT_TRACE(COMP_RX_REORDER, DBG_TRACE, ("InsertRxReorderList(): Duplicate packet is dropped!! IndicateSeq: %d, NewSeq: %d\n", pTS->RxIndicateSeq, SeqNum));
+		return _FALSE;
+	}
 
-	rtw_list_insert_tail(&(prframe->u.hdr.list), plist);
+	rtw_list_delete(&(prframe->u.hdr.list));
 
-	//_rtw_spinunlock_ex(&ppending_recvframe_queue->lock);
-	//_exit_critical_ex(&ppending_recvframe_queue->lock, &irql);
+	preorder_ctrl->reorder_ring[slot] = prframe;
+	preorder_ctrl->pending_cnt++;
 
+	// check_indicate_seq() already moved indicate_seq past a frame arriving
+	// at the window start, keep it in range of the stale flush
+	if (SN_LESS(pattrib->seq_num, preorder_ctrl->indicate_seq))
+		preorder_ctrl->ring_seq = pattrib->seq_num;
 
 	//RT_TRACE(COMP_RX_REORDER, DBG_TRACE, ("InsertRxReorderList(): Pkt insert into buffer!! IndicateSeq: %d, NewSeq: %d\n", pTS->RxIndicateSeq, SeqNum));
 	return _TRUE;
@@ -3373,47 +3408,39 @@ void recv_indicatepkts_pkt_loss_cnt(struct debug_priv *pdbgpriv, u64 prev_seq, u
 int recv_indicatepkts_in_order(_adapter *padapter, struct recv_reorder_ctrl *preorder_ctrl, int bforced);
 int recv_indicatepkts_in_order(_adapter *padapter, struct recv_reorder_ctrl *preorder_ctrl, int bforced)
 {
-	//_irqL irql;
-	//u8 bcancelled;
-	_list	*phead, *plist;
 	union recv_frame *prframe;
 	struct rx_pkt_attrib *pattrib;
-	//u8 index = 0;
 	int bPktInBuf = _FALSE;
-	struct recv_priv *precvpriv = &padapter->recvpriv;
-	_queue *ppending_recvframe_queue = &preorder_ctrl->pending_recvframe_queue;
 	struct dvobj_priv *psdpriv = padapter->dvobj;
 	struct debug_priv *pdbgpriv = &psdpriv->drv_dbg;
+	u16 i, slot;
 
 	//DbgPrint("+recv_indicatepkts_in_order\n");
 
-	//_enter_critical_ex(&ppending_recvframe_queue->lock, &irql);
-	//_rtw_spinlock_ex(&ppending_recvframe_queue->lock);
-
-	phead =		get_list_head(ppending_recvframe_queue);
-	plist = get_next(phead);
-
-#if 0
-	// Check if there is any other indication thread running.
-	if(pTS->RxIndicateState == RXTS_INDICATE_PROCESSING)
-		return;
-#endif
+	recv_reorder_flush_stale(padapter, preorder_ctrl);
 
 	// Handling some condition for forced indicate case.
+	// Only the gap in front of the first buffered frame is given up.
 	if(bforced==_TRUE)
 	{
 		pdbgpriv->dbg_rx_ampdu_forced_indicate_count++;
-		if(rtw_is_list_empty(phead))
+		if(preorder_ctrl->pending_cnt == 0)
 		{
-			// _exit_critical_ex(&ppending_recvframe_queue->lock, &irql);
-			//_rtw_spinunlock_ex(&ppending_recvframe_queue->lock);
 			return _TRUE;
 		}
 
-		prframe = LIST_CONTAINOR(plist, union recv_frame, u);
+		for (i = 0; i < REORDER_RING_SIZE; i++)
+		{
+			slot = (preorder_ctrl->indicate_seq + i) & (REORDER_RING_SIZE - 1);
+			if (preorder_ctrl->reorder_ring[slot] != NULL)
+				break;
+		}
+
+		prframe = preorder_ctrl->reorder_ring[slot];
 		pattrib = &prframe->u.hdr.attrib;
 		recv_indicatepkts_pkt_loss_cnt(pdbgpriv,preorder_ctrl->indicate_seq,pattrib->seq_num);
 		preorder_ctrl->indicate_seq = pattrib->seq_num;
+		preorder_ctrl->ring_seq = preorder_ctrl->indicate_seq;
 		#ifdef DBG_RX_SEQ
 		DBG_871X("DBG_RX_SEQ %s:%d IndicateSeq: %d, NewSeq: %d\n", __FUNCTION__, __LINE__,
 			preorder_ctrl->indicate_seq, pattrib->seq_num);
@@ -3421,124 +3448,38 @@ int recv_indicatepkts_in_order(_adapter *padapter, struct recv_reorder_ctrl *pre
 	}
 
 	// Prepare indication list and indication.
-	// Check if there is any packet need indicate.
-	while(!rtw_is_list_empty(phead))
+	// Release the contiguous run starting at indicate_seq.
+	while(preorder_ctrl->pending_cnt)
 	{
+		slot = preorder_ctrl->indicate_seq & (REORDER_RING_SIZE - 1);
+		prframe = preorder_ctrl->reorder_ring[slot];
 
-		prframe = LIST_CONTAINOR(plist, union recv_frame, u);
-		pattrib = &prframe->u.hdr.attrib;
-
-		if(!SN_LESS(preorder_ctrl->indicate_seq, pattrib->seq_num))
-		{
-			RT_TRACE(_module_rtl871x_recv_c_, _drv_notice_,
-				 ("recv_indicatepkts_in_order: indicate=%d seq=%d amsdu=%d\n",
-				  preorder_ctrl->indicate_seq, pattrib->seq_num, pattrib->amsdu));
-
-#if 0
-			// This protect buffer from overflow.
-			if(index >= REORDER_WIN_SIZE)
-			{
-				RT_ASSERT(FALSE, ("IndicateRxReorderList(): Buffer overflow!! \n"));
-				bPktInBuf = TRUE;
-				break;
-			}
-#endif
-
-			plist = get_next(plist);
-			rtw_list_delete(&(prframe->u.hdr.list));
-
-			if(SN_EQUAL(preorder_ctrl->indicate_seq, pattrib->seq_num))
-			{
-				preorder_ctrl->indicate_seq = (preorder_ctrl->indicate_seq + 1) & 0xFFF;
-				#ifdef DBG_RX_SEQ
-				DBG_871X("DBG_RX_SEQ %s:%d IndicateSeq: %d, NewSeq: %d\n", __FUNCTION__, __LINE__,
-					preorder_ctrl->indicate_seq, pattrib->seq_num);
-				#endif
-			}
-
-#if 0
-			index++;
-			if(index==1)
-			{
-				//Cancel previous pending timer.
-				//PlatformCancelTimer(Adapter, &pTS->RxPktPendingTimer);
-				if(bforced!=_TRUE)
-				{
-					//DBG_871X("_cancel_timer(&preorder_ctrl->reordering_ctrl_timer, &bcancelled);\n");
-					_cancel_timer(&preorder_ctrl->reordering_ctrl_timer, &bcancelled);
-				}
-			}
-#endif
-
-			//Set this as a lock to make sure that only one thread is indicating packet.
-			//pTS->RxIndicateState = RXTS_INDICATE_PROCESSING;
-
-			// Indicate packets
-			//RT_ASSERT((index<=REORDER_WIN_SIZE), ("RxReorderIndicatePacket(): Rx Reorder buffer full!! \n"));
-
-
-			//indicate this recv_frame
-			//DbgPrint("recv_indicatepkts_in_order, indicate_seq=%d, seq_num=%d\n", precvpriv->indicate_seq, pattrib->seq_num);
-			if(!pattrib->amsdu)
-			{
-				//DBG_871X("recv_indicatepkts_in_order, amsdu!=1, indicate_seq=%d, seq_num=%d\n", preorder_ctrl->indicate_seq, pattrib->seq_num);
-
-				if ((padapter->bDriverStopped == _FALSE) &&
-				    (padapter->bSurpriseRemoved == _FALSE))
-				{
-
-					rtw_recv_indicatepkt(padapter, prframe);//indicate this recv_frame
-
-				}
-			}
-			else if(pattrib->amsdu==1)
-			{
-				if(amsdu_to_msdu(padapter, prframe)!=_SUCCESS)
-				{
-					rtw_free_recvframe(prframe, &precvpriv->free_recv_queue);
-				}
-			}
-			else
-			{
-				//error condition;
-			}
-
-
-			//Update local variables.
-			bPktInBuf = _FALSE;
-
-		}
-		else
+		if(prframe == NULL)
 		{
 			bPktInBuf = _TRUE;
 			break;
 		}
 
-		//DbgPrint("recv_indicatepkts_in_order():while\n");
+		pattrib = &prframe->u.hdr.attrib;
 
-	}
+		RT_TRACE(_module_rtl871x_recv_c_, _drv_notice_,
+			 ("recv_indicatepkts_in_order: indicate=%d seq=%d amsdu=%d\n",
+			  preorder_ctrl->indicate_seq, pattrib->seq_num, pattrib->amsdu));
 
-	//_rtw_spinunlock_ex(&ppending_recvframe_queue->lock);
-	//_exit_critical_ex(&ppending_recvframe_queue->lock, &irql);
+		preorder_ctrl->reorder_ring[slot] = NULL;
+		preorder_ctrl->pending_cnt--;
 
-/*
-	//Release the indication lock and set to new indication step.
-	if(bPktInBuf)
-	{
-		// Set new pending timer.
-		//pTS->RxIndicateState = RXTS_INDICATE_REORDER;
-		//PlatformSetTimer(Adapter, &pTS->RxPktPendingTimer, pHTInfo->RxReorderPendingTime);
-		//DBG_871X("_set_timer(&preorder_ctrl->reordering_ctrl_timer, REORDER_WAIT_TIME)\n");
-		_set_timer(&preorder_ctrl->reordering_ctrl_timer, REORDER_WAIT_TIME);
-	}
-	else
-	{
-		//pTS->RxIndicateState = RXTS_INDICATE_IDLE;
+		preorder_ctrl->indicate_seq = (preorder_ctrl->indicate_seq + 1) & 0xFFF;
+		#ifdef DBG_RX_SEQ
+		DBG_871X("DBG_RX_SEQ %s:%d IndicateSeq: %d, NewSeq: %d\n", __FUNCTION__, __LINE__,
+			preorder_ctrl->indicate_seq, pattrib->seq_num);
+		#endif
+
+		recv_indicate_reorder_frame(padapter, prframe);
 	}
-*/
-	//_exit_critical_ex(&ppending_recvframe_queue->lock, &irql);
 
-	//return _TRUE;
+	preorder_ctrl->ring_seq = preorder_ctrl->indicate_seq;
+
 	return bPktInBuf;
 
 }
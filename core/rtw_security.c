@@ -426,14 +426,7 @@ _func_enter_;
 	if( pmicdata->nBytesInM >= 4 )
 	{
 		pmicdata->L ^= pmicdata->M;
-		pmicdata->R ^= ROL32( pmicdata->L, 17 );
-		pmicdata->L += pmicdata->R;
-		pmicdata->R ^= ((pmicdata->L & 0xff00ff00) >> 8) | ((pmicdata->L & 0x00ff00ff) << 8);
-		pmicdata->L += pmicdata->R;
-		pmicdata->R ^= ROL32( pmicdata->L, 3 );
-		pmicdata->L += pmicdata->R;
-		pmicdata->R ^= ROR32( pmicdata->L, 2 );
-		pmicdata->L += pmicdata->R;
+		MICHAEL_BLOCK( pmicdata->L, pmicdata->R );
 		// Clear the buffer
 		pmicdata->M = 0;
 		pmicdata->nBytesInM = 0;
@@ -443,8 +436,29 @@ _func_exit_;
 
 void rtw_secmicappend(struct mic_data *pmicdata, u8 * src, u32 nbytes )
 {
+	u32 l, r;
 _func_enter_;
-	// This is simple
+	// Top up a partially filled word first
+	while( nbytes > 0 && pmicdata->nBytesInM != 0 )
+	{
+		rtw_secmicappendbyte(pmicdata, *src++ );
+		nbytes--;
+	}
+
+	// then run whole little-endian words with the state kept in registers
+	l = pmicdata->L;
+	r = pmicdata->R;
+	while( nbytes >= 4 )
+	{
+		l ^= RTW_GET_LE32( src );
+		MICHAEL_BLOCK( l, r );
+		src += 4;
+		nbytes -= 4;
+	}
+	pmicdata->L = l;
+	pmicdata->R = r;
+
+	// and buffer the tail
 	while( nbytes > 0 )
 	{
 		rtw_secmicappendbyte(pmicdata, *src++ );
@@ -456,18 +470,12 @@ _func_exit_;
 void rtw_secgetmic(struct mic_data *pmicdata, u8 * dst )
 {
 _func_enter_;
-	// Append the minimum padding
-	rtw_secmicappendbyte(pmicdata, 0x5a );
-	rtw_secmicappendbyte(pmicdata, 0 );
-	rtw_secmicappendbyte(pmicdata, 0 );
-	rtw_secmicappendbyte(pmicdata, 0 );
-	rtw_secmicappendbyte(pmicdata, 0 );
-	// and then zeroes until the length is a multiple of 4
-	while( pmicdata->nBytesInM != 0 )
-	{
-		rtw_secmicappendbyte(pmicdata, 0 );
-	}
-	// The appendByte function has already computed the result.
+	// The padding is 0x5a, four zeroes, then zeroes up to a multiple of 4:
+	// that always closes the current word with 0x5a and adds one zero word.
+	pmicdata->L ^= pmicdata->M | (0x5aUL << (8*pmicdata->nBytesInM));
+	MICHAEL_BLOCK( pmicdata->L, pmicdata->R );
+	MICHAEL_BLOCK( pmicdata->L, pmicdata->R );
+	// The block function has already computed the result.
 	secmicputuint32( dst, pmicdata->L );
 	secmicputuint32( dst+4, pmicdata->R );
 	// Reset to the empty message.
@@ -721,6 +729,33 @@ _func_exit_;
 }
 
 
+/*
+* Phase 1 through the per-station cache: recomputed only when TK, TA or
+* IV32 differ from the last MPDU seen in this direction.
+*/
+static void phase1_cached(struct sta_info *psta, u8 dir, u16 *p1k, const u8 *tk, const u8 *ta, u32 iv32)
+{
+	struct tkip_p1k_cache *pcache = &psta->tkip_p1k[dir];
+	_irqL irqL;
+
+	_enter_critical_bh(&psta->tkip_p1k_lock, &irqL);
+
+	if (!pcache->valid || pcache->iv32 != iv32
+		|| _rtw_memcmp((void *)pcache->tk, (void *)tk, 16) == _FALSE
+		|| _rtw_memcmp((void *)pcache->ta, (void *)ta, ETH_ALEN) == _FALSE)
+	{
+		phase1(pcache->p1k, tk, ta, iv32);
+		memcpy(pcache->tk, tk, 16);
+		memcpy(pcache->ta, ta, ETH_ALEN);
+		pcache->iv32 = iv32;
+		pcache->valid = 1;
+	}
+	memcpy(p1k, pcache->p1k, sizeof(pcache->p1k));
+
+	_exit_critical_bh(&psta->tkip_p1k_lock, &irqL);
+}
+
+
 //The hlen isn't include the IV
 u32	rtw_tkip_encrypt(_adapter *padapter, u8 *pxmitframe)
 {																	// exclude ICV
@@ -795,7 +830,7 @@ _func_enter_;
 				pnl=(u16)(dot11txpn.val);
 				pnh=(u32)(dot11txpn.val>>16);
 
-				phase1((u16 *)&ttkey[0],prwskey,&pattrib->ta[0],pnh);
+				phase1_cached(stainfo, TKIP_P1K_TX, (u16 *)&ttkey[0], prwskey, &pattrib->ta[0], pnh);
 
 				phase2(&rc4key[0],prwskey,(u16 *)&ttkey[0],pnl);
 
@@ -925,7 +960,8 @@ _func_enter_;
 			pnl=(u16)(dot11txpn.val);
 			pnh=(u32)(dot11txpn.val>>16);
 
-			phase1((u16 *)&ttkey[0],prwskey,&prxattrib->ta[0],pnh);
+			phase1_cached(stainfo, IS_MCAST(prxattrib->ra) ? TKIP_P1K_RX_GRP : TKIP_P1K_RX,
+				(u16 *)&ttkey[0], prwskey, &prxattrib->ta[0], pnh);
 			phase2(&rc4key[0],prwskey,(unsigned short *)&ttkey[0],pnl);
 
 			//4 decrypt payload include icv
@@ -962,46 +998,6 @@ exit:
 
 
 #define MAX_MSG_SIZE	2048
-/*****************************/
-/******** SBOX Table *********/
-/*****************************/
-
-  static  u8 sbox_table[256] =
-    {
-        0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5,
-        0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
-        0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0,
-        0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
-        0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc,
-        0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
-        0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a,
-        0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
-        0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0,
-        0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
-        0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b,
-        0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
-        0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85,
-        0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
-        0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5,
-        0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
-        0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17,
-        0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
-        0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88,
-        0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
-        0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c,
-        0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
-        0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9,
-        0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
-        0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6,
-        0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
-        0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e,
-        0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
-        0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94,
-        0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
-        0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68,
-        0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16
-    };
-
 /*****************************/
 /**** Function Prototypes ****/
 /*****************************/
@@ -1033,218 +1029,9 @@ static void construct_ctr_preload(
                         u8 *pn_vector,
                         sint c,
                         uint frtype);// add for CONFIG_IEEE80211W, none 11w also can use
-static void xor_128(u8 *a, u8 *b, u8 *out);
-static void xor_32(u8 *a, u8 *b, u8 *out);
-static u8 sbox(u8 a);
-static void next_key(u8 *key, sint round);
-static void byte_sub(u8 *in, u8 *out);
-static void shift_row(u8 *in, u8 *out);
-static void mix_column(u8 *in, u8 *out);
-static void add_round_key( u8 *shiftrow_in,
-                    u8 *mcol_in,
-                    u8 *block_in,
-                    sint round,
-                    u8 *out);
-static void aes128k128d(u8 *key, u8 *data, u8 *ciphertext);
-
-
-/****************************************/
-/* aes128k128d()                        */
-/* Performs a 128 bit AES encrypt with  */
-/* 128 bit data.                        */
-/****************************************/
-static void xor_128(u8 *a, u8 *b, u8 *out)
-{
-    sint i;
-_func_enter_;
-    for (i=0;i<16; i++)
-    {
-        out[i] = a[i] ^ b[i];
-    }
-_func_exit_;
-}
-
-
-static void xor_32(u8 *a, u8 *b, u8 *out)
-{
-    sint i;
-_func_enter_;
-    for (i=0;i<4; i++)
-    {
-        out[i] = a[i] ^ b[i];
-    }
-_func_exit_;
-}
-
-
-static u8 sbox(u8 a)
-{
-    return sbox_table[(sint)a];
-}
-
-
-static void next_key(u8 *key, sint round)
-{
-    u8 rcon;
-    u8 sbox_key[4];
-    u8 rcon_table[12] =
-    {
-        0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,
-        0x1b, 0x36, 0x36, 0x36
-    };
-_func_enter_;
-    sbox_key[0] = sbox(key[13]);
-    sbox_key[1] = sbox(key[14]);
-    sbox_key[2] = sbox(key[15]);
-    sbox_key[3] = sbox(key[12]);
-
-    rcon = rcon_table[round];
-
-    xor_32(&key[0], sbox_key, &key[0]);
-    key[0] = key[0] ^ rcon;
-
-    xor_32(&key[4], &key[0], &key[4]);
-    xor_32(&key[8], &key[4], &key[8]);
-    xor_32(&key[12], &key[8], &key[12]);
-_func_exit_;
-}
-
-
-static void byte_sub(u8 *in, u8 *out)
-{
-    sint i;
-_func_enter_;
-    for (i=0; i< 16; i++)
-    {
-        out[i] = sbox(in[i]);
-    }
-_func_exit_;
-}
-
-
-static void shift_row(u8 *in, u8 *out)
-{
-_func_enter_;
-    out[0] =  in[0];
-    out[1] =  in[5];
-    out[2] =  in[10];
-    out[3] =  in[15];
-    out[4] =  in[4];
-    out[5] =  in[9];
-    out[6] =  in[14];
-    out[7] =  in[3];
-    out[8] =  in[8];
-    out[9] =  in[13];
-    out[10] = in[2];
-    out[11] = in[7];
-    out[12] = in[12];
-    out[13] = in[1];
-    out[14] = in[6];
-    out[15] = in[11];
-_func_exit_;
-}
-
-
-static void mix_column(u8 *in, u8 *out)
-{
-    sint i;
-    u8 add1b[4];
-    u8 add1bf7[4];
-    u8 rotl[4];
-    u8 swap_halfs[4];
-    u8 andf7[4];
-    u8 rotr[4];
-    u8 temp[4];
-    u8 tempb[4];
-_func_enter_;
-    for (i=0 ; i<4; i++)
-    {
-        if ((in[i] & 0x80)== 0x80)
-            add1b[i] = 0x1b;
-        else
-            add1b[i] = 0x00;
-    }
-
-    swap_halfs[0] = in[2];    /* Swap halfs */
-    swap_halfs[1] = in[3];
-    swap_halfs[2] = in[0];
-    swap_halfs[3] = in[1];
-
-    rotl[0] = in[3];        /* Rotate left 8 bits */
-    rotl[1] = in[0];
-    rotl[2] = in[1];
-    rotl[3] = in[2];
-
-    andf7[0] = in[0] & 0x7f;
-    andf7[1] = in[1] & 0x7f;
-    andf7[2] = in[2] & 0x7f;
-    andf7[3] = in[3] & 0x7f;
-
-    for (i = 3; i>0; i--)    /* logical shift left 1 bit */
-    {
-        andf7[i] = andf7[i] << 1;
-        if ((andf7[i-1] & 0x80) == 0x80)
-        {
-            andf7[i] = (andf7[i] | 0x01);
-        }
-    }
-    andf7[0] = andf7[0] << 1;
-    andf7[0] = andf7[0] & 0xfe;
-
-    xor_32(add1b, andf7, add1bf7);
-
-    xor_32(in, add1bf7, rotr);
-
-    temp[0] = rotr[0];         /* Rotate right 8 bits */
-    rotr[0] = rotr[1];
-    rotr[1] = rotr[2];
-    rotr[2] = rotr[3];
-    rotr[3] = temp[0];
-
-    xor_32(add1bf7, rotr, temp);
-    xor_32(swap_halfs, rotl,tempb);
-    xor_32(temp, tempb, out);
-_func_exit_;
-}
-
-
-static void aes128k128d(u8 *key, u8 *data, u8 *ciphertext)
-{
-    sint round;
-    sint i;
-    u8 intermediatea[16];
-    u8 intermediateb[16];
-    u8 round_key[16];
-_func_enter_;
-    for(i=0; i<16; i++) round_key[i] = key[i];
-
-    for (round = 0; round < 11; round++)
-    {
-        if (round == 0)
-        {
-            xor_128(round_key, data, ciphertext);
-            next_key(round_key, round);
-        }
-        else if (round == 10)
-        {
-            byte_sub(ciphertext, intermediatea);
-            shift_row(intermediatea, intermediateb);
-            xor_128(intermediateb, round_key, ciphertext);
-        }
-        else    /* 1 - 9 */
-        {
-            byte_sub(ciphertext, intermediatea);
-            shift_row(intermediatea, intermediateb);
-            mix_column(&intermediateb[0], &intermediatea[0]);
-            mix_column(&intermediateb[4], &intermediatea[4]);
-            mix_column(&intermediateb[8], &intermediatea[8]);
-            mix_column(&intermediateb[12], &intermediatea[12]);
-            xor_128(intermediatea, round_key, ciphertext);
-            next_key(round_key, round);
-        }
-    }
-_func_exit_;
-}
+// T-table AES core shared with BIP, see the AES tables below
+static void rijndaelKeySetupEnc(u32 rk[/*44*/], const u8 cipherKey[]);
+static void rijndaelEncrypt(u32 rk[/*44*/], u8 pt[16], u8 ct[16]);
 
 
 /************************************************/
@@ -1445,7 +1232,7 @@ _func_exit_;
 }
 
 
-static sint aes_cipher(u8 *key, uint	hdrlen,
+static sint aes_cipher(u32 *rk, uint	hdrlen,
 			u8 *pframe, uint plen)
 {
 //	/*static*/ unsigned char	message[MAX_MSG_SIZE];
@@ -1549,18 +1336,18 @@ _func_enter_;
     payload_index = (hdrlen + 8);
 
     /* Calculate MIC */
-    aes128k128d(key, mic_iv, aes_out);
+    rijndaelEncrypt(rk, mic_iv, aes_out);
     bitwise_xor(aes_out, mic_header1, chain_buffer);
-    aes128k128d(key, chain_buffer, aes_out);
+    rijndaelEncrypt(rk, chain_buffer, aes_out);
     bitwise_xor(aes_out, mic_header2, chain_buffer);
-    aes128k128d(key, chain_buffer, aes_out);
+    rijndaelEncrypt(rk, chain_buffer, aes_out);
 
 	for (i = 0; i < num_blocks; i++)
     {
         bitwise_xor(aes_out, &pframe[payload_index], chain_buffer);//bitwise_xor(aes_out, &message[payload_index], chain_buffer);
 
         payload_index += 16;
-        aes128k128d(key, chain_buffer, aes_out);
+        rijndaelEncrypt(rk, chain_buffer, aes_out);
     }
 
     /* Add on the final payload block if it needs padding */
@@ -1572,7 +1359,7 @@ _func_enter_;
             padded_buffer[j] = pframe[payload_index++];//padded_buffer[j] = message[payload_index++];
         }
         bitwise_xor(aes_out, padded_buffer, chain_buffer);
-        aes128k128d(key, chain_buffer, aes_out);
+        rijndaelEncrypt(rk, chain_buffer, aes_out);
 
     }
 
@@ -1594,7 +1381,7 @@ _func_enter_;
                                 pn_vector,
                                 i+1,
                                 frtype); // add for CONFIG_IEEE80211W, none 11w also can use
-	        aes128k128d(key, ctr_preload, aes_out);
+	        rijndaelEncrypt(rk, ctr_preload, aes_out);
 		bitwise_xor(aes_out, &pframe[payload_index], chain_buffer);//bitwise_xor(aes_out, &message[payload_index], chain_buffer);
 	        for (j=0; j<16;j++)
 			 pframe[payload_index++] = chain_buffer[j];//for (j=0; j<16;j++) message[payload_index++] = chain_buffer[j];
@@ -1616,7 +1403,7 @@ _func_enter_;
         {
             padded_buffer[j] = pframe[payload_index+j];//padded_buffer[j] = message[payload_index+j];
         }
-        aes128k128d(key, ctr_preload, aes_out);
+        rijndaelEncrypt(rk, ctr_preload, aes_out);
         bitwise_xor(aes_out, padded_buffer, chain_buffer);
         for (j=0; j<payload_remainder;j++) pframe[payload_index++] = chain_buffer[j];//for (j=0; j<payload_remainder;j++) message[payload_index++] = chain_buffer[j];
     }
@@ -1637,7 +1424,7 @@ _func_enter_;
         padded_buffer[j] = pframe[j+hdrlen+8+plen];//padded_buffer[j] = message[j+hdrlen+8+plen];
     }
 
-    aes128k128d(key, ctr_preload, aes_out);
+    rijndaelEncrypt(rk, ctr_preload, aes_out);
     bitwise_xor(aes_out, padded_buffer, chain_buffer);
     for (j=0; j<8;j++) pframe[payload_index++] = chain_buffer[j];//for (j=0; j<8;j++) message[payload_index++] = chain_buffer[j];
 _func_exit_;
@@ -1656,8 +1443,8 @@ u32	rtw_aes_encrypt(_adapter *padapter, u8 *pxmitframe)
 
 	/* Intermediate Buffers */
 	sint	curfragnum,length;
-	u32	prwskeylen;
-	u8	*pframe,*prwskey;	//, *payload,*iv
+	u8	*pframe;	//, *payload,*iv
+	u32	*rk;
 	struct	sta_info		*stainfo=NULL;
 	struct	pkt_attrib	 *pattrib = &((struct xmit_frame *)pxmitframe)->attrib;
 	struct	security_priv	*psecuritypriv=&padapter->securitypriv;
@@ -1700,13 +1487,14 @@ _func_enter_;
 
 			RT_TRACE(_module_rtl871x_security_c_,_drv_err_,("rtw_aes_encrypt: stainfo!=NULL!!!\n"));
 
+			// key schedules are expanded once, by the set-key paths
 			if(IS_MCAST(pattrib->ra))
 			{
-				prwskey=psecuritypriv->dot118021XGrpKey[psecuritypriv->dot118021XGrpKeyid].skey;
+				rk=psecuritypriv->dot118021XGrpKey_rk[psecuritypriv->dot118021XGrpKeyid];
 			}
 			else
 			{
-				prwskey=&stainfo->dot118021x_UncstKey.skey[0];
+				rk=stainfo->aes_rk;
 			}
 
 #ifdef CONFIG_TDLS	//swencryption
@@ -1716,24 +1504,22 @@ _func_enter_;
 				if((ptdls_sta != NULL) && (ptdls_sta->tdls_sta_state & TDLS_LINKED_STATE) )
 				{
 					DBG_871X("[%s] for tdls link\n", __FUNCTION__);
-					prwskey=&ptdls_sta->tpk.tk[0];
+					rk=ptdls_sta->aes_rk;
 				}
 			}
 #endif //CONFIG_TDLS
 
-			prwskeylen=16;
-
 			for(curfragnum=0;curfragnum<pattrib->nr_frags;curfragnum++){
 
 				if((curfragnum+1)==pattrib->nr_frags){	//4 the last fragment
 					length=pattrib->last_txcmdsz-pattrib->hdrlen-pattrib->iv_len- pattrib->icv_len;
 
-					aes_cipher(prwskey,pattrib->hdrlen,pframe, length);
+					aes_cipher(rk,pattrib->hdrlen,pframe, length);
 				}
 				else{
 					length=pxmitpriv->frag_len-pattrib->hdrlen-pattrib->iv_len-pattrib->icv_len ;
 
-					aes_cipher(prwskey,pattrib->hdrlen,pframe, length);
+					aes_cipher(rk,pattrib->hdrlen,pframe, length);
 				pframe+=pxmitpriv->frag_len;
 				pframe=(u8*)RND4((SIZE_PTR)(pframe));
 
@@ -1756,7 +1542,7 @@ _func_exit_;
 		return res;
 }
 
-static sint aes_decipher(u8 *key, uint	hdrlen,
+static sint aes_decipher(u32 *rk, uint	hdrlen,
 			u8 *pframe, uint plen)
 {
 	static u8	message[MAX_MSG_SIZE];
@@ -1852,7 +1638,7 @@ _func_enter_;
                                 frtype // add for CONFIG_IEEE80211W, none 11w also can use
                             );
 
-        aes128k128d(key, ctr_preload, aes_out);
+        rijndaelEncrypt(rk, ctr_preload, aes_out);
         bitwise_xor(aes_out, &pframe[payload_index], chain_buffer);
 
         for (j=0; j<16;j++) pframe[payload_index++] = chain_buffer[j];
@@ -1875,7 +1661,7 @@ _func_enter_;
         {
             padded_buffer[j] = pframe[payload_index+j];
         }
-        aes128k128d(key, ctr_preload, aes_out);
+        rijndaelEncrypt(rk, ctr_preload, aes_out);
         bitwise_xor(aes_out, padded_buffer, chain_buffer);
         for (j=0; j<payload_remainder;j++) pframe[payload_index++] = chain_buffer[j];
     }
@@ -1925,18 +1711,18 @@ _func_enter_;
     payload_index = (hdrlen + 8);
 
     /* Calculate MIC */
-    aes128k128d(key, mic_iv, aes_out);
+    rijndaelEncrypt(rk, mic_iv, aes_out);
     bitwise_xor(aes_out, mic_header1, chain_buffer);
-    aes128k128d(key, chain_buffer, aes_out);
+    rijndaelEncrypt(rk, chain_buffer, aes_out);
     bitwise_xor(aes_out, mic_header2, chain_buffer);
-    aes128k128d(key, chain_buffer, aes_out);
+    rijndaelEncrypt(rk, chain_buffer, aes_out);
 
 	for (i = 0; i < num_blocks; i++)
     {
         bitwise_xor(aes_out, &message[payload_index], chain_buffer);
 
         payload_index += 16;
-        aes128k128d(key, chain_buffer, aes_out);
+        rijndaelEncrypt(rk, chain_buffer, aes_out);
     }
 
     /* Add on the final payload block if it needs padding */
@@ -1948,7 +1734,7 @@ _func_enter_;
             padded_buffer[j] = message[payload_index++];
         }
         bitwise_xor(aes_out, padded_buffer, chain_buffer);
-        aes128k128d(key, chain_buffer, aes_out);
+        rijndaelEncrypt(rk, chain_buffer, aes_out);
 
     }
 
@@ -1968,7 +1754,7 @@ _func_enter_;
                                 pn_vector,
                                 i+1,
                                 frtype); // add for CONFIG_IEEE80211W, none 11w also can use
-        aes128k128d(key, ctr_preload, aes_out);
+        rijndaelEncrypt(rk, ctr_preload, aes_out);
         bitwise_xor(aes_out, &message[payload_index], chain_buffer);
         for (j=0; j<16;j++) message[payload_index++] = chain_buffer[j];
     }
@@ -1989,7 +1775,7 @@ _func_enter_;
         {
             padded_buffer[j] = message[payload_index+j];
         }
-        aes128k128d(key, ctr_preload, aes_out);
+        rijndaelEncrypt(rk, ctr_preload, aes_out);
         bitwise_xor(aes_out, padded_buffer, chain_buffer);
         for (j=0; j<payload_remainder;j++) message[payload_index++] = chain_buffer[j];
     }
@@ -2010,7 +1796,7 @@ _func_enter_;
         padded_buffer[j] = message[j+hdrlen+8+plen-8];
     }
 
-    aes128k128d(key, ctr_preload, aes_out);
+    rijndaelEncrypt(rk, ctr_preload, aes_out);
     bitwise_xor(aes_out, padded_buffer, chain_buffer);
     for (j=0; j<8;j++) message[payload_index++] = chain_buffer[j];
 
@@ -2050,7 +1836,8 @@ u32	rtw_aes_decrypt(_adapter *padapter, u8 *precvframe)
 
 
 	sint		length;
-	u8	*pframe,*prwskey;	//, *payload,*iv
+	u8	*pframe;	//, *payload,*iv
+	u32	*rk;
 	struct	sta_info		*stainfo;
 	struct	rx_pkt_attrib	 *prxattrib = &((union recv_frame *)precvframe)->u.hdr.attrib;
 	struct	security_priv	*psecuritypriv=&padapter->securitypriv;
@@ -2106,7 +1893,7 @@ _func_enter_;
 				no_gkey_bc_cnt = 0;
 				no_gkey_mc_cnt = 0;
 
-				prwskey = psecuritypriv->dot118021XGrpKey[prxattrib->key_index].skey;
+				rk = psecuritypriv->dot118021XGrpKey_rk[prxattrib->key_index];
 
 				if(psecuritypriv->dot118021XGrpKeyid != prxattrib->key_index)
 				{
@@ -2118,7 +1905,7 @@ _func_enter_;
 			}
 			else
 			{
-				prwskey=&stainfo->dot118021x_UncstKey.skey[0];
+				rk=stainfo->aes_rk;
 			}
 
 			length= ((union recv_frame *)precvframe)->u.hdr.len-prxattrib->hdrlen-prxattrib->iv_len;
@@ -2145,7 +1932,7 @@ _func_enter_;
 				printk("\n");
 			}*/
 
-			res= aes_decipher(prwskey,prxattrib->hdrlen,pframe, length);
+			res= aes_decipher(rk,prxattrib->hdrlen,pframe, length);
 
 			AES_SW_DEC_CNT_INC(psecuritypriv, prxattrib->ra);
 		}
@@ -2776,6 +2563,12 @@ static void rijndaelKeySetupEnc(u32 rk[/*44*/], const u8 cipherKey[])
 	}
 }
 
+// for the set-key paths, so that CCMP doesn't expand the key per MPDU
+void rtw_aes_key_setup(u32 *rk, const u8 *key)
+{
+	rijndaelKeySetupEnc(rk, key);
+}
+
 static void rijndaelEncrypt(u32 rk[/*44*/], u8 pt[16], u8 ct[16])
 {
 	u32 s0, s1, s2, s3, t0, t1, t2, t3;
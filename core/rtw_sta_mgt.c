@@ -37,6 +37,7 @@ _func_enter_;
 	_rtw_memset((u8 *)psta, 0, sizeof (struct sta_info));
 
 	 _rtw_spinlock_init(&psta->lock);
+	_rtw_spinlock_init(&psta->tkip_p1k_lock);
 	_rtw_init_listhead(&psta->list);
 	_rtw_init_listhead(&psta->hash_list);
 	//_rtw_init_listhead(&psta->asoc_list);
@@ -85,20 +86,178 @@ _func_exit_;
 
 }
 
+// sta_info is several KB (xmit queues, 16 reorder rings), so the pool is
+// grown from a slab shared by all adapters instead of being allocated up front
+static struct kmem_cache *rtw_stainfo_cache = NULL;
+static int rtw_stainfo_cache_users = 0;
+static atomic_t GlobalMutexForStainfoCache = ATOMIC_INIT(0);
+
+static struct kmem_cache *rtw_get_stainfo_cache(void)
+{
+	ACQUIRE_GLOBAL_MUTEX(GlobalMutexForStainfoCache);
+	if (rtw_stainfo_cache == NULL)
+		rtw_stainfo_cache = kmem_cache_create("rtw_sta_info", sizeof(struct sta_info), 0, 0, NULL);
+	if (rtw_stainfo_cache)
+		rtw_stainfo_cache_users++;
+	RELEASE_GLOBAL_MUTEX(GlobalMutexForStainfoCache);
+
+	return rtw_stainfo_cache;
+}
+
+static void rtw_put_stainfo_cache(void)
+{
+	ACQUIRE_GLOBAL_MUTEX(GlobalMutexForStainfoCache);
+	if (rtw_stainfo_cache && --rtw_stainfo_cache_users == 0) {
+		// stainfo given back through call_rcu must be gone first
+		rcu_barrier();
+		kmem_cache_destroy(rtw_stainfo_cache);
+		rtw_stainfo_cache = NULL;
+	}
+	RELEASE_GLOBAL_MUTEX(GlobalMutexForStainfoCache);
+}
+
+// take a new sta_info from the slab, caller holds sta_hash_lock
+static struct sta_info *rtw_grow_stainfo(struct sta_priv *pstapriv)
+{
+	struct sta_info *psta;
+	u16 idx;
+
+	if (pstapriv->stainfo_cnt >= pstapriv->max_stainfo)
+		return NULL;
+
+	for (idx = 0; idx < pstapriv->max_stainfo; idx++)
+		if (pstapriv->stainfo_tbl[idx] == NULL)
+			break;
+
+	psta = kmem_cache_alloc(rtw_stainfo_cache, GFP_ATOMIC);
+	if (psta == NULL)
+		return NULL;
+
+	_rtw_init_stainfo(psta);
+	psta->stainfo_idx = idx;
+#ifdef CONFIG_STA_LOOKUP_TABLE
+	psta->mac_key = STA_MAC_KEY_INVALID;
+#endif
+
+	pstapriv->stainfo_tbl[idx] = psta;
+	pstapriv->stainfo_cnt++;
+
+	return psta;
+}
+
+static void rtw_stainfo_rcu_free(struct rcu_head *head)
+{
+	kmem_cache_free(rtw_stainfo_cache, container_of(head, struct sta_info, rcu));
+}
+
+// hand sta_info that idled on free_sta_queue for STAINFO_IDLE_TIMEOUT back to the slab
+void rtw_shrink_stainfo(struct sta_priv *pstapriv)
+{
+	_irqL	irqL;
+	_list	*plist, *phead;
+	struct sta_info *psta;
+
+	_enter_critical_bh(&pstapriv->sta_hash_lock, &irqL);
+
+	phead = get_list_head(&pstapriv->free_sta_queue);
+	plist = get_next(phead);
+
+	while (rtw_end_of_queue_search(phead, plist) == _FALSE
+		&& pstapriv->stainfo_cnt > STAINFO_POOL_RESERVE)
+	{
+		psta = LIST_CONTAINOR(plist, struct sta_info, list);
+		plist = get_next(plist);
+
+		if (rtw_get_passing_time_ms(psta->free_time) < STAINFO_IDLE_TIMEOUT)
+			continue;
+
+		rtw_list_delete(&psta->list);
+		pstapriv->stainfo_tbl[psta->stainfo_idx] = NULL;
+		pstapriv->stainfo_cnt--;
+
+		// rtw_get_stainfo readers may still be looking at it
+		call_rcu(&psta->rcu, rtw_stainfo_rcu_free);
+	}
+
+	_exit_critical_bh(&pstapriv->sta_hash_lock, &irqL);
+}
+
+static void rtw_mfree_sta_priv_mem(struct sta_priv *pstapriv)
+{
+	u16 i;
+
+	if (pstapriv->stainfo_tbl) {
+		for (i = 0; i < pstapriv->max_stainfo; i++)
+			if (pstapriv->stainfo_tbl[i])
+				kmem_cache_free(rtw_stainfo_cache, pstapriv->stainfo_tbl[i]);
+		rtw_mfree((u8 *)pstapriv->stainfo_tbl, sizeof(struct sta_info *) * pstapriv->max_stainfo);
+		pstapriv->stainfo_tbl = NULL;
+	}
+	pstapriv->stainfo_cnt = 0;
+
+#ifdef CONFIG_STA_LOOKUP_TABLE
+	if (pstapriv->sta_lookup) {
+		rtw_mfree((u8 *)pstapriv->sta_lookup, sizeof(struct sta_info *) * pstapriv->sta_lookup_size);
+		pstapriv->sta_lookup = NULL;
+	}
+#endif
+
+#ifdef CONFIG_AP_MODE
+	if (pstapriv->sta_aid) {
+		rtw_mfree((u8 *)pstapriv->sta_aid, sizeof(struct sta_info *) * pstapriv->max_stainfo);
+		pstapriv->sta_aid = NULL;
+	}
+	if (pstapriv->aid_bitmap) {
+		rtw_mfree((u8 *)pstapriv->aid_bitmap, BITS_TO_LONGS(pstapriv->max_stainfo) * sizeof(unsigned long));
+		pstapriv->aid_bitmap = NULL;
+	}
+	if (pstapriv->sta_dz_bitmap) {
+		rtw_mfree(pstapriv->sta_dz_bitmap, pstapriv->tim_bitmap_len);
+		pstapriv->sta_dz_bitmap = NULL;
+	}
+	if (pstapriv->tim_bitmap) {
+		rtw_mfree(pstapriv->tim_bitmap, pstapriv->tim_bitmap_len);
+		pstapriv->tim_bitmap = NULL;
+	}
+#endif
+
+	if (pstapriv->max_stainfo) {
+		rtw_put_stainfo_cache();
+		pstapriv->max_stainfo = 0;
+	}
+}
+
 u32	_rtw_init_sta_priv(struct	sta_priv *pstapriv)
 {
+	struct registry_priv *pregistrypriv = &pstapriv->padapter->registrypriv;
 	struct sta_info *psta;
 	s32 i;
 
 _func_enter_;
 
-	pstapriv->pallocated_stainfo_buf = rtw_zvmalloc (sizeof(struct sta_info) * NUM_STA+ 4);
+	pstapriv->max_stainfo = pregistrypriv->max_sta;
+	if (pstapriv->max_stainfo < NUM_STA)
+		pstapriv->max_stainfo = NUM_STA;
+	if (pstapriv->max_stainfo > NUM_STA_LIMIT)
+		pstapriv->max_stainfo = NUM_STA_LIMIT;
 
-	if(!pstapriv->pallocated_stainfo_buf)
+	if (rtw_get_stainfo_cache() == NULL)
 		return _FAIL;
 
-	pstapriv->pstainfo_buf = pstapriv->pallocated_stainfo_buf + 4 -
-		((SIZE_PTR)(pstapriv->pallocated_stainfo_buf ) & 3);
+	pstapriv->stainfo_tbl = (struct sta_info **)rtw_zmalloc(sizeof(struct sta_info *) * pstapriv->max_stainfo);
+	if (!pstapriv->stainfo_tbl)
+		goto fail;
+	pstapriv->stainfo_cnt = 0;
+
+#ifdef CONFIG_STA_LOOKUP_TABLE
+	pstapriv->sta_lookup_size = roundup_pow_of_two(pstapriv->max_stainfo * 2);
+	pstapriv->sta_lookup = (struct sta_info **)rtw_zmalloc(sizeof(struct sta_info *) * pstapriv->sta_lookup_size);
+	if (!pstapriv->sta_lookup)
+		goto fail;
+	pstapriv->sta_lookup_deleted = 0;
+	seqcount_init(&pstapriv->sta_lookup_seq);
+	pstapriv->last_sta = NULL;
+#endif
 
 	_rtw_init_queue(&pstapriv->free_sta_queue);
 
@@ -109,31 +268,42 @@ _func_enter_;
 	_rtw_init_queue(&pstapriv->sleep_q);
 	_rtw_init_queue(&pstapriv->wakeup_q);
 
-	psta = (struct sta_info *)(pstapriv->pstainfo_buf);
-
-
 	for(i = 0; i < NUM_STA; i++)
-	{
-		_rtw_init_stainfo(psta);
-
 		_rtw_init_listhead(&(pstapriv->sta_hash[i]));
 
-		rtw_list_insert_tail(&psta->list, get_list_head(&pstapriv->free_sta_queue));
+	// a few entries up front for self, bc/mc and the AP, the rest comes on demand
+	for(i = 0; i < STAINFO_POOL_RESERVE; i++)
+	{
+		psta = rtw_grow_stainfo(pstapriv);
+		if (psta == NULL)
+			goto fail;
 
-		psta++;
+		rtw_list_insert_tail(&psta->list, get_list_head(&pstapriv->free_sta_queue));
 	}
 
 
 
 #ifdef CONFIG_AP_MODE
 
-	pstapriv->sta_dz_bitmap = 0;
-	pstapriv->tim_bitmap = 0;
+	pstapriv->sta_aid = (struct sta_info **)rtw_zmalloc(sizeof(struct sta_info *) * pstapriv->max_stainfo);
+	pstapriv->aid_bitmap = (unsigned long *)rtw_zmalloc(BITS_TO_LONGS(pstapriv->max_stainfo) * sizeof(unsigned long));
+
+	// AID 0 is bc/mc, so max_stainfo+1 bits
+	pstapriv->tim_bitmap_len = pstapriv->max_stainfo / 8 + 1;
+	pstapriv->sta_dz_bitmap = rtw_zmalloc(pstapriv->tim_bitmap_len);
+	pstapriv->tim_bitmap = rtw_zmalloc(pstapriv->tim_bitmap_len);
+
+	if (!pstapriv->sta_aid || !pstapriv->aid_bitmap
+		|| !pstapriv->sta_dz_bitmap || !pstapriv->tim_bitmap)
+		goto fail;
 
 	_rtw_init_listhead(&pstapriv->asoc_list);
 	_rtw_init_listhead(&pstapriv->auth_list);
 	_rtw_spinlock_init(&pstapriv->asoc_list_lock);
 	_rtw_spinlock_init(&pstapriv->auth_list_lock);
+#ifdef CONFIG_TX_MCAST2UNI
+	_rtw_spinlock_init(&pstapriv->mc2u_lock);
+#endif
 	pstapriv->asoc_list_cnt = 0;
 	pstapriv->auth_list_cnt = 0;
 
@@ -146,7 +316,7 @@ _func_enter_;
 #else
 	pstapriv->expire_to = 60;// 60*2 = 120 sec = 2 min, expire after no any traffic.
 #endif
-	pstapriv->max_num_sta = NUM_STA;
+	pstapriv->max_num_sta = pstapriv->max_stainfo;
 
 #endif
 
@@ -154,13 +324,19 @@ _func_exit_;
 
 	return _SUCCESS;
 
+fail:
+	rtw_mfree_sta_priv_mem(pstapriv);
+
+_func_exit_;
+
+	return _FAIL;
 }
 
 inline int rtw_stainfo_offset(struct sta_priv *stapriv, struct sta_info *sta)
 {
-	int offset = (((u8 *)sta) - stapriv->pstainfo_buf)/sizeof(struct sta_info);
+	int offset = sta->stainfo_idx;
 
-	if (!stainfo_offset_valid(offset))
+	if (!stainfo_offset_valid(stapriv, offset) || stapriv->stainfo_tbl[offset] != sta)
 		DBG_871X("%s invalid offset(%d), out of range!!!", __func__, offset);
 
 	return offset;
@@ -168,10 +344,12 @@ inline int rtw_stainfo_offset(struct sta_priv *stapriv, struct sta_info *sta)
 
 inline struct sta_info *rtw_get_stainfo_by_offset(struct sta_priv *stapriv, int offset)
 {
-	if (!stainfo_offset_valid(offset))
+	if (!stainfo_offset_valid(stapriv, offset)) {
 		DBG_871X("%s invalid offset(%d), out of range!!!", __func__, offset);
+		return NULL;
+	}
 
-	return (struct sta_info *)(stapriv->pstainfo_buf + offset * sizeof(struct sta_info));
+	return stapriv->stainfo_tbl[offset];
 }
 
 void	_rtw_free_sta_xmit_priv_lock(struct sta_xmit_priv *psta_xmitpriv);
@@ -206,6 +384,7 @@ void rtw_mfree_stainfo(struct sta_info *psta)
 _func_enter_;
 
 	 _rtw_spinlock_free(&psta->lock);
+	_rtw_spinlock_free(&psta->tkip_p1k_lock);
 
 	_rtw_free_sta_xmit_priv_lock(&psta->sta_xmitpriv);
 	_rtw_free_sta_recv_priv_lock(&psta->sta_recvpriv);
@@ -261,6 +440,9 @@ void rtw_mfree_sta_priv_lock(struct	sta_priv *pstapriv)
 #ifdef CONFIG_AP_MODE
 	_rtw_spinlock_free(&pstapriv->asoc_list_lock);
 	_rtw_spinlock_free(&pstapriv->auth_list_lock);
+#ifdef CONFIG_TX_MCAST2UNI
+	_rtw_spinlock_free(&pstapriv->mc2u_lock);
+#endif
 	_rtw_spinlock_free(&pacl_list->acl_node_q.lock);
 #endif
 
@@ -302,9 +484,7 @@ _func_enter_;
 
 		rtw_mfree_sta_priv_lock(pstapriv);
 
-		if(pstapriv->pallocated_stainfo_buf) {
-			rtw_vmfree(pstapriv->pallocated_stainfo_buf, sizeof(struct sta_info)*NUM_STA+4);
-		}
+		rtw_mfree_sta_priv_mem(pstapriv);
 	}
 
 _func_exit_;
@@ -312,11 +492,117 @@ _func_exit_;
 }
 
 
+#ifdef CONFIG_STA_LOOKUP_TABLE
+// caller holds sta_hash_lock
+static void rtw_sta_lookup_insert(struct sta_priv *pstapriv, struct sta_info *psta)
+{
+	u64 key = wifi_mac_key(psta->hwaddr);
+	u32 i, index = wifi_mac_key_hash(key, pstapriv->sta_lookup_size);
+
+	for (i = 0; i < pstapriv->sta_lookup_size; i++) {
+		struct sta_info *pslot = pstapriv->sta_lookup[index];
+
+		if (pslot == NULL || pslot == STA_LOOKUP_DELETED) {
+			if (pslot == STA_LOOKUP_DELETED)
+				pstapriv->sta_lookup_deleted--;
+			psta->mac_key = key;
+			// publish only after the sta_info is fully set up
+			rcu_assign_pointer(pstapriv->sta_lookup[index], psta);
+			return;
+		}
+		index = (index + 1) & (pstapriv->sta_lookup_size - 1);
+	}
+
+	psta->mac_key = STA_MAC_KEY_INVALID;
+	DBG_871X("%s: no free slot for "MAC_FMT"\n", __FUNCTION__, MAC_ARG(psta->hwaddr));
+}
+
+// caller holds sta_hash_lock
+// Drops every tombstone and pulls each entry back to the first free slot of
+// its probe chain. Lockless readers that miss while this runs retry on
+// sta_lookup_seq.
+static void rtw_sta_lookup_rebuild(struct sta_priv *pstapriv)
+{
+	u32 size = pstapriv->sta_lookup_size, mask = size - 1;
+	u32 i, n, start = 0;
+
+	write_seqcount_begin(&pstapriv->sta_lookup_seq);
+
+	for (i = 0; i < size; i++) {
+		if (pstapriv->sta_lookup[i] == STA_LOOKUP_DELETED)
+			pstapriv->sta_lookup[i] = NULL;
+	}
+
+	// start right after an empty slot (there is always one, the table is twice
+	// max_stainfo), so no probe chain wraps around the walk
+	while (pstapriv->sta_lookup[start] != NULL)
+		start++;
+
+	for (n = 1; n <= size; n++) {
+		u32 s = (start + n) & mask;
+		struct sta_info *psta = pstapriv->sta_lookup[s];
+
+		if (psta == NULL)
+			continue;
+
+		i = wifi_mac_key_hash(psta->mac_key, size);
+		while (i != s && pstapriv->sta_lookup[i] != NULL)
+			i = (i + 1) & mask;
+
+		if (i != s) {
+			rcu_assign_pointer(pstapriv->sta_lookup[i], psta);
+			pstapriv->sta_lookup[s] = NULL;
+		}
+	}
+
+	pstapriv->sta_lookup_deleted = 0;
+
+	write_seqcount_end(&pstapriv->sta_lookup_seq);
+}
+
+// caller holds sta_hash_lock
+static void rtw_sta_lookup_remove(struct sta_priv *pstapriv, struct sta_info *psta)
+{
+	u32 i, index;
+
+	if (psta->mac_key == STA_MAC_KEY_INVALID)
+		return;
+
+	index = wifi_mac_key_hash(psta->mac_key, pstapriv->sta_lookup_size);
+
+	for (i = 0; i < pstapriv->sta_lookup_size; i++) {
+		struct sta_info *pslot = pstapriv->sta_lookup[index];
+
+		if (pslot == NULL)
+			break;
+		if (pslot == psta) {
+			// keep the probe chain intact for entries behind this one
+			rcu_assign_pointer(pstapriv->sta_lookup[index], STA_LOOKUP_DELETED);
+			pstapriv->sta_lookup_deleted++;
+			break;
+		}
+		index = (index + 1) & (pstapriv->sta_lookup_size - 1);
+	}
+
+	// a reader still holding psta sees a key no MAC address can match
+	psta->mac_key = STA_MAC_KEY_INVALID;
+
+	// pairs with the barrier in rtw_get_stainfo(): either we see the reader's
+	// last_sta store here, or the reader sees the invalid key and undoes it
+	smp_mb();
+	if (pstapriv->last_sta == psta)
+		rcu_assign_pointer(pstapriv->last_sta, NULL);
+
+	if (pstapriv->sta_lookup_deleted > STA_LOOKUP_MAX_DELETED(pstapriv->sta_lookup_size))
+		rtw_sta_lookup_rebuild(pstapriv);
+}
+#endif //CONFIG_STA_LOOKUP_TABLE
+
 //struct	sta_info *rtw_alloc_stainfo(_queue *pfree_sta_queue, unsigned char *hwaddr)
 struct	sta_info *rtw_alloc_stainfo(struct	sta_priv *pstapriv, u8 *hwaddr)
 {
 	_irqL irqL, irqL2;
-	uint tmp_aid;
+	u16 tmp_idx;
 	s32	index;
 	_list	*phash_list;
 	struct sta_info	*psta;
@@ -333,11 +619,7 @@ _func_enter_;
 	_enter_critical_bh(&(pstapriv->sta_hash_lock), &irqL2);
 
 	if (_rtw_queue_empty(pfree_sta_queue) == _TRUE)
-	{
-		//_exit_critical_bh(&(pfree_sta_queue->lock), &irqL);
-		_exit_critical_bh(&(pstapriv->sta_hash_lock), &irqL2);
-		psta = NULL;
-	}
+		psta = rtw_grow_stainfo(pstapriv);
 	else
 	{
 		psta = LIST_CONTAINOR(get_next(&pfree_sta_queue->queue), struct sta_info, list);
@@ -346,10 +628,17 @@ _func_enter_;
 
 		//_exit_critical_bh(&(pfree_sta_queue->lock), &irqL);
 
-		tmp_aid = psta->aid;
+		tmp_idx = psta->stainfo_idx;
 
 		_rtw_init_stainfo(psta);
 
+		psta->stainfo_idx = tmp_idx;
+	}
+
+	// out of rtw_max_sta or the slab is dry, unlock once at exit
+	if (psta != NULL)
+	{
+
 		memcpy(psta->hwaddr, hwaddr, ETH_ALEN);
 
 		index = wifi_mac_hash(hwaddr);
@@ -416,6 +705,8 @@ _func_enter_;
 			preorder_ctrl->wsize_b = 64;//64;
 
 			_rtw_init_queue(&preorder_ctrl->pending_recvframe_queue);
+			_rtw_memset(preorder_ctrl->reorder_ring, 0, sizeof(preorder_ctrl->reorder_ring));
+			preorder_ctrl->pending_cnt = 0;
 
 			rtw_init_recv_timer(preorder_ctrl);
 		}
@@ -427,6 +718,10 @@ _func_enter_;
 
 		/* init for the sequence number of received management frame */
 		psta->RxMgmtFrameSeqNum = 0xffff;
+
+#ifdef CONFIG_STA_LOOKUP_TABLE
+		rtw_sta_lookup_insert(pstapriv, psta);
+#endif
 	}
 
 exit:
@@ -525,6 +820,9 @@ _func_enter_;
 	rtw_list_delete(&psta->hash_list);
 	RT_TRACE(_module_rtl871x_sta_mgt_c_,_drv_err_,("\n free number_%d stainfo  with hwaddr = 0x%.2x 0x%.2x 0x%.2x 0x%.2x 0x%.2x 0x%.2x  \n",pstapriv->asoc_sta_count , psta->hwaddr[0], psta->hwaddr[1], psta->hwaddr[2],psta->hwaddr[3],psta->hwaddr[4],psta->hwaddr[5]));
 	pstapriv->asoc_sta_count --;
+#ifdef CONFIG_STA_LOOKUP_TABLE
+	rtw_sta_lookup_remove(pstapriv, psta);
+#endif
 
 
 	// re-init sta_info; 20061114 // will be init in alloc_stainfo
@@ -546,7 +844,7 @@ _func_enter_;
 	for(i=0; i < 16 ; i++)
 	{
 		_irqL irqL;
-		_list	*phead, *plist;
+		int j;
 		union recv_frame *prframe;
 		_queue *ppending_recvframe_queue;
 		_queue *pfree_recv_queue = &padapter->recvpriv.free_recv_queue;
@@ -560,16 +858,14 @@ _func_enter_;
 
 		_enter_critical_bh(&ppending_recvframe_queue->lock, &irqL);
 
-		phead =		get_list_head(ppending_recvframe_queue);
-		plist = get_next(phead);
-
-		while(!rtw_is_list_empty(phead))
+		for(j = 0; j < REORDER_RING_SIZE && preorder_ctrl->pending_cnt; j++)
 		{
-			prframe = LIST_CONTAINOR(plist, union recv_frame, u);
-
-			plist = get_next(plist);
+			prframe = preorder_ctrl->reorder_ring[j];
+			if(prframe == NULL)
+				continue;
 
-			rtw_list_delete(&(prframe->u.hdr.list));
+			preorder_ctrl->reorder_ring[j] = NULL;
+			preorder_ctrl->pending_cnt--;
 
 			rtw_free_recvframe(prframe, pfree_recv_queue);
 		}
@@ -608,14 +904,18 @@ _func_enter_;
 
 #ifdef CONFIG_NATIVEAP_MLME
 
-	pstapriv->sta_dz_bitmap &=~BIT(psta->aid);
-	pstapriv->tim_bitmap &=~BIT(psta->aid);
+	if (psta->aid <= pstapriv->max_stainfo)
+	{
+		rtw_tim_map_clear(pstapriv->sta_dz_bitmap, psta->aid);
+		rtw_tim_map_clear(pstapriv->tim_bitmap, psta->aid);
+	}
 
 	//rtw_indicate_sta_disassoc_event(padapter, psta);
 
-	if ((psta->aid >0)&&(pstapriv->sta_aid[psta->aid - 1] == psta))
+	if ((psta->aid >0)&&(psta->aid <= pstapriv->max_stainfo)&&(pstapriv->sta_aid[psta->aid - 1] == psta))
 	{
 		pstapriv->sta_aid[psta->aid - 1] = NULL;
+		clear_bit(psta->aid - 1, pstapriv->aid_bitmap);
 		psta->aid = 0;
 	}
 
@@ -623,13 +923,16 @@ _func_enter_;
 
 #ifdef CONFIG_TX_MCAST2UNI
 	psta->under_exist_checking = 0;
+	rtw_mc2u_sta_leave(padapter, psta->hwaddr);
 #endif	// CONFIG_TX_MCAST2UNI
 
 #endif	// CONFIG_AP_MODE
 
 	 _rtw_spinlock_free(&psta->lock);
+	_rtw_spinlock_free(&psta->tkip_p1k_lock);
 
 	//_enter_critical_bh(&(pfree_sta_queue->lock), &irqL0);
+	psta->free_time = rtw_get_current_time();
 	rtw_list_insert_tail(&psta->list, get_list_head(pfree_sta_queue));
 	//_exit_critical_bh(&(pfree_sta_queue->lock), &irqL0);
 
@@ -641,6 +944,24 @@ _func_exit_;
 
 }
 
+#ifdef CONFIG_AP_MODE
+// give psta the lowest free AID up to max_num_sta, returns 0 when they are all taken
+uint rtw_alloc_aid(struct sta_priv *pstapriv, struct sta_info *psta)
+{
+	uint aid;
+
+	aid = find_first_zero_bit(pstapriv->aid_bitmap, pstapriv->max_num_sta);
+	if (aid >= pstapriv->max_num_sta)
+		return 0;
+
+	set_bit(aid, pstapriv->aid_bitmap);
+	pstapriv->sta_aid[aid] = psta;
+	psta->aid = aid + 1;
+
+	return psta->aid;
+}
+#endif
+
 // free all stainfo which in sta_hash[all]
 void rtw_free_all_stainfo(_adapter *padapter)
 {
@@ -683,7 +1004,14 @@ _func_exit_;
 
 }
 
-/* any station allocated can be searched by hash list */
+/*
+ * any station allocated can be searched by hash list
+ *
+ * With CONFIG_STA_LOOKUP_TABLE the returned psta outlives rcu_read_unlock and
+ * no reference is taken. Only STAINFO_IDLE_TIMEOUT keeps it valid: a sta_info
+ * freed meanwhile stays on free_sta_queue that long before rtw_shrink_stainfo
+ * hands it to call_rcu. Callers must not hold psta across a sleep of that order.
+ */
 struct sta_info *rtw_get_stainfo(struct sta_priv *pstapriv, u8 *hwaddr)
 {
 
@@ -713,6 +1041,52 @@ _func_enter_;
 		addr = hwaddr;
 	}
 
+#ifdef CONFIG_STA_LOOKUP_TABLE
+	{
+		u64 key = wifi_mac_key(addr);
+		struct sta_info *pslot;
+		unsigned seq;
+		u32 i;
+
+		rcu_read_lock();
+
+		// most of the time it is the same peer as last time
+		psta = rcu_dereference(pstapriv->last_sta);
+		if (psta == NULL || psta->mac_key != key)
+		{
+			// a miss can be a probe racing rtw_sta_lookup_rebuild, look again
+			do {
+				psta = NULL;
+				seq = read_seqcount_begin(&pstapriv->sta_lookup_seq);
+				index = wifi_mac_key_hash(key, pstapriv->sta_lookup_size);
+
+				for (i = 0; i < pstapriv->sta_lookup_size; i++)
+				{
+					pslot = rcu_dereference(pstapriv->sta_lookup[index]);
+					if (pslot == NULL)
+						break;
+
+					if (pslot != STA_LOOKUP_DELETED && pslot->mac_key == key)
+					{ // if found the matched address
+						psta = pslot;
+						rcu_assign_pointer(pstapriv->last_sta, psta);
+						smp_mb();
+						if (psta->mac_key != key) {
+							// removed under us, don't leave it cached
+							cmpxchg(&pstapriv->last_sta, psta, NULL);
+							psta = NULL;
+						}
+						break;
+					}
+					index = (index + 1) & (pstapriv->sta_lookup_size - 1);
+				}
+			} while (psta == NULL && read_seqcount_retry(&pstapriv->sta_lookup_seq, seq));
+		}
+
+		// psta is used past this point, see the STAINFO_IDLE_TIMEOUT note above
+		rcu_read_unlock();
+	}
+#else
 	index = wifi_mac_hash(addr);
 
 	_enter_critical_bh(&pstapriv->sta_hash_lock, &irqL);
@@ -735,6 +1109,7 @@ _func_enter_;
 	}
 
 	_exit_critical_bh(&pstapriv->sta_hash_lock, &irqL);
+#endif //CONFIG_STA_LOOKUP_TABLE
 _func_exit_;
 	return psta;
 
@@ -40,6 +40,9 @@ _func_enter_;
 	_rtw_init_listhead(&ptxservq->tx_pending);
 	_rtw_init_queue(&ptxservq->sta_pending);
 	ptxservq->qcnt = 0;
+#ifdef CONFIG_RTW_TX_AQM
+	_rtw_memset(&ptxservq->aqm, 0, sizeof(struct tx_aqm_vars));
+#endif
 _func_exit_;
 }
 
@@ -90,6 +93,17 @@ _func_enter_;
 
 	pxmitpriv->adapter = padapter;
 
+#ifdef CONFIG_TX_TMPL_CACHE
+	// station templates start out at gen 0, never valid
+	pxmitpriv->tx_tmpl_gen = 1;
+#endif
+
+#ifdef CONFIG_RTW_TX_AQM
+	_rtw_spinlock_init(&pxmitpriv->bql_lock);
+	pxmitpriv->tx_aqm_target_us = TX_AQM_TARGET_US;
+	pxmitpriv->tx_aqm_interval_us = TX_AQM_INTERVAL_US;
+#endif
+
 	//for(i = 0 ; i < MAX_NUMBLKS; i++)
 	//	_rtw_init_queue(&pxmitpriv->blk_strms[i]);
 
@@ -293,6 +307,9 @@ void  rtw_mfree_xmit_priv_lock (struct xmit_priv *pxmitpriv);
 void  rtw_mfree_xmit_priv_lock (struct xmit_priv *pxmitpriv)
 {
 	_rtw_spinlock_free(&pxmitpriv->lock);
+#ifdef CONFIG_RTW_TX_AQM
+	_rtw_spinlock_free(&pxmitpriv->bql_lock);
+#endif
 	_rtw_free_sema(&pxmitpriv->xmit_sema);
 	_rtw_free_sema(&pxmitpriv->terminate_xmitthread_sema);
 
@@ -320,6 +337,10 @@ void _rtw_free_xmit_priv (struct xmit_priv *pxmitpriv)
 
  _func_enter_;
 
+#ifdef CONFIG_XMIT_STAGING_RING
+	rtw_xmit_staging_purge(padapter);
+#endif
+
 	rtw_hal_free_xmit_priv(padapter);
 
 	rtw_mfree_xmit_priv_lock(pxmitpriv);
@@ -618,7 +639,104 @@ static void set_qos(struct pkt_file *ppktfile, struct pkt_attrib *pattrib)
 	pattrib->subtype = WIFI_QOS_DATA_TYPE;
 }
 
-static s32 update_attrib(_adapter *padapter, _pkt *pkt, struct pkt_attrib *pattrib)
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+// budget_us applies to BE/BK, VI gets 1/4 and VO 1/8 of it
+void rtw_tx_agg_set_budget(_adapter *padapter, u32 budget_us)
+{
+	struct xmit_priv *pxmitpriv = &padapter->xmitpriv;
+
+	if (budget_us == 0)
+		budget_us = TX_AGG_BUDGET_DEF;
+
+	pxmitpriv->tx_agg_ctrl[VO_QUEUE_INX].budget_us = budget_us >> 3;
+	pxmitpriv->tx_agg_ctrl[VI_QUEUE_INX].budget_us = budget_us >> 2;
+	pxmitpriv->tx_agg_ctrl[BE_QUEUE_INX].budget_us = budget_us;
+	pxmitpriv->tx_agg_ctrl[BK_QUEUE_INX].budget_us = budget_us;
+}
+#endif //CONFIG_USB_TX_AGG_ADAPTIVE
+
+#ifdef CONFIG_TX_TMPL_CACHE
+/*
+ * Drop every station's TX templates. Called wherever something they are
+ * built from changes: keys, rate masks and association/HT state.
+ */
+void rtw_tx_tmpl_invalidate(_adapter *padapter)
+{
+	struct xmit_priv *pxmitpriv = &padapter->xmitpriv;
+
+	if (++pxmitpriv->tx_tmpl_gen == 0)
+		pxmitpriv->tx_tmpl_gen = 1;
+}
+
+// bswenc also depends on sw_encrypt/hw_decrypted, which change without a gen bump
+static __inline int tx_tmpl_valid(_adapter *padapter, struct tx_tmpl *ptmpl)
+{
+	return ptmpl->gen == padapter->xmitpriv.tx_tmpl_gen
+		&& ptmpl->sw_encrypt == padapter->securitypriv.sw_encrypt
+		&& ptmpl->hw_decrypted == padapter->securitypriv.hw_decrypted;
+}
+
+struct tx_tmpl *rtw_tx_tmpl_get(_adapter *padapter, struct pkt_attrib *pattrib)
+{
+	struct tx_tmpl *ptmpl;
+
+	if (pattrib->psta == NULL)
+		return NULL;
+
+	ptmpl = &pattrib->psta->sta_xmitpriv.tx_tmpl[pattrib->priority & 0x07];
+	if (!tx_tmpl_valid(padapter, ptmpl))
+		return NULL;
+
+	return ptmpl;
+}
+
+static void tx_tmpl_load_attrib(struct tx_tmpl *ptmpl, struct pkt_attrib *pattrib)
+{
+	pattrib->encrypt = ptmpl->encrypt;
+	pattrib->iv_len = ptmpl->iv_len;
+	pattrib->icv_len = ptmpl->icv_len;
+	pattrib->key_idx = ptmpl->key_idx;
+	pattrib->bswenc = ptmpl->bswenc;
+
+	// same as update_attrib_phy_info()
+	pattrib->mdata = 0;
+	pattrib->eosp = 0;
+	pattrib->triggered = 0;
+	pattrib->qos_en = ptmpl->qos_en;
+	pattrib->ht_en = ptmpl->ht_en;
+	pattrib->raid = ptmpl->raid;
+	pattrib->bwmode = ptmpl->bwmode;
+	pattrib->ch_offset = ptmpl->ch_offset;
+	pattrib->sgi = ptmpl->sgi;
+	pattrib->ampdu_en = _FALSE;
+	pattrib->retry_ctrl = _FALSE;
+}
+
+static void tx_tmpl_save_attrib(_adapter *padapter, struct tx_tmpl *ptmpl, struct pkt_attrib *pattrib)
+{
+	ptmpl->encrypt = pattrib->encrypt;
+	ptmpl->iv_len = pattrib->iv_len;
+	ptmpl->icv_len = pattrib->icv_len;
+	ptmpl->key_idx = pattrib->key_idx;
+	ptmpl->bswenc = pattrib->bswenc;
+	ptmpl->sw_encrypt = padapter->securitypriv.sw_encrypt;
+	ptmpl->hw_decrypted = padapter->securitypriv.hw_decrypted;
+	ptmpl->qos_en = pattrib->qos_en;
+	ptmpl->ht_en = pattrib->ht_en;
+	ptmpl->raid = pattrib->raid;
+	ptmpl->bwmode = pattrib->bwmode;
+	ptmpl->ch_offset = pattrib->ch_offset;
+	ptmpl->sgi = pattrib->sgi;
+
+	// header and descriptor are captured on their first use under this gen
+	ptmpl->hdr_valid = _FALSE;
+	ptmpl->txdesc_valid = _FALSE;
+	ptmpl->gen = padapter->xmitpriv.tx_tmpl_gen;
+}
+#endif //CONFIG_TX_TMPL_CACHE
+
+// da, when given, replaces the destination of the ethernet header
+static s32 update_attrib(_adapter *padapter, _pkt *pkt, struct pkt_attrib *pattrib, u8 *da)
 {
 	uint i;
 	struct pkt_file pktfile;
@@ -630,6 +748,9 @@ static s32 update_attrib(_adapter *padapter, _pkt *pkt, struct pkt_attrib *pattr
 	struct security_priv	*psecuritypriv = &padapter->securitypriv;
 	struct mlme_priv	*pmlmepriv = &padapter->mlmepriv;
 	struct qos_priv		*pqospriv= &pmlmepriv->qospriv;
+#ifdef CONFIG_TX_TMPL_CACHE
+	struct tx_tmpl *ptmpl;
+#endif
 	sint res = _SUCCESS;
 
  _func_enter_;
@@ -640,7 +761,7 @@ static s32 update_attrib(_adapter *padapter, _pkt *pkt, struct pkt_attrib *pattr
 	pattrib->ether_type = ntohs(etherhdr.h_proto);
 
 
-	memcpy(pattrib->dst, &etherhdr.h_dest, ETH_ALEN);
+	memcpy(pattrib->dst, da ? da : etherhdr.h_dest, ETH_ALEN);
 	memcpy(pattrib->src, &etherhdr.h_source, ETH_ALEN);
 
 	pattrib->pctrl = 0;
@@ -769,6 +890,28 @@ static s32 update_attrib(_adapter *padapter, _pkt *pkt, struct pkt_attrib *pattr
 
 	//pattrib->priority = 5; //force to used VI queue, for testing
 
+#ifdef CONFIG_TX_TMPL_CACHE
+	ptmpl = &psta->sta_xmitpriv.tx_tmpl[pattrib->priority & 0x07];
+	if (psta->ieee8021x_blocked == _FALSE && tx_tmpl_valid(padapter, ptmpl))
+	{
+		padapter->xmitpriv.tx_tmpl_hit++;
+		tx_tmpl_load_attrib(ptmpl, pattrib);
+
+		if (pattrib->encrypt == _TKIP_ && padapter->securitypriv.busetkipkey == _FAIL)
+		{
+			#ifdef DBG_TX_DROP_FRAME
+			DBG_871X("DBG_TX_DROP_FRAME %s padapter->securitypriv.busetkipkey(%d)==_FAIL drop packet\n", __FUNCTION__, padapter->securitypriv.busetkipkey);
+			#endif
+			res = _FAIL;
+			goto exit;
+		}
+
+		rtw_set_tx_chksum_offload(pkt, pattrib);
+		goto exit;
+	}
+	padapter->xmitpriv.tx_tmpl_miss++;
+#endif
+
 	if (psta->ieee8021x_blocked == _TRUE)
 	{
 		RT_TRACE(_module_rtl871x_xmit_c_,_drv_err_,("\n psta->ieee8021x_blocked == _TRUE \n"));
@@ -850,7 +993,8 @@ static s32 update_attrib(_adapter *padapter, _pkt *pkt, struct pkt_attrib *pattr
 		  pattrib->encrypt, padapter->securitypriv.sw_encrypt));
 
 	if (pattrib->encrypt &&
-	    ((padapter->securitypriv.sw_encrypt == _TRUE) || (psecuritypriv->hw_decrypted == _FALSE)))
+	    ((padapter->securitypriv.sw_encrypt == _TRUE) || (psecuritypriv->hw_decrypted == _FALSE)
+	     || (!bmcast && psta && psta->no_hw_key)))
 	{
 		pattrib->bswenc = _TRUE;
 		RT_TRACE(_module_rtl871x_xmit_c_,_drv_err_,
@@ -872,6 +1016,11 @@ static s32 update_attrib(_adapter *padapter, _pkt *pkt, struct pkt_attrib *pattr
 
 	update_attrib_phy_info(pattrib, psta);
 
+#ifdef CONFIG_TX_TMPL_CACHE
+	if (psta->ieee8021x_blocked == _FALSE)
+		tx_tmpl_save_attrib(padapter, ptmpl, pattrib);
+#endif
+
 exit:
 
 _func_exit_;
@@ -1070,6 +1219,9 @@ s32 rtw_make_wlanhdr (_adapter *padapter , u8 *hdr, struct pkt_attrib *pattrib)
 	struct sta_info *ptdls_sta=NULL, *psta_backup=NULL;
 	u8 direct_link=0;
 #endif //CONFIG_TDLS
+#ifdef CONFIG_TX_TMPL_CACHE
+	struct tx_tmpl *ptmpl = NULL;
+#endif
 
 	sint res = _SUCCESS;
 	u16 *fctrl = &pwlanhdr->frame_ctl;
@@ -1105,6 +1257,42 @@ _func_enter_;
 
 	_rtw_memset(hdr, 0, WLANHDR_OFFSET);
 
+#ifdef CONFIG_TX_TMPL_CACHE
+	if (pattrib->subtype & WIFI_DATA_TYPE)
+		ptmpl = rtw_tx_tmpl_get(padapter, pattrib);
+
+	if (ptmpl && ptmpl->hdr_valid && ptmpl->hdrlen == pattrib->hdrlen)
+	{
+		memcpy(hdr, ptmpl->hdr, ptmpl->hdrlen);
+
+		switch (ptmpl->addr_sel)
+		{
+			case TX_TMPL_ADDR_STA:
+				memcpy(pwlanhdr->addr3, pattrib->dst, ETH_ALEN);
+				break;
+			case TX_TMPL_ADDR_AP:
+				memcpy(pwlanhdr->addr1, pattrib->dst, ETH_ALEN);
+				memcpy(pwlanhdr->addr3, pattrib->src, ETH_ALEN);
+				break;
+			default:
+				memcpy(pwlanhdr->addr1, pattrib->dst, ETH_ALEN);
+				break;
+		}
+
+		if (pattrib->mdata)
+			SetMData(fctrl);
+
+		// only set_qos() makes a QoS sized header
+		if (ptmpl->hdrlen == WLAN_HDR_A3_QOS_LEN)
+		{
+			qc = (unsigned short *)(hdr + pattrib->hdrlen - 2);
+			SetEOSP(qc, pattrib->eosp);
+		}
+
+		goto tx_tmpl_hdr_done;
+	}
+#endif
+
 	SetFrameSubType(fctrl, pattrib->subtype);
 
 	if (pattrib->subtype & WIFI_DATA_TYPE)
@@ -1185,6 +1373,27 @@ _func_enter_;
 			SetAckpolicy(qc, pattrib->ack_policy);
 		}
 
+#ifdef CONFIG_TX_TMPL_CACHE
+		if (ptmpl)
+		{
+			memcpy(ptmpl->hdr, hdr, pattrib->hdrlen);
+			ClearMData(ptmpl->hdr);
+			if (qos_option)
+				*(unsigned short *)(ptmpl->hdr + pattrib->hdrlen - 2) &= ~cpu_to_le16(BIT(4));	// EOSP
+
+			if (check_fwstate(pmlmepriv, WIFI_STATION_STATE) == _TRUE)
+				ptmpl->addr_sel = TX_TMPL_ADDR_STA;
+			else if (check_fwstate(pmlmepriv, WIFI_AP_STATE) == _TRUE)
+				ptmpl->addr_sel = TX_TMPL_ADDR_AP;
+			else
+				ptmpl->addr_sel = TX_TMPL_ADDR_ADHOC;
+
+			ptmpl->hdrlen = pattrib->hdrlen;
+			ptmpl->hdr_valid = _TRUE;
+		}
+tx_tmpl_hdr_done:
+#endif
+
 		//TODO: fill HT Control Field
 
 		//Update Seq Num will be handled by f/w
@@ -1280,10 +1489,171 @@ _func_exit_;
 	return res;
 }
 
+#ifdef CONFIG_XMIT_STAGING_RING
+/*
+ * Producer side, called from ndo_start_xmit only.
+ * The netdev core serializes callers per subqueue, so each ring has exactly one producer.
+ */
+s32 rtw_xmit_staging_push(_adapter *padapter, u8 qidx, struct xmit_frame *pxmitframe)
+{
+	struct xmit_staging_ring *ring = &padapter->xmitpriv.staging_ring[qidx];
+	u32 head = ring->head;
+
+	if (CIRC_SPACE(head, ring->tail, XMIT_STAGING_RING_SZ) == 0)
+		return _FAIL;
+
+	ring->frame[head] = pxmitframe;
+	smp_wmb(); // publish the frame before the new head
+	ring->head = (head + 1) & (XMIT_STAGING_RING_SZ - 1);
+
+	return _SUCCESS;
+}
+
+u32 rtw_xmit_staging_cnt(struct xmit_priv *pxmitpriv, u8 qidx)
+{
+	struct xmit_staging_ring *ring = &pxmitpriv->staging_ring[qidx];
+
+	return CIRC_CNT(ring->head, ring->tail, XMIT_STAGING_RING_SZ);
+}
+
+/*
+ * Consumer side, called from the xmit tasklet only.
+ * Moves every staged frame to its tx_servq with a single xmitpriv->lock section,
+ * doing the sleeping-STA check that rtw_xmit used to do per frame.
+ */
+void rtw_xmit_staging_drain(_adapter *padapter)
+{
+	_irqL irqL;
+	struct xmit_priv *pxmitpriv = &padapter->xmitpriv;
+	struct xmit_staging_ring *ring;
+	struct xmit_frame *pxmitframe;
+	_list drop_list;
+	_list *plist;
+	u32 head, tail;
+	u8 qidx, staged = _FALSE;
+
+	for (qidx = 0; qidx < HWXMIT_ENTRY; qidx++) {
+		if (rtw_xmit_staging_cnt(pxmitpriv, qidx)) {
+			staged = _TRUE;
+			break;
+		}
+	}
+
+	if (staged == _FALSE)
+		return;
+
+	_rtw_init_listhead(&drop_list);
+
+	_enter_critical_bh(&pxmitpriv->lock, &irqL);
+
+	for (qidx = 0; qidx < HWXMIT_ENTRY; qidx++) {
+		ring = &pxmitpriv->staging_ring[qidx];
+		head = ring->head;
+		smp_rmb(); // read the head before the frames it covers
+		tail = ring->tail;
+
+		while (tail != head) {
+			pxmitframe = ring->frame[tail];
+			tail = (tail + 1) & (XMIT_STAGING_RING_SZ - 1);
+
+#if defined(CONFIG_AP_MODE) || defined(CONFIG_TDLS)
+			if (xmitframe_enqueue_for_sleeping_sta(padapter, pxmitframe) == _TRUE) {
+#ifdef CONFIG_RTW_TX_AQM
+				rtw_os_bql_complete(padapter, pxmitframe);
+#endif
+				continue;
+			}
+#endif
+			if (rtw_xmit_classifier(padapter, pxmitframe) != _SUCCESS)
+				rtw_list_insert_tail(&pxmitframe->list, &drop_list);
+		}
+
+		smp_mb(); // finish with the slots before handing them back
+		ring->tail = tail;
+	}
+
+	_exit_critical_bh(&pxmitpriv->lock, &irqL);
+
+	while (rtw_is_list_empty(&drop_list) == _FALSE) {
+		plist = get_next(&drop_list);
+		pxmitframe = LIST_CONTAINOR(plist, struct xmit_frame, list);
+		rtw_list_delete(plist);
+
+		RT_TRACE(_module_rtl871x_xmit_c_, _drv_err_, ("rtw_xmit_staging_drain: drop xmit pkt for classifier fail\n"));
+		rtw_free_xmitframe(pxmitpriv, pxmitframe);
+
+		// Trick, make the statistics correct
+		pxmitpriv->tx_pkts--;
+		pxmitpriv->tx_drop++;
+	}
+}
+
+/*
+ * Drop whatever is still staged, for the stop and free paths once
+ * ndo_start_xmit can no longer run. Serialized with the tasklet by
+ * xmitpriv->lock; the frames are freed, and their skbs completed, after it.
+ */
+void rtw_xmit_staging_purge(_adapter *padapter)
+{
+	_irqL irqL;
+	struct xmit_priv *pxmitpriv = &padapter->xmitpriv;
+	struct xmit_staging_ring *ring;
+	struct xmit_frame *pxmitframe;
+	_list drop_list;
+	_list *plist;
+	u32 head, tail;
+	u8 qidx;
+
+	_rtw_init_listhead(&drop_list);
+
+	_enter_critical_bh(&pxmitpriv->lock, &irqL);
+
+	for (qidx = 0; qidx < HWXMIT_ENTRY; qidx++) {
+		ring = &pxmitpriv->staging_ring[qidx];
+		head = ring->head;
+		smp_rmb(); // read the head before the frames it covers
+		tail = ring->tail;
+
+		while (tail != head) {
+			pxmitframe = ring->frame[tail];
+			ring->frame[tail] = NULL;
+			tail = (tail + 1) & (XMIT_STAGING_RING_SZ - 1);
+			rtw_list_insert_tail(&pxmitframe->list, &drop_list);
+		}
+
+		smp_mb(); // finish with the slots before handing them back
+		ring->tail = tail;
+	}
+
+	_exit_critical_bh(&pxmitpriv->lock, &irqL);
+
+	while (rtw_is_list_empty(&drop_list) == _FALSE) {
+		plist = get_next(&drop_list);
+		pxmitframe = LIST_CONTAINOR(plist, struct xmit_frame, list);
+		rtw_list_delete(plist);
+
+		// also completes the skb and its BQL charge
+		rtw_free_xmitframe(pxmitpriv, pxmitframe);
+
+		pxmitpriv->tx_pkts--;
+		pxmitpriv->tx_drop++;
+	}
+}
+#endif //CONFIG_XMIT_STAGING_RING
+
 s32 rtw_txframes_pending(_adapter *padapter)
 {
 	struct xmit_priv *pxmitpriv = &padapter->xmitpriv;
 
+#ifdef CONFIG_XMIT_STAGING_RING
+	u8 qidx;
+
+	for (qidx = 0; qidx < HWXMIT_ENTRY; qidx++) {
+		if (rtw_xmit_staging_cnt(pxmitpriv, qidx))
+			return _TRUE;
+	}
+#endif
+
 	return ((_rtw_queue_empty(&pxmitpriv->be_pending) == _FALSE) ||
 			 (_rtw_queue_empty(&pxmitpriv->bk_pending) == _FALSE) ||
 			 (_rtw_queue_empty(&pxmitpriv->vi_pending) == _FALSE) ||
@@ -1656,6 +2026,10 @@ s32 rtw_xmitframe_coalesce(_adapter *padapter, _pkt *pkt, struct xmit_frame *pxm
 
 	s32 bmcst = IS_MCAST(pattrib->ra);
 	s32 res = _SUCCESS;
+#ifdef CONFIG_USB_TX_SG
+	u8 sg = _FALSE;
+	u8 *sg_payload = NULL;
+#endif
 
 _func_enter_;
 
@@ -1704,6 +2078,11 @@ _func_enter_;
 	_rtw_open_pktfile(pkt, &pktfile);
 	_rtw_pktfile_read(&pktfile, NULL, pattrib->pkt_hdrlen);
 
+#ifdef CONFIG_USB_TX_SG
+	if (pkt == pxmitframe->pkt)
+		sg = rtw_os_xmitframe_sg_check(padapter, pxmitframe);
+#endif
+
 	frg_inx = 0;
 	frg_len = pxmitpriv->frag_len - 4;//2346-4 = 2342
 
@@ -1773,6 +2152,13 @@ _func_enter_;
 		}
 
 
+#ifdef CONFIG_USB_TX_SG
+		if (sg) {
+			// payload stays in the skb, this part of the xmitbuf is skipped on the bus
+			sg_payload = pframe;
+			mem_sz = pattrib->pktlen;
+		} else
+#endif
 		if (bmcst) {
 			// don't do fragment to broadcat/multicast packets
 			mem_sz = _rtw_pktfile_read(&pktfile, pframe, pattrib->pktlen);
@@ -1789,7 +2175,11 @@ _func_enter_;
 
 		frg_inx++;
 
-		if (bmcst || (rtw_endofpktfile(&pktfile) == _TRUE))
+		if (bmcst || (rtw_endofpktfile(&pktfile) == _TRUE)
+#ifdef CONFIG_USB_TX_SG
+			|| sg
+#endif
+			)
 		{
 			pattrib->nr_frags = frg_inx;
 
@@ -1823,6 +2213,11 @@ _func_enter_;
 	else
 		pattrib->vcs_mode = NONE_VCS;
 
+#ifdef CONFIG_USB_TX_SG
+	if (sg)
+		rtw_os_xmitframe_sg_add(padapter, pxmitframe, sg_payload);
+#endif
+
 exit:
 
 _func_exit_;
@@ -2152,6 +2547,83 @@ _func_exit_;
 
 }
 
+#ifdef CONFIG_TX_AIRTIME_DRR
+// kbps at 20MHz long GI, indexed like the RA bitmap: CCK, OFDM, MCS0-15
+static const u32 tx_airtime_rate_tbl[28] = {
+	1000, 2000, 5500, 11000,
+	6000, 9000, 12000, 18000, 24000, 36000, 48000, 54000,
+	6500, 13000, 19500, 26000, 39000, 52000, 58500, 65000,
+	13000, 26000, 39000, 52000, 78000, 104000, 117000, 130000,
+};
+
+/*
+ * The firmware rate adaptation does not report the rate in use. Take the
+ * highest rate of the station's RA mask and derate it with the RSSI, the same
+ * signal the DM narrows the RA mask with.
+ */
+static u32 tx_airtime_rate_kbps(struct sta_info *psta)
+{
+	s32 pwdb = psta->rssi_stat.UndecoratedSmoothedPWDB;
+	u8 idx;
+	u32 kbps;
+
+	// init_rate carries the SGI flag in BIT(6), and is never set for
+	// stations past the MACID entries; prefer the RA bitmap when known
+	if (psta->ra_mask)
+		idx = get_highest_rate_idx(psta->ra_mask) & 0x3f;
+	else
+		idx = psta->init_rate & 0x3f;
+	if (idx >= 28)
+		idx = 27;
+	kbps = tx_airtime_rate_tbl[idx];
+
+#ifdef CONFIG_80211N_HT
+	if (idx >= 12 && psta->htpriv.ht_option) {
+		if (psta->htpriv.bwmode == HT_CHANNEL_WIDTH_40)
+			kbps = kbps * 27 / 13;
+		if (psta->htpriv.sgi)
+			kbps = kbps * 10 / 9;
+	}
+#endif
+
+	if (pwdb > 0) {
+		if (pwdb < 20)
+			kbps >>= 2;
+		else if (pwdb < 30)
+			kbps >>= 1;
+		else if (pwdb < 40)
+			kbps -= kbps >> 2;
+	}
+
+	if (kbps < 1000)
+		kbps = 1000;
+
+	return kbps;
+}
+
+// take the airtime of a bulk just written out of the station's AC credit
+static void tx_airtime_charge(_adapter *padapter, struct xmit_frame *pxmitframe, int sz)
+{
+	struct xmit_priv *pxmitpriv = &padapter->xmitpriv;
+	struct sta_info *psta = pxmitframe->attrib.psta;
+	struct tx_servq *ptxservq;
+	_irqL irqL;
+	u32 kbps, airtime;
+	u8 ac_index;
+
+	kbps = tx_airtime_rate_kbps(psta);
+	airtime = TX_AIRTIME_OVERHEAD_US + (u32)sz * 8000 / kbps;
+
+	_enter_critical_bh(&pxmitpriv->lock, &irqL);
+	ptxservq = rtw_get_sta_pending(padapter, psta, pxmitframe->attrib.priority, &ac_index);
+	ptxservq->deficit_us -= airtime;
+	_exit_critical_bh(&pxmitpriv->lock, &irqL);
+
+	psta->sta_xmitpriv.airtime_kbps = kbps;
+	psta->sta_xmitpriv.airtime_us += airtime;
+}
+#endif //CONFIG_TX_AIRTIME_DRR
+
 void rtw_count_tx_stats(_adapter *padapter, struct xmit_frame *pxmitframe, int sz)
 {
 	struct sta_info *psta = NULL;
@@ -2179,6 +2651,11 @@ void rtw_count_tx_stats(_adapter *padapter, struct xmit_frame *pxmitframe, int s
 			pstats->tx_pkts++;
 #endif
 			pstats->tx_bytes += sz;
+
+#ifdef CONFIG_TX_AIRTIME_DRR
+			if (check_fwstate(pmlmepriv, WIFI_AP_STATE) == _TRUE)
+				tx_airtime_charge(padapter, pxmitframe, sz);
+#endif
 		}
 	}
 
@@ -2335,6 +2812,11 @@ _func_enter_;
 		rtw_sctx_done_err(&pxmitbuf->sctx, RTW_SCTX_DONE_BUF_FREE);
 	}
 
+#ifdef CONFIG_USB_TX_SG
+	if (pxmitbuf->sg_pkt_cnt)
+		rtw_os_xmitbuf_sg_release(pxmitbuf->padapter, pxmitbuf);
+#endif
+
 	if(pxmitbuf->ext_tag)
 	{
 		rtw_free_xmitbuf_ext(pxmitpriv, pxmitbuf);
@@ -2387,6 +2869,10 @@ static void rtw_init_xmitframe(struct xmit_frame *pxframe)
 		pxframe->ack_report = 0;
 #endif
 
+#ifdef CONFIG_RTW_TX_AQM
+		pxframe->bql_len = 0;
+#endif
+
 	}
 }
 
@@ -2531,6 +3017,10 @@ _func_enter_;
 		goto exit;
 	}
 
+#ifdef CONFIG_RTW_TX_AQM
+	rtw_os_bql_complete(padapter, pxmitframe);
+#endif
+
 	if (pxmitframe->pkt){
 		pndis_pkt = pxmitframe->pkt;
 		pxmitframe->pkt = NULL;
@@ -2564,6 +3054,11 @@ _func_enter_;
 
 	_exit_critical_bh(&queue->lock, &irqL);
 
+#ifdef CONFIG_RTW_TX_GSO
+	if (pxmitframe->ext_tag == 0 && pxmitpriv->tx_gso_stopped)
+		rtw_os_gso_wake_queue(padapter);
+#endif
+
 check_pkt_complete:
 
 	if(pndis_pkt)
@@ -2617,7 +3112,111 @@ s32 rtw_xmitframe_enqueue(_adapter *padapter, struct xmit_frame *pxmitframe)
 	return _SUCCESS;
 }
 
-static struct xmit_frame *dequeue_one_xmitframe(struct xmit_priv *pxmitpriv, struct hw_xmit *phwxmit, struct tx_servq *ptxservq, _queue *pframe_queue)
+#ifdef CONFIG_RTW_TX_AQM
+static s64 tx_aqm_control_law(s64 t, u32 interval_us, u32 count)
+{
+	return t + interval_us / int_sqrt(count);
+}
+
+/*
+ * CoDel (RFC 8289) on a station AC queue, run with pxmitpriv->lock held for
+ * the frame just taken off the head. Once the sojourn time stays above target
+ * for an interval, frames are marked or dropped at a rate growing with the
+ * square root of the count until the queue drains below target again.
+ * Returns _FALSE when the frame is to be dropped.
+ */
+static u8 tx_aqm_dequeue(struct xmit_priv *pxmitpriv, struct hw_xmit *phwxmit, struct tx_servq *ptxservq, struct xmit_frame *pxmitframe)
+{
+	struct tx_aqm_vars *vars = &ptxservq->aqm;
+	struct tx_aqm_stat *stat = &pxmitpriv->tx_aqm_stat[phwxmit - pxmitpriv->hwxmits];
+	u32 interval = pxmitpriv->tx_aqm_interval_us;
+	s64 now = ktime_to_us(ktime_get());
+	u32 sojourn;
+	u8 ok_to_drop;
+
+	sojourn = (u32)(now - pxmitframe->enqueue_us);
+
+	stat->dequeued++;
+	stat->sojourn_avg_us = stat->sojourn_avg_us - (stat->sojourn_avg_us >> 3) + (sojourn >> 3);
+	if (sojourn > stat->sojourn_max_us)
+		stat->sojourn_max_us = sojourn;
+
+	if (pxmitpriv->tx_aqm_target_us == 0)
+		return _TRUE;
+
+	// the last frame of the queue is never dropped, there is no standing queue left
+	if (sojourn < pxmitpriv->tx_aqm_target_us || ptxservq->qcnt == 0) {
+		vars->first_above_us = 0;
+		ok_to_drop = _FALSE;
+	} else if (vars->first_above_us == 0) {
+		vars->first_above_us = now + interval;
+		ok_to_drop = _FALSE;
+	} else {
+		ok_to_drop = (now >= vars->first_above_us) ? _TRUE : _FALSE;
+	}
+
+	if (vars->dropping) {
+		if (ok_to_drop == _FALSE) {
+			vars->dropping = _FALSE;
+			return _TRUE;
+		}
+		if (now < vars->drop_next_us)
+			return _TRUE;
+
+		vars->count++;
+		vars->drop_next_us = tx_aqm_control_law(vars->drop_next_us, interval, vars->count);
+	} else {
+		if (ok_to_drop == _FALSE)
+			return _TRUE;
+
+		vars->dropping = _TRUE;
+		// pick up near the previous drop rate if that episode ended recently
+		if (vars->count - vars->lastcount > 1 && now - vars->drop_next_us < 16 * (s64)interval)
+			vars->count = vars->count - vars->lastcount;
+		else
+			vars->count = 1;
+		vars->lastcount = vars->count;
+		vars->drop_next_us = tx_aqm_control_law(now, interval, vars->count);
+	}
+
+	if (rtw_os_pkt_ecn_mark(pxmitframe->pkt) == _TRUE) {
+		stat->marks++;
+		return _TRUE;
+	}
+
+	stat->drops++;
+	return _FALSE;
+}
+#endif //CONFIG_RTW_TX_AQM
+
+#ifdef CONFIG_TX_AIRTIME_DRR
+/*
+ * Deficit round robin between the stations of one AC. Stations in airtime debt
+ * are refilled by one quantum and moved behind the others until the head has
+ * credit, so a slow station sits out rounds in proportion to its airtime.
+ */
+static void tx_airtime_drr_rotate(_queue *sta_queue)
+{
+	_list *phead = get_list_head(sta_queue);
+	_list *plist;
+	struct tx_servq *ptxservq;
+	int visits = 0;
+
+	while (rtw_is_list_empty(phead) == _FALSE && visits < TX_AIRTIME_MAX_VISITS) {
+		plist = get_next(phead);
+		ptxservq = LIST_CONTAINOR(plist, struct tx_servq, tx_pending);
+		if (ptxservq->deficit_us > 0)
+			break;
+
+		ptxservq->deficit_us += TX_AIRTIME_QUANTUM_US;
+		rtw_list_delete(plist);
+		rtw_list_insert_tail(plist, phead);
+		visits++;
+	}
+}
+#endif //CONFIG_TX_AIRTIME_DRR
+
+static struct xmit_frame *dequeue_one_xmitframe(struct xmit_priv *pxmitpriv, struct hw_xmit *phwxmit, struct tx_servq *ptxservq, _queue *pframe_queue, _list *drop_list)
 {
 	_list	*xmitframe_plist, *xmitframe_phead;
 	struct	xmit_frame	*pxmitframe=NULL;
@@ -2647,6 +3246,16 @@ static struct xmit_frame *dequeue_one_xmitframe(struct xmit_priv *pxmitpriv, str
 
 		ptxservq->qcnt--;
 
+#ifdef CONFIG_RTW_TX_AQM
+		if (tx_aqm_dequeue(pxmitpriv, phwxmit, ptxservq, pxmitframe) == _FALSE) {
+			// the caller only accounts for the frame returned
+			phwxmit->accnt--;
+			rtw_list_insert_tail(&pxmitframe->list, drop_list);
+			pxmitframe = NULL;
+			continue;
+		}
+#endif
+
 			break;
 
 		pxmitframe = NULL;
@@ -2666,10 +3275,17 @@ struct xmit_frame* rtw_dequeue_xframe(struct xmit_priv *pxmitpriv, struct hw_xmi
 	struct xmit_frame *pxmitframe = NULL;
 	_adapter *padapter = pxmitpriv->adapter;
 	struct registry_priv	*pregpriv = &padapter->registrypriv;
+	_list drop_list, *plist;
+	struct xmit_frame *pdropframe;
+#ifdef CONFIG_TX_AIRTIME_DRR
+	u8 airtime_drr = check_fwstate(&padapter->mlmepriv, WIFI_AP_STATE);
+#endif
 	int i, inx[4];
 
 _func_enter_;
 
+	_rtw_init_listhead(&drop_list);
+
 	inx[0] = 0; inx[1] = 1; inx[2] = 2; inx[3] = 3;
 
 	if(pregpriv->wifi_spec==1)
@@ -2716,6 +3332,11 @@ _func_enter_;
 
 		//_enter_critical_ex(&phwxmit->sta_queue->lock, &irqL0);
 
+#ifdef CONFIG_TX_AIRTIME_DRR
+		if (airtime_drr)
+			tx_airtime_drr_rotate(phwxmit->sta_queue);
+#endif
+
 		sta_phead = get_list_head(phwxmit->sta_queue);
 		sta_plist = get_next(sta_phead);
 
@@ -2726,7 +3347,7 @@ _func_enter_;
 
 			pframe_queue = &ptxservq->sta_pending;
 
-			pxmitframe = dequeue_one_xmitframe(pxmitpriv, phwxmit, ptxservq, pframe_queue);
+			pxmitframe = dequeue_one_xmitframe(pxmitpriv, phwxmit, ptxservq, pframe_queue, &drop_list);
 
 			if(pxmitframe)
 			{
@@ -2735,6 +3356,13 @@ _func_enter_;
 				//Remove sta node when there is no pending packets.
 				if(_rtw_queue_empty(pframe_queue)) //must be done after get_next and before break
 					rtw_list_delete(&ptxservq->tx_pending);
+#ifdef CONFIG_TX_AIRTIME_DRR
+				else if (airtime_drr) {
+					// the next bulk of this AC starts with the next station
+					rtw_list_delete(&ptxservq->tx_pending);
+					rtw_list_insert_tail(&ptxservq->tx_pending, sta_phead);
+				}
+#endif
 
 				//_exit_critical_ex(&phwxmit->sta_queue->lock, &irqL0);
 
@@ -2743,6 +3371,10 @@ _func_enter_;
 
 			sta_plist = get_next(sta_plist);
 
+			// everything the station had queued was dropped
+			if (_rtw_queue_empty(pframe_queue))
+				rtw_list_delete(&ptxservq->tx_pending);
+
 		}
 
 		//_exit_critical_ex(&phwxmit->sta_queue->lock, &irqL0);
@@ -2753,6 +3385,18 @@ exit:
 
 	_exit_critical_bh(&pxmitpriv->lock, &irqL0);
 
+	while (rtw_is_list_empty(&drop_list) == _FALSE) {
+		plist = get_next(&drop_list);
+		pdropframe = LIST_CONTAINOR(plist, struct xmit_frame, list);
+		rtw_list_delete(plist);
+
+		rtw_free_xmitframe(pxmitpriv, pdropframe);
+
+		// Trick, make the statistics correct
+		pxmitpriv->tx_pkts--;
+		pxmitpriv->tx_drop++;
+	}
+
 _func_exit_;
 
 	return pxmitframe;
@@ -2899,6 +3543,11 @@ _func_enter_;
 	//_enter_critical(&pstapending->lock, &irqL0);
 
 	if (rtw_is_list_empty(&ptxservq->tx_pending)) {
+#ifdef CONFIG_TX_AIRTIME_DRR
+		// no credit is banked while idle, debt is kept
+		if (ptxservq->deficit_us > 0)
+			ptxservq->deficit_us = 0;
+#endif
 		rtw_list_insert_tail(&ptxservq->tx_pending, get_list_head(phwxmits[ac_index].sta_queue));
 	}
 
@@ -3010,7 +3659,13 @@ static int rtw_br_client_tx(_adapter *padapter, struct sk_buff **pskb)
 {
 	struct sk_buff *skb = *pskb;
 	struct xmit_priv *pxmitpriv = &padapter->xmitpriv;
-	_irqL irqL;
+
+	// NETIF_F_SG lets paged skbs through, nat25 parses and rewrites the headers in place
+	if (skb_linearize(skb)) {
+		DEBUG_ERR("TX DROP: skb_linearize fail!\n");
+		return -1;
+	}
+
 	//if(check_fwstate(pmlmepriv, WIFI_STATION_STATE|WIFI_ADHOC_STATE) == _TRUE)
 	{
 		void dhcp_flag_bcast(_adapter *priv, struct sk_buff *skb);
@@ -3027,16 +3682,13 @@ static int rtw_br_client_tx(_adapter *padapter, struct sk_buff **pskb)
 		br_port = rcu_dereference(padapter->pnetdev->rx_handler_data);
 		rcu_read_unlock();
 #endif  // (LINUX_VERSION_CODE <= KERNEL_VERSION(2, 6, 35))
-		_enter_critical_bh(&padapter->br_ext_lock, &irqL);
 		if (	!(skb->data[0] & 1) &&
 				br_port &&
 				memcmp(skb->data+MACADDRLEN, padapter->br_mac, MACADDRLEN) &&
 				*((unsigned short *)(skb->data+MACADDRLEN*2)) != __constant_htons(ETH_P_8021Q) &&
 				*((unsigned short *)(skb->data+MACADDRLEN*2)) == __constant_htons(ETH_P_IP) &&
-				!memcmp(padapter->scdb_mac, skb->data+MACADDRLEN, MACADDRLEN) && padapter->scdb_entry) {
+				nat25_flow_tx_lookup(padapter, skb->data+MACADDRLEN, skb->data+WLAN_ETHHDR_LEN+12)) {
 			memcpy(skb->data+MACADDRLEN, GET_MY_HWADDR(padapter), MACADDRLEN);
-			padapter->scdb_entry->ageing_timer = jiffies;
-			_exit_critical_bh(&padapter->br_ext_lock, &irqL);
 		}
 		else
 		//if (!priv->pmib->ethBrExtInfo.nat25_disable)
@@ -3056,30 +3708,9 @@ static int rtw_br_client_tx(_adapter *padapter, struct sk_buff **pskb)
 				(*((unsigned short *)(skb->data+MACADDRLEN*2)) == __constant_htons(ETH_P_IP)))
 				memcpy(padapter->br_ip, skb->data+WLAN_ETHHDR_LEN+12, 4);
 
-			if (*((unsigned short *)(skb->data+MACADDRLEN*2)) == __constant_htons(ETH_P_IP)) {
-				if (memcmp(padapter->scdb_mac, skb->data+MACADDRLEN, MACADDRLEN)) {
-					void *scdb_findEntry(_adapter *priv, unsigned char *macAddr, unsigned char *ipAddr);
-
-					if ((padapter->scdb_entry = (struct nat25_network_db_entry *)scdb_findEntry(padapter,
-								skb->data+MACADDRLEN, skb->data+WLAN_ETHHDR_LEN+12)) != NULL) {
-						memcpy(padapter->scdb_mac, skb->data+MACADDRLEN, MACADDRLEN);
-						memcpy(padapter->scdb_ip, skb->data+WLAN_ETHHDR_LEN+12, 4);
-						padapter->scdb_entry->ageing_timer = jiffies;
-						do_nat25 = 0;
-					}
-				}
-				else {
-					if (padapter->scdb_entry) {
-						padapter->scdb_entry->ageing_timer = jiffies;
-						do_nat25 = 0;
-					}
-					else {
-						memset(padapter->scdb_mac, 0, MACADDRLEN);
-						memset(padapter->scdb_ip, 0, 4);
-					}
-				}
-			}
-			_exit_critical_bh(&padapter->br_ext_lock, &irqL);
+			if (*((unsigned short *)(skb->data+MACADDRLEN*2)) == __constant_htons(ETH_P_IP) &&
+				nat25_flow_tx_lookup(padapter, skb->data+MACADDRLEN, skb->data+WLAN_ETHHDR_LEN+12))
+				do_nat25 = 0;
 #endif // 1
 			if (do_nat25)
 			{
@@ -3203,6 +3834,58 @@ static void do_queue_select(_adapter	*padapter, struct pkt_attrib *pattrib)
 	pattrib->qsel = qsel;
 }
 
+// hand a frame with its attrib filled to the staging ring, a sleeping station or the HAL
+static s32 xmitframe_enqueue(_adapter *padapter, struct xmit_frame *pxmitframe, u8 qidx)
+{
+	struct xmit_priv *pxmitpriv = &padapter->xmitpriv;
+#if !defined(CONFIG_XMIT_STAGING_RING) && (defined(CONFIG_AP_MODE) || defined(CONFIG_TDLS))
+	_irqL irqL0;
+#endif
+
+#ifdef CONFIG_RTW_TX_AQM
+	pxmitframe->enqueue_us = ktime_to_us(ktime_get());
+	rtw_os_bql_sent(padapter, pxmitframe);
+#endif
+
+#ifdef CONFIG_XMIT_STAGING_RING
+	// sleeping-STA check and classification are done by the xmit tasklet when it drains the ring
+	if (rtw_xmit_staging_push(padapter, qidx, pxmitframe) == _SUCCESS) {
+		tasklet_hi_schedule(&pxmitpriv->xmit_tasklet);
+		return 1;
+	}
+
+	// the ring outsizes the xmit_frame pool, so this is not expected; queueing around
+	// the ring would reorder the flow, drop instead and let the caller free the skb
+	DBG_871X("%s: staging ring %u full\n", __FUNCTION__, qidx);
+#ifdef CONFIG_RTW_TX_AQM
+	rtw_os_bql_complete(padapter, pxmitframe);
+#endif
+	pxmitframe->pkt = NULL;
+	rtw_free_xmitframe(pxmitpriv, pxmitframe);
+	return -1;
+#else
+
+#if defined(CONFIG_AP_MODE) || defined(CONFIG_TDLS)
+	_enter_critical_bh(&pxmitpriv->lock, &irqL0);
+	if(xmitframe_enqueue_for_sleeping_sta(padapter, pxmitframe) == _TRUE)
+	{
+		_exit_critical_bh(&pxmitpriv->lock, &irqL0);
+#ifdef CONFIG_RTW_TX_AQM
+		// a dozing station must not hold back the others
+		rtw_os_bql_complete(padapter, pxmitframe);
+#endif
+		return 1;
+	}
+	_exit_critical_bh(&pxmitpriv->lock, &irqL0);
+#endif
+
+	if (rtw_hal_xmit(padapter, pxmitframe) == _FALSE)
+		return 1;
+
+	return 0;
+#endif
+}
+
 /*
  * The main transmit(tx) entry
  *
@@ -3211,22 +3894,31 @@ static void do_queue_select(_adapter	*padapter, struct pkt_attrib *pattrib)
  *	0	success, hardware will handle this xmit frame(packet)
  *	<0	fail
  */
-s32 rtw_xmit(_adapter *padapter, _pkt **ppkt)
+static s32 xmit_pkt(_adapter *padapter, _pkt **ppkt, u8 *da)
 {
 	static u32 start = 0;
 	static u32 drop_cnt = 0;
-#ifdef CONFIG_AP_MODE
-	_irqL irqL0;
-#endif
 	struct xmit_priv *pxmitpriv = &padapter->xmitpriv;
 	struct xmit_frame *pxmitframe = NULL;
 #ifdef CONFIG_BR_EXT
 	struct mlme_priv	*pmlmepriv = &padapter->mlmepriv;
 	void *br_port = NULL;
 #endif	// CONFIG_BR_EXT
+#ifdef CONFIG_XMIT_STAGING_RING
+	u8 qidx = 0;
+#endif
 
 	s32 res;
 
+#ifdef CONFIG_XMIT_STAGING_RING
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,35))
+	// the subqueue identifies the producer, take it before br_ext may replace the skb
+	qidx = skb_get_queue_mapping(*ppkt);
+	if (qidx >= HWXMIT_ENTRY)
+		qidx = 0;
+#endif
+#endif
+
 	if (start == 0)
 		start = rtw_get_current_time();
 
@@ -3267,7 +3959,7 @@ s32 rtw_xmit(_adapter *padapter, _pkt **ppkt)
 
 #endif	// CONFIG_BR_EXT
 
-	res = update_attrib(padapter, *ppkt, &pxmitframe->attrib);
+	res = update_attrib(padapter, *ppkt, &pxmitframe->attrib, da);
 	if (res == _FAIL) {
 		RT_TRACE(_module_xmit_osdep_c_, _drv_err_, ("rtw_xmit: update attrib fail\n"));
 		#ifdef DBG_TX_DROP_FRAME
@@ -3282,21 +3974,121 @@ s32 rtw_xmit(_adapter *padapter, _pkt **ppkt)
 
 	do_queue_select(padapter, &pxmitframe->attrib);
 
-#if defined(CONFIG_AP_MODE) || defined(CONFIG_TDLS)
-	_enter_critical_bh(&pxmitpriv->lock, &irqL0);
-	if(xmitframe_enqueue_for_sleeping_sta(padapter, pxmitframe) == _TRUE)
-	{
-		_exit_critical_bh(&pxmitpriv->lock, &irqL0);
-		return 1;
-	}
-	_exit_critical_bh(&pxmitpriv->lock, &irqL0);
+#ifdef CONFIG_XMIT_STAGING_RING
+	return xmitframe_enqueue(padapter, pxmitframe, qidx);
+#else
+	return xmitframe_enqueue(padapter, pxmitframe, 0);
 #endif
+}
 
-	if (rtw_hal_xmit(padapter, pxmitframe) == _FALSE)
-		return 1;
+s32 rtw_xmit(_adapter *padapter, _pkt **ppkt)
+{
+	return xmit_pkt(padapter, ppkt, NULL);
+}
 
-	return 0;
+#ifdef CONFIG_TX_MCAST2UNI
+/*
+ * Send a multicast skb as unicast to the station da, the ethernet header is
+ * left alone so that clones of one skb can go to several stations.
+ */
+s32 rtw_xmit_unicast(_adapter *padapter, _pkt **ppkt, u8 *da)
+{
+	return xmit_pkt(padapter, ppkt, da);
 }
+#endif
+
+#ifdef CONFIG_RTW_TX_GSO
+/*
+ * Queue the segments of one GSO skb, linked through ->next. update_attrib() runs
+ * for the first segment only, the others reuse its result and differ in length
+ * only. The HAL coalesces consecutive frames of a station/TID into one xmit_buf,
+ * so segment payloads are copied from the original pages straight into it.
+ * Returns the number of segments queued, the others are freed.
+ */
+u32 rtw_xmit_gso(_adapter *padapter, _pkt *segs)
+{
+	struct xmit_priv *pxmitpriv = &padapter->xmitpriv;
+	struct xmit_frame *pxmitframe;
+	struct pkt_attrib attrib;
+	_pkt *pkt, *next;
+	u8 attrib_valid = _FALSE;
+	u8 qidx = 0;
+	u32 queued = 0;
+#ifdef CONFIG_BR_EXT
+	struct mlme_priv	*pmlmepriv = &padapter->mlmepriv;
+	void *br_port = NULL;
+
+#if (LINUX_VERSION_CODE <= KERNEL_VERSION(2, 6, 35))
+	br_port = padapter->pnetdev->br_port;
+#else   // (LINUX_VERSION_CODE <= KERNEL_VERSION(2, 6, 35))
+	rcu_read_lock();
+	br_port = rcu_dereference(padapter->pnetdev->rx_handler_data);
+	rcu_read_unlock();
+#endif  // (LINUX_VERSION_CODE <= KERNEL_VERSION(2, 6, 35))
+#endif	// CONFIG_BR_EXT
+
+#ifdef CONFIG_XMIT_STAGING_RING
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,35))
+	qidx = skb_get_queue_mapping(segs);
+	if (qidx >= HWXMIT_ENTRY)
+		qidx = 0;
+#endif
+#endif
+
+	for (pkt = segs; pkt != NULL; pkt = next) {
+		next = pkt->next;
+		pkt->next = NULL;
+
+#ifdef CONFIG_BR_EXT
+		// NAT2.5 may rewrite every segment, keep the per-packet path
+		if (br_port && check_fwstate(pmlmepriv, WIFI_STATION_STATE|WIFI_ADHOC_STATE) == _TRUE) {
+			if (rtw_xmit(padapter, &pkt) < 0)
+				goto drop;
+			queued++;
+			continue;
+		}
+#endif	// CONFIG_BR_EXT
+
+		pxmitframe = rtw_alloc_xmitframe(pxmitpriv);
+		if (pxmitframe == NULL)
+			goto drop;
+
+		if (attrib_valid == _FALSE) {
+			if (update_attrib(padapter, pkt, &pxmitframe->attrib, NULL) == _FAIL) {
+				rtw_free_xmitframe(pxmitpriv, pxmitframe);
+				goto drop;
+			}
+			do_queue_select(padapter, &pxmitframe->attrib);
+
+			// the first frame may be sent and recycled before the last segment is queued
+			memcpy(&attrib, &pxmitframe->attrib, sizeof(struct pkt_attrib));
+			attrib_valid = _TRUE;
+		} else {
+			memcpy(&pxmitframe->attrib, &attrib, sizeof(struct pkt_attrib));
+			pxmitframe->attrib.pktlen = pkt->len - attrib.pkt_hdrlen;
+			rtw_set_tx_chksum_offload(pkt, &pxmitframe->attrib);
+		}
+		pxmitframe->pkt = pkt;
+
+		if (xmitframe_enqueue(padapter, pxmitframe, qidx) < 0)
+			goto drop;
+		queued++;
+		continue;
+
+drop:
+		pxmitpriv->tx_drop++;
+		rtw_os_pkt_complete(padapter, pkt);
+	}
+
+	if (queued) {
+		rtw_led_control(padapter, LED_CTL_TX);
+		pxmitpriv->tx_gso_cnt++;
+		pxmitpriv->tx_gso_segs += queued;
+	}
+
+	return queued;
+}
+#endif //CONFIG_RTW_TX_GSO
 
 #ifdef CONFIG_TDLS
 sint xmitframe_enqueue_for_tdls_sleeping_sta(_adapter *padapter, struct xmit_frame *pxmitframe)
@@ -3477,7 +4269,7 @@ sint xmitframe_enqueue_for_sleeping_sta(_adapter *padapter, struct xmit_frame *p
 	{
 		_enter_critical_bh(&psta->sleep_q.lock, &irqL);
 
-		if(pstapriv->sta_dz_bitmap)//if anyone sta is in ps mode
+		if(rtw_tim_map_anyone_be_set(pstapriv, pstapriv->sta_dz_bitmap))//if anyone sta is in ps mode
 		{
 			//pattrib->qsel = 0x11;//HIQ
 
@@ -3489,11 +4281,11 @@ sint xmitframe_enqueue_for_sleeping_sta(_adapter *padapter, struct xmit_frame *p
 
 			psta->sleepq_len++;
 
-			if (!(pstapriv->tim_bitmap & BIT(0)))
+			if (!rtw_tim_map_is_set(pstapriv->tim_bitmap, 0))
 				update_tim = _TRUE;
 
-			pstapriv->tim_bitmap |= BIT(0);//
-			pstapriv->sta_dz_bitmap |= BIT(0);
+			rtw_tim_map_set(pstapriv->tim_bitmap, 0);//
+			rtw_tim_map_set(pstapriv->sta_dz_bitmap, 0);
 
 			//DBG_871X("enqueue, sq_len=%d, tim=%x\n", psta->sleepq_len, pstapriv->tim_bitmap);
 
@@ -3525,7 +4317,7 @@ sint xmitframe_enqueue_for_sleeping_sta(_adapter *padapter, struct xmit_frame *p
 	{
 		u8 wmmps_ac=0;
 
-		if(pstapriv->sta_dz_bitmap&BIT(psta->aid))
+		if(rtw_tim_map_is_set(pstapriv->sta_dz_bitmap, psta->aid))
 		{
 			rtw_list_delete(&pxmitframe->list);
 
@@ -3561,10 +4353,10 @@ sint xmitframe_enqueue_for_sleeping_sta(_adapter *padapter, struct xmit_frame *p
 
 			if(((psta->has_legacy_ac) && (!wmmps_ac)) ||((!psta->has_legacy_ac)&&(wmmps_ac)))
 			{
-				if (!(pstapriv->tim_bitmap & BIT(psta->aid)))
+				if (!rtw_tim_map_is_set(pstapriv->tim_bitmap, psta->aid))
 					update_tim = _TRUE;
 
-				pstapriv->tim_bitmap |= BIT(psta->aid);
+				rtw_tim_map_set(pstapriv->tim_bitmap, psta->aid);
 
 				//DBG_871X("enqueue, sq_len=%d, tim=%x\n", psta->sleepq_len, pstapriv->tim_bitmap);
 
@@ -3626,6 +4418,9 @@ static void dequeue_xmitframes_to_sleeping_queue(_adapter *padapter, struct sta_
 
 		    ptxservq->qcnt--;
 		    phwxmits[ac_index].accnt--;
+#ifdef CONFIG_RTW_TX_AQM
+		    rtw_os_bql_complete(padapter, pxmitframe);
+#endif
 		}
 		else
 		{
@@ -3657,7 +4452,7 @@ void stop_sta_xmit(_adapter *padapter, struct sta_info *psta)
 #ifdef CONFIG_TDLS
 	if( !(psta->tdls_sta_state & TDLS_LINKED_STATE) )
 #endif //CONFIG_TDLS
-	pstapriv->sta_dz_bitmap |= BIT(psta->aid);
+	rtw_tim_map_set(pstapriv->sta_dz_bitmap, psta->aid);
 
 
 
@@ -3795,14 +4590,14 @@ void wakeup_sta_to_xmit(_adapter *padapter, struct sta_info *psta)
 		}
 #endif //CONFIG_TDLS
 
-		if (pstapriv->tim_bitmap & BIT(psta->aid)) {
+		if (rtw_tim_map_is_set(pstapriv->tim_bitmap, psta->aid)) {
 			//DBG_871X("wakeup to xmit, qlen==0, update_BCNTIM, tim=%x\n", pstapriv->tim_bitmap);
 			//upate BCN for TIM IE
 			//update_BCNTIM(padapter);
 			update_mask = BIT(0);
 		}
 
-		pstapriv->tim_bitmap &= ~BIT(psta->aid);
+		rtw_tim_map_clear(pstapriv->tim_bitmap, psta->aid);
 
 		if(psta->state&WIFI_SLEEP_STATE)
 			psta->state ^= WIFI_SLEEP_STATE;
@@ -3813,14 +4608,14 @@ void wakeup_sta_to_xmit(_adapter *padapter, struct sta_info *psta)
 			psta->state ^= WIFI_STA_ALIVE_CHK_STATE;
 		}
 
-		pstapriv->sta_dz_bitmap &= ~BIT(psta->aid);
+		rtw_tim_map_clear(pstapriv->sta_dz_bitmap, psta->aid);
 	}
 
 	//for BC/MC Frames
 	if(!psta_bmc)
 		goto _exit;
 
-	if((pstapriv->sta_dz_bitmap&0xfffe) == 0x0)//no any sta in ps mode
+	if(!rtw_tim_map_anyone_be_set_exclude_aid0(pstapriv, pstapriv->sta_dz_bitmap))//no any sta in ps mode
 	{
 		xmitframe_phead = get_list_head(&psta_bmc->sleep_q);
 		xmitframe_plist = get_next(xmitframe_phead);
@@ -3856,15 +4651,15 @@ void wakeup_sta_to_xmit(_adapter *padapter, struct sta_info *psta)
 
 		if(psta_bmc->sleepq_len==0)
 		{
-			if (pstapriv->tim_bitmap & BIT(0)) {
+			if (rtw_tim_map_is_set(pstapriv->tim_bitmap, 0)) {
 				//DBG_871X("wakeup to xmit, qlen==0, update_BCNTIM, tim=%x\n", pstapriv->tim_bitmap);
 				//upate BCN for TIM IE
 				//update_BCNTIM(padapter);
 				update_mask |= BIT(1);
 			}
 
-			pstapriv->tim_bitmap &= ~BIT(0);
-			pstapriv->sta_dz_bitmap &= ~BIT(0);
+			rtw_tim_map_clear(pstapriv->tim_bitmap, 0);
+			rtw_tim_map_clear(pstapriv->sta_dz_bitmap, 0);
 		}
 
 	}
@@ -3969,7 +4764,7 @@ void xmit_delivery_enabled_frames(_adapter *padapter, struct sta_info *psta)
 				return;
 			}
 #endif //CONFIG_TDLS
-			pstapriv->tim_bitmap &= ~BIT(psta->aid);
+			rtw_tim_map_clear(pstapriv->tim_bitmap, psta->aid);
 
 			//DBG_871X("wakeup to xmit, qlen==0, update_BCNTIM, tim=%x\n", pstapriv->tim_bitmap);
 			//upate BCN for TIM IE
@@ -4109,17 +4904,22 @@ static int rtw_ack_tx_polling(struct xmit_priv *pxmitpriv, u32 timeout_ms)
 
 int rtw_ack_tx_wait(struct xmit_priv *pxmitpriv, u32 timeout_ms)
 {
-#ifdef CONFIG_XMIT_ACK_POLLING
-	return rtw_ack_tx_polling(pxmitpriv, timeout_ms);
-#else
 	struct submit_ctx *pack_tx_ops = &pxmitpriv->ack_tx_ops;
+#ifdef CONFIG_XMIT_ACK_POLLING
+#ifdef CONFIG_USB_INTERRUPT_IN_PIPE
+	_adapter *adapter = container_of(pxmitpriv, _adapter, xmitpriv);
+
+	// TX reports are pushed on the interrupt pipe while it is up, just wait for them
+	if (adapter->recvpriv.int_in_active == _FALSE)
+#endif
+		return rtw_ack_tx_polling(pxmitpriv, timeout_ms);
+#endif
 
 	pack_tx_ops->submit_time = rtw_get_current_time();
 	pack_tx_ops->timeout_ms = timeout_ms;
 	pack_tx_ops->status = RTW_SCTX_SUBMITTED;
 
 	return rtw_sctx_wait(pack_tx_ops);
-#endif
 }
 
 void rtw_ack_tx_done(struct xmit_priv *pxmitpriv, int status)
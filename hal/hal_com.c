@@ -316,7 +316,6 @@ s32 c2h_evt_read(_adapter *adapter, u8 *buf)
 {
 	s32 ret = _FAIL;
 	struct c2h_evt_hdr *c2h_evt;
-	int i;
 	u8 trigger;
 
 	if (buf == NULL)
@@ -334,8 +333,8 @@ s32 c2h_evt_read(_adapter *adapter, u8 *buf)
 
 	_rtw_memset(c2h_evt, 0, 16);
 
-	*buf = rtw_read8(adapter, REG_C2HEVT_MSG_NORMAL);
-	*(buf+1) = rtw_read8(adapter, REG_C2HEVT_MSG_NORMAL + 1);
+	/* Header and content sit right below the trigger, fetch them in one transfer */
+	rtw_read_mem(adapter, REG_C2HEVT_MSG_NORMAL, C2H_EVT_MSG_LEN, buf);
 
 	RT_PRINT_DATA(_module_hal_init_c_, _drv_info_, "c2h_evt_read(): ",
 		&c2h_evt , sizeof(c2h_evt));
@@ -345,9 +344,8 @@ s32 c2h_evt_read(_adapter *adapter, u8 *buf)
 			, c2h_evt->id, c2h_evt->plen, c2h_evt->seq, trigger);
 	}
 
-	/* Read the content */
-	for (i = 0; i < c2h_evt->plen; i++)
-		c2h_evt->payload[i] = rtw_read8(adapter, REG_C2HEVT_MSG_NORMAL + 2 + i);
+	if (c2h_evt->plen > C2H_EVT_MSG_LEN - sizeof(*c2h_evt))
+		goto clear_evt; /* Not a valid length */
 
 	RT_PRINT_DATA(_module_hal_init_c_, _drv_info_, "c2h_evt_read(): Command Content:\n",
 		c2h_evt->payload, c2h_evt->plen);
@@ -543,3 +543,11 @@ c2h_id_filter rtw_hal_c2h_id_filter_ccx(_adapter *adapter)
 {
 	return adapter->HalFunc.c2h_id_filter_ccx;
 }
+
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+void rtw_hal_tx_agg_update(_adapter *padapter, u8 qidx, u32 lat_us, u8 agg_stop)
+{
+	if (padapter->HalFunc.tx_agg_update)
+		padapter->HalFunc.tx_agg_update(padapter, qidx, lat_us, agg_stop);
+}
+#endif
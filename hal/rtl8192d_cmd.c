@@ -1081,6 +1081,11 @@ _func_enter_;
 	//check DMA idle?
 	while(test != BIT(1))
 	{
+#ifdef CONFIG_RTW_NAPI
+		if (precvpriv->napi_en)
+			napi_schedule(&precvpriv->napi);
+		else
+#endif
 		tasklet_schedule(&precvpriv->recv_tasklet);
 		test = rtw_read8(padapter, REG_RXPKT_NUM+2) & BIT(1);
 		rtw_msleep_os(10);
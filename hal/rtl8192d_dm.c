@@ -2347,10 +2347,12 @@ dm_TXPowerTrackingCallback_ThermalMeter_92D(
 
 		if((delta_IQK > pdmpriv->Delta_IQK) && (pdmpriv->Delta_IQK != 0))
 		{
-			rtl8192d_PHY_ResetIQKResult(Adapter);
+			// Moving the IQK thermal reference is enough to retire the cached
+			// results taken at the old temperature; they become usable again
+			// if the chip cools/heats back to it.
 #ifdef CONFIG_CONCURRENT_MODE
 			if (rtw_buddy_adapter_up(Adapter)) {
-				rtl8192d_PHY_ResetIQKResult(Adapter->pbuddy_adapter);
+				GET_HAL_DATA(Adapter->pbuddy_adapter)->dmpriv.ThermalValue_IQK = ThermalValue;
 			}
 #endif
 			pdmpriv->ThermalValue_IQK = ThermalValue;
@@ -3132,6 +3134,13 @@ rtl8192d_HalDmWatchDog(
 		//update_EDCA_param(Adapter);
 		dm_CheckEdcaTurbo(Adapter);
 
+#ifdef CONFIG_USB_RX_AGG_TUNE
+		rtl8192du_rx_agg_tune(Adapter);
+#endif
+#ifdef CONFIG_USB_RX_URB_SCALE
+		rtl8192du_rx_urb_scale(Adapter);
+#endif
+
 		//
 		// Dynamically switch RTS/CTS protection.
 		//
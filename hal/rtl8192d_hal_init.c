@@ -97,59 +97,66 @@ static int _BlockWrite_92d(PADAPTER Adapter, PVOID buffer, u32 size)
 
 	u32			blockSize8 = sizeof(u64);
 	u32			blocksize4 = sizeof(u32);
-	u32			blockSize = 64;
 	u8*			bufferPtr = (u8*)buffer;
 	u32*		pu4BytePtr = (u32*)buffer;
-	u32			i, offset, blockCount, remainSize,remain8,remain4,blockCount8,blockCount4;
+	u32			i, offset, remainSize, blockCount8, blockCount4;
+#ifndef CONFIG_USB_FWDL_PIPELINE
+	u32			blockSize = 64;
+	u32			blockCount;
+#endif
 
-	blockCount = size / blockSize;
-	remain8 = size % blockSize;
-	for(i = 0 ; i < blockCount ; i++){
-		offset = i * blockSize;
-		ret = rtw_writeN(Adapter, (FW_8192D_START_ADDRESS + offset), 64,(bufferPtr + offset));
+	offset = 0;
+
+#ifdef CONFIG_USB_FWDL_PIPELINE
+	// The 8-byte aligned body goes out in one pipelined burst of
+	// maximum-size vendor requests, only the tail is written piecewise.
+	blockCount8 = size / blockSize8;
+	if(blockCount8){
+		ret = rtw_write_mem(Adapter, FW_8192D_START_ADDRESS, blockCount8 * blockSize8, bufferPtr);
 
 		if(ret == _FAIL)
 			goto exit;
-	}
 
+		offset = blockCount8 * blockSize8;
+	}
+#else
+	blockCount = size / blockSize;
+	for(i = 0 ; i < blockCount ; i++){
+		ret = rtw_writeN(Adapter, (FW_8192D_START_ADDRESS + offset), blockSize, (bufferPtr + offset));
 
-	if(remain8){
-		offset = blockCount * blockSize;
+		if(ret == _FAIL)
+			goto exit;
 
-		blockCount8=remain8/blockSize8;
-		remain4=remain8%blockSize8;
-		//RT_TRACE(COMP_INIT,DBG_LOUD,("remain4 size %x blockcount %x blockCount8 %x\n",remain4,blockCount,blockCount8));
-		for(i = 0 ; i < blockCount8 ; i++){
-			ret = rtw_writeN(Adapter, (FW_8192D_START_ADDRESS + offset+i*blockSize8), 8,(bufferPtr + offset+i*blockSize8));
+		offset += blockSize;
+	}
 
-			if(ret == _FAIL)
-				goto exit;
-		}
+	blockCount8 = (size - offset) / blockSize8;
+	for(i = 0 ; i < blockCount8 ; i++){
+		ret = rtw_writeN(Adapter, (FW_8192D_START_ADDRESS + offset), blockSize8, (bufferPtr + offset));
 
-		if(remain4){
-			offset=blockCount * blockSize+blockCount8*blockSize8;
-			blockCount4=remain4/blocksize4;
-			remainSize=remain8%blocksize4;
+		if(ret == _FAIL)
+			goto exit;
 
-			for(i = 0 ; i < blockCount4 ; i++){
-				ret = rtw_write32(Adapter, (FW_8192D_START_ADDRESS + offset+i*blocksize4), cpu_to_le32(*(pu4BytePtr+ offset/4+i)));
+		offset += blockSize8;
+	}
+#endif
 
-				if(ret == _FAIL)
-					goto exit;
-			}
+	blockCount4 = (size - offset) / blocksize4;
+	for(i = 0 ; i < blockCount4 ; i++){
+		ret = rtw_write32(Adapter, (FW_8192D_START_ADDRESS + offset), cpu_to_le32(*(pu4BytePtr + offset/4)));
 
-			if(remainSize){
-				offset=blockCount * blockSize+blockCount8*blockSize8+blockCount4*blocksize4;
-				for(i = 0 ; i < remainSize ; i++){
-					ret = rtw_write8(Adapter, (FW_8192D_START_ADDRESS + offset + i), *(bufferPtr +offset+ i));
+		if(ret == _FAIL)
+			goto exit;
 
-					if(ret == _FAIL)
-						goto exit;
-				}
-			}
+		offset += blocksize4;
+	}
 
-		}
+	remainSize = size - offset;
+	for(i = 0 ; i < remainSize ; i++){
+		ret = rtw_write8(Adapter, (FW_8192D_START_ADDRESS + offset + i), *(bufferPtr + offset + i));
 
+		if(ret == _FAIL)
+			goto exit;
 	}
 
 exit:
@@ -325,6 +332,7 @@ int FirmwareDownload92D(PADAPTER Adapter, BOOLEAN bUsedWoWLANFw)
 	int	rtStatus = _SUCCESS;
 	u8 writeFW_retry = 0;
 	u32 fwdl_start_time;
+	u32 fwdl_vendor_req_cnt;
 	HAL_DATA_TYPE	*pHalData = GET_HAL_DATA(Adapter);
 	s8				R92DFwImageFileName[] ={RTL8192D_FW_IMG};
 	u8*				FwImage;
@@ -520,6 +528,7 @@ int FirmwareDownload92D(PADAPTER Adapter, BOOLEAN bUsedWoWLANFw)
 
 	_FWDownloadEnable(Adapter, _TRUE);
 	fwdl_start_time = rtw_get_current_time();
+	fwdl_vendor_req_cnt = Adapter->iopriv.vendor_req_cnt;
 	while(1) {
 		//reset the FWDL chksum
 		rtw_write8(Adapter, REG_MCUFWDL, rtw_read8(Adapter, REG_MCUFWDL)|FWDL_ChkSum_rpt);
@@ -533,9 +542,14 @@ int FirmwareDownload92D(PADAPTER Adapter, BOOLEAN bUsedWoWLANFw)
 	}
 	_FWDownloadEnable(Adapter, _FALSE);
 
-	DBG_871X("%s writeFW_retry:%u, time after fwdl_start_time:%ums\n", __FUNCTION__
+	Adapter->iopriv.fwdl_time_ms = rtw_get_passing_time_ms(fwdl_start_time);
+	Adapter->iopriv.fwdl_vendor_req_cnt = Adapter->iopriv.vendor_req_cnt - fwdl_vendor_req_cnt;
+	Adapter->iopriv.fwdl_retry = writeFW_retry;
+
+	DBG_871X("%s writeFW_retry:%u, time after fwdl_start_time:%ums, %u vendor requests\n", __FUNCTION__
 		, writeFW_retry
-		, rtw_get_passing_time_ms(fwdl_start_time)
+		, Adapter->iopriv.fwdl_time_ms
+		, Adapter->iopriv.fwdl_vendor_req_cnt
 	);
 
 	if(_SUCCESS != rtStatus){
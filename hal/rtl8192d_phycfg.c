@@ -300,7 +300,8 @@ rtl8192d_PHY_SetBBReg(
 
 	if(BitMask!= bMaskDWord)
 	{//if not "double word" write
-		OriginalValue = rtw_read32(Adapter, RegAddr);
+		if (rtw_io_shadow_read32(Adapter, RegAddr, &OriginalValue) == _FALSE)
+			OriginalValue = rtw_read32(Adapter, RegAddr);
 		BitShift = phy_CalculateBitShift(BitMask);
 		Data = ((OriginalValue & (~BitMask)) | ((Data << BitShift) & BitMask));
 	}
@@ -715,6 +716,102 @@ phy_ConfigMACWithParaFile(
 	return rtStatus;
 }
 #endif //CONFIG_EMBEDDED_FWIMG
+#ifdef CONFIG_PHY_TBL_IMAGE
+//
+// The MAC table is turned once into an image of contiguous register runs.
+// Every later init pushes a run with a single rtw_writeN instead of one
+// vendor request per table entry. Entries are kept as they are, a register
+// the table writes twice is written twice.
+//
+#define PHY_TBL_RUN_MAX_LEN	254	// one vendor request, VENDOR_CMD_MAX_DATA_LEN
+
+struct phy_tbl_run {
+	u16	addr;
+	u16	len;		// bytes in the run
+	u16	offset;		// start of the run in data[]
+};
+
+struct phy_tbl_image {
+	BOOLEAN	bBuilt;
+	u16	entry_num;
+	u16	run_num;
+	struct phy_tbl_run	*run;
+	u8	*data;
+};
+
+static struct phy_tbl_run	phy_mac_tbl_run[Rtl8192D_MAC_ArrayLength/2];
+static u8	phy_mac_tbl_data[Rtl8192D_MAC_ArrayLength/2];
+static struct phy_tbl_image	phy_mac_tbl_image = {_FALSE, 0, 0, phy_mac_tbl_run, phy_mac_tbl_data};
+
+// both MACs of a dual-MAC card may come up at the same time
+static atomic_t GlobalMutexForPhyTblImage = ATOMIC_INIT(0);
+
+static VOID
+phy_BuildTblImage(
+	struct phy_tbl_image	*pImage,
+	const u32		*pTable,
+	u32			ArrayLength,
+	u8			width
+	)
+{
+	struct phy_tbl_run	*pRun = NULL;
+	u32	i, j, RegAddr, Data;
+	u16	offset = 0;
+
+	pImage->run_num = 0;
+
+	for (i = 0; i < ArrayLength; i += 2)
+	{
+		RegAddr = pTable[i];
+		Data = pTable[i+1];
+
+		if (pRun == NULL || RegAddr != pRun->addr + pRun->len
+			|| pRun->len + width > (PHY_TBL_RUN_MAX_LEN / width) * width)
+		{
+			pRun = &pImage->run[pImage->run_num++];
+			pRun->addr = (u16)RegAddr;
+			pRun->len = 0;
+			pRun->offset = offset;
+		}
+
+		for (j = 0; j < width; j++)
+			pImage->data[offset++] = (u8)(Data >> (j * 8));
+		pRun->len += width;
+	}
+
+	pImage->entry_num = (u16)(ArrayLength / 2);
+	pImage->bBuilt = _TRUE;
+}
+
+static VOID
+phy_LoadTblImage(
+	PADAPTER		Adapter,
+	struct phy_tbl_image	*pImage,
+	const u32		*pTable,
+	u32			ArrayLength,
+	u8			width
+	)
+{
+	struct phy_tbl_run	*pRun;
+	u32	vendor_req_cnt = Adapter->iopriv.vendor_req_cnt;
+	u16	i;
+
+	ACQUIRE_GLOBAL_MUTEX(GlobalMutexForPhyTblImage);
+	if (pImage->bBuilt == _FALSE)
+		phy_BuildTblImage(pImage, pTable, ArrayLength, width);
+	RELEASE_GLOBAL_MUTEX(GlobalMutexForPhyTblImage);
+
+	for (i = 0; i < pImage->run_num; i++)
+	{
+		pRun = &pImage->run[i];
+		rtw_writeN(Adapter, pRun->addr, pRun->len, &pImage->data[pRun->offset]);
+	}
+
+	DBG_871X_LEVEL(_drv_info_, "%s: %u entries in %u runs, %u vendor requests\n", __FUNCTION__,
+		pImage->entry_num, pImage->run_num, Adapter->iopriv.vendor_req_cnt - vendor_req_cnt);
+}
+#endif //CONFIG_PHY_TBL_IMAGE
+
 /*-----------------------------------------------------------------------------
  * Function:    phy_ConfigMACWithHeaderFile()
  *
@@ -748,9 +845,13 @@ phy_ConfigMACWithHeaderFile(
 	ptrArray = (u32 *)Rtl8192D_MAC_Array;
 	//RT_TRACE(COMP_INIT, DBG_LOUD, (" ===> phy_ConfigMACWithHeaderFile() Img:Rtl819XMAC_Array\n"));
 
+#ifdef CONFIG_PHY_TBL_IMAGE
+	phy_LoadTblImage(Adapter, &phy_mac_tbl_image, ptrArray, ArrayLength, 1);
+#else
 	for(i = 0 ;i < ArrayLength;i=i+2){ // Add by tynli for 2 column
 		rtw_write8(Adapter, ptrArray[i], (u8)ptrArray[i+1]);
 	}
+#endif
 
 	return _SUCCESS;
 
@@ -2286,9 +2387,11 @@ PHY_SetTxPowerLevel8192D(
 	if(pHalData->CurrentBandType92D == BAND_ON_2_4G)
 		ccxPowerIndexCheck(Adapter, channel, &cckPowerLevel[0], &ofdmPowerLevel[0]);
 
+	rtw_io_batch_begin(Adapter);
 	if(pHalData->CurrentBandType92D == BAND_ON_2_4G)
 		rtl8192d_PHY_RF6052SetCckTxPower(Adapter, &cckPowerLevel[0]);
 	rtl8192d_PHY_RF6052SetOFDMTxPower(Adapter, &ofdmPowerLevel[0], channel);
+	rtw_io_batch_end(Adapter);
 
 #if 0
 	switch(pHalData->rf_chip)
@@ -3346,6 +3449,79 @@ static  VOID
 }
 
 
+//
+// IQK results are cached per channel together with the thermal meter reading and
+// MAC/PHY mode they were taken under. An entry is reused as long as the thermal
+// meter stays within Delta_IQK of that reading, so revisiting a channel (scan,
+// roaming, band switch) only reloads the matrix instead of running IQK again.
+//
+static u8
+phy_IQKThermalRef(
+	PADAPTER				Adapter
+	)
+{
+	HAL_DATA_TYPE	*pHalData = GET_HAL_DATA(Adapter);
+
+	if(pHalData->dmpriv.ThermalValue_IQK)
+		return pHalData->dmpriv.ThermalValue_IQK;
+
+	return pHalData->EEPROMThermalMeter;
+}
+
+static BOOLEAN
+phy_IQKResultValid(
+	PADAPTER				Adapter,
+	u8					Indexforchannel
+	)
+{
+	HAL_DATA_TYPE	*pHalData = GET_HAL_DATA(Adapter);
+	PIQK_MATRIX_REGS_SETTING	pSetting = &pHalData->IQKMatrixRegSetting[Indexforchannel];
+	u8		ThermalValue = phy_IQKThermalRef(Adapter), delta;
+
+	if(!pSetting->bIQKDone)
+		return _FALSE;
+
+	if(pSetting->MacPhyMode != pHalData->MacPhyMode92D)
+		return _FALSE;
+
+	if(pSetting->ChannelBW != pHalData->CurrentChannelBW)
+		return _FALSE;
+
+	delta = (ThermalValue > pSetting->ThermalValue)?(ThermalValue - pSetting->ThermalValue):(pSetting->ThermalValue - ThermalValue);
+	if(delta > pHalData->dmpriv.Delta_IQK)
+		return _FALSE;
+
+	return _TRUE;
+}
+
+static VOID
+phy_LoadIQKMatrix(
+	PADAPTER				Adapter,
+	u8					Indexforchannel
+	)
+{
+	HAL_DATA_TYPE	*pHalData = GET_HAL_DATA(Adapter);
+
+	if((pHalData->IQKMatrixRegSetting[Indexforchannel].Value[0][0] != 0)/*&&(RegEA4 != 0)*/)
+	{
+		if(pHalData->CurrentBandType92D == BAND_ON_5G)
+			phy_PathAFillIQKMatrix_5G_Normal(Adapter, _TRUE, pHalData->IQKMatrixRegSetting[Indexforchannel].Value, 0, (pHalData->IQKMatrixRegSetting[Indexforchannel].Value[0][2] == 0));
+		else
+			phy_PathAFillIQKMatrix(Adapter, _TRUE, pHalData->IQKMatrixRegSetting[Indexforchannel].Value, 0, (pHalData->IQKMatrixRegSetting[Indexforchannel].Value[0][2] == 0));
+	}
+
+	if (IS_92D_SINGLEPHY(pHalData->VersionID))
+	{
+		if((pHalData->IQKMatrixRegSetting[Indexforchannel].Value[0][4] != 0)/*&&(RegEC4 != 0)*/)
+		{
+			if(pHalData->CurrentBandType92D == BAND_ON_5G)
+				phy_PathBFillIQKMatrix_5G_Normal(Adapter, _TRUE, pHalData->IQKMatrixRegSetting[Indexforchannel].Value, 0, (pHalData->IQKMatrixRegSetting[Indexforchannel].Value[0][6] == 0));
+			else
+				phy_PathBFillIQKMatrix(Adapter, _TRUE, pHalData->IQKMatrixRegSetting[Indexforchannel].Value, 0, (pHalData->IQKMatrixRegSetting[Indexforchannel].Value[0][6] == 0));
+		}
+	}
+}
+
 /*-----------------------------------------------------------------------------
  * Function:	phy_ReloadIQKSetting
  *
@@ -3390,7 +3566,7 @@ static  VOID
 	pHalData->bLoadIMRandIQKSettingFor2G = _FALSE;
 #endif
 
-	if(pHalData->bNeedIQK && !pHalData->IQKMatrixRegSetting[Indexforchannel].bIQKDone)
+	if(pHalData->bNeedIQK && !phy_IQKResultValid(Adapter, Indexforchannel))
 	{ //Re Do IQK.
 		DBG_8192C("Do IQK Matrix reg for channel:%d....\n", channel);
 		rtl8192d_PHY_IQCalibrate(Adapter, _FALSE);
@@ -3402,24 +3578,7 @@ static  VOID
 		{
 			//DBG_8192C("Just Read IQK Matrix reg for channel:%d....\n", channel);
 
-			if((pHalData->IQKMatrixRegSetting[Indexforchannel].Value[0][0] != 0)/*&&(RegEA4 != 0)*/)
-			{
-				if(pHalData->CurrentBandType92D == BAND_ON_5G)
-					phy_PathAFillIQKMatrix_5G_Normal(Adapter, _TRUE, pHalData->IQKMatrixRegSetting[Indexforchannel].Value, 0, (pHalData->IQKMatrixRegSetting[Indexforchannel].Value[0][2] == 0));
-				else
-					phy_PathAFillIQKMatrix(Adapter, _TRUE, pHalData->IQKMatrixRegSetting[Indexforchannel].Value, 0, (pHalData->IQKMatrixRegSetting[Indexforchannel].Value[0][2] == 0));
-			}
-
-			if (IS_92D_SINGLEPHY(pHalData->VersionID))
-			{
-				if((pHalData->IQKMatrixRegSetting[Indexforchannel].Value[0][4] != 0)/*&&(RegEC4 != 0)*/)
-				{
-					if(pHalData->CurrentBandType92D == BAND_ON_5G)
-						phy_PathBFillIQKMatrix_5G_Normal(Adapter, _TRUE, pHalData->IQKMatrixRegSetting[Indexforchannel].Value, 0, (pHalData->IQKMatrixRegSetting[Indexforchannel].Value[0][6] == 0));
-					else
-						phy_PathBFillIQKMatrix(Adapter, _TRUE, pHalData->IQKMatrixRegSetting[Indexforchannel].Value, 0, (pHalData->IQKMatrixRegSetting[Indexforchannel].Value[0][6] == 0));
-				}
-			}
+			phy_LoadIQKMatrix(Adapter, Indexforchannel);
 
 			if((Adapter->mlmeextpriv.sitesurvey_res.state == SCAN_PROCESS)&&(Indexforchannel==0))
 				pHalData->bLoadIMRandIQKSettingFor2G=_TRUE;
@@ -6048,6 +6207,29 @@ phy_LCCalibrate92DSW_partial(
 	phy_ReloadLCKSetting(pAdapter, pHalData->CurrentChannel);
 }
 
+//
+// The CV curves found by a full sweep are kept in CurveIndex and follow the
+// temperature through the partial LCK, so as long as the MAC/PHY mode and band
+// are unchanged a re-init only has to hand the curves back to the RF.
+//
+static VOID
+phy_RestoreLCKSetting(
+	PADAPTER	pAdapter,
+	BOOLEAN		is2T
+	)
+{
+	HAL_DATA_TYPE	*pHalData = GET_HAL_DATA(pAdapter);
+	u8	index, path = is2T?2:1;
+
+	for(index = 0; index <path; index ++)
+	{
+		// switch CV-curve control mode
+		PHY_SetRFReg(pAdapter, (RF_RADIO_PATH_E)index, RF_SYN_G7, BIT17, 0x1);
+	}
+
+	phy_ReloadLCKSetting(pAdapter, pHalData->CurrentChannel);
+}
+
 static VOID
 phy_LCCalibrate(
 	PADAPTER	pAdapter,
@@ -6056,9 +6238,26 @@ phy_LCCalibrate(
 	)
 {
 #if SWLCK == 1
+	HAL_DATA_TYPE	*pHalData = GET_HAL_DATA(pAdapter);
+
 	//DBG_8192C("cosa PHY_LCK ver=2\n");
 	if(bInit)
-		phy_LCCalibrate92DSW(pAdapter, is2T);
+	{
+		if(pHalData->bLCKDone
+			&& pHalData->LCKMacPhyMode == pHalData->MacPhyMode92D
+			&& pHalData->LCKBandSet == pHalData->BandSet92D)
+		{
+			DBG_8192C("LCK: reuse CV curves from last calibration\n");
+			phy_RestoreLCKSetting(pAdapter, is2T);
+		}
+		else
+		{
+			phy_LCCalibrate92DSW(pAdapter, is2T);
+			pHalData->bLCKDone = _TRUE;
+			pHalData->LCKMacPhyMode = pHalData->MacPhyMode92D;
+			pHalData->LCKBandSet = pHalData->BandSet92D;
+		}
+	}
 	else
 		phy_LCCalibrate92DSW_partial(pAdapter);
 #else
@@ -6697,6 +6896,9 @@ rtl8192d_PHY_IQCalibrate(
 		}
 
 		pHalData->IQKMatrixRegSetting[Indexforchannel].bIQKDone = _TRUE;
+		pHalData->IQKMatrixRegSetting[Indexforchannel].ThermalValue = phy_IQKThermalRef(pAdapter);
+		pHalData->IQKMatrixRegSetting[Indexforchannel].MacPhyMode = pHalData->MacPhyMode92D;
+		pHalData->IQKMatrixRegSetting[Indexforchannel].ChannelBW = pHalData->CurrentChannelBW;
 
 		//RT_TRACE(COMP_SCAN|COMP_MLME,DBG_LOUD,("\nIQK OK Indexforchannel %d.\n", Indexforchannel));
 #ifdef CONFIG_CONCURRENT_MODE
@@ -6711,6 +6913,9 @@ rtl8192d_PHY_IQCalibrate(
 			}
 
 			pbuddy_HalData->IQKMatrixRegSetting[Indexforchannel].bIQKDone = _TRUE;
+			pbuddy_HalData->IQKMatrixRegSetting[Indexforchannel].ThermalValue = phy_IQKThermalRef(pbuddy_adapter);
+			pbuddy_HalData->IQKMatrixRegSetting[Indexforchannel].MacPhyMode = pbuddy_HalData->MacPhyMode92D;
+			pbuddy_HalData->IQKMatrixRegSetting[Indexforchannel].ChannelBW = pHalData->CurrentChannelBW;
 		}
 #endif
 	}
@@ -7477,6 +7682,29 @@ rtl8192d_PHY_InitRxSetting(
 }
 
 
+//
+// Load the cached IQK matrix for the current channel if it is still valid.
+// Returns _FALSE when the caller has to run IQK.
+//
+BOOLEAN
+rtl8192d_PHY_RestoreIQKResult(
+	PADAPTER Adapter
+)
+{
+	HAL_DATA_TYPE	*pHalData = GET_HAL_DATA(Adapter);
+	u8			Indexforchannel;
+
+	Indexforchannel = rtl8192d_GetRightChnlPlaceforIQK(pHalData->CurrentChannel);
+
+	if(!phy_IQKResultValid(Adapter, Indexforchannel))
+		return _FALSE;
+
+	phy_LoadIQKMatrix(Adapter, Indexforchannel);
+	DBG_871X("IQK: reuse cached result for channel %d\n", pHalData->CurrentChannel);
+
+	return _TRUE;
+}
+
 VOID
 rtl8192d_PHY_ResetIQKResult(
 	PADAPTER Adapter
@@ -555,7 +555,8 @@ static void getTxPowerWriteValByRegulatory(
 static void writeOFDMPowerReg(
 	PADAPTER	Adapter,
 	u8			index,
-	u32			*pValue
+	u8			rf,
+	u32			writeVal
 	)
 {
 	HAL_DATA_TYPE	*pHalData = GET_HAL_DATA(Adapter);
@@ -565,47 +566,42 @@ static void writeOFDMPowerReg(
 	u16	RegOffset_B[6] = {	rTxAGC_B_Rate18_06, rTxAGC_B_Rate54_24,
 							rTxAGC_B_Mcs03_Mcs00, rTxAGC_B_Mcs07_Mcs04,
 							rTxAGC_B_Mcs11_Mcs08, rTxAGC_B_Mcs15_Mcs12};
-	u8	i, rf, pwr_val[4];
-	u32	writeVal;
+	u8	i, pwr_val[4];
 	u16	RegOffset;
 
-	for(rf=0; rf<2; rf++)
+	for(i=0; i<4; i++)
 	{
-		writeVal = pValue[rf];
-		for(i=0; i<4; i++)
-		{
-			pwr_val[i] = (u8)((writeVal & (0x7f<<(i*8)))>>(i*8));
-			if (pwr_val[i]  > RF6052_MAX_TX_PWR)
-				pwr_val[i]  = RF6052_MAX_TX_PWR;
-		}
-		writeVal = (pwr_val[3]<<24) | (pwr_val[2]<<16) |(pwr_val[1]<<8) |pwr_val[0];
+		pwr_val[i] = (u8)((writeVal & (0x7f<<(i*8)))>>(i*8));
+		if (pwr_val[i]  > RF6052_MAX_TX_PWR)
+			pwr_val[i]  = RF6052_MAX_TX_PWR;
+	}
+	writeVal = (pwr_val[3]<<24) | (pwr_val[2]<<16) |(pwr_val[1]<<8) |pwr_val[0];
 
-		if(rf == 0)
-			RegOffset = RegOffset_A[index];
-		else
-			RegOffset = RegOffset_B[index];
-		PHY_SetBBReg(Adapter, RegOffset, bMaskDWord, writeVal);
-		//RTPRINT(FPHY, PHY_TXPWR, ("Set 0x%x = %08x\n", RegOffset, writeVal));
-
-		// 201005115 Joseph: Set Tx Power diff for Tx power training mechanism.
-		if(((pHalData->rf_type == RF_2T2R) &&
-				(RegOffset == rTxAGC_A_Mcs15_Mcs12 || RegOffset == rTxAGC_B_Mcs15_Mcs12))||
-		     ((pHalData->rf_type != RF_2T2R) &&
-				(RegOffset == rTxAGC_A_Mcs07_Mcs04 || RegOffset == rTxAGC_B_Mcs07_Mcs04))	)
+	if(rf == 0)
+		RegOffset = RegOffset_A[index];
+	else
+		RegOffset = RegOffset_B[index];
+	PHY_SetBBReg(Adapter, RegOffset, bMaskDWord, writeVal);
+	//RTPRINT(FPHY, PHY_TXPWR, ("Set 0x%x = %08x\n", RegOffset, writeVal));
+
+	// 201005115 Joseph: Set Tx Power diff for Tx power training mechanism.
+	if(((pHalData->rf_type == RF_2T2R) &&
+			(RegOffset == rTxAGC_A_Mcs15_Mcs12 || RegOffset == rTxAGC_B_Mcs15_Mcs12))||
+	     ((pHalData->rf_type != RF_2T2R) &&
+			(RegOffset == rTxAGC_A_Mcs07_Mcs04 || RegOffset == rTxAGC_B_Mcs07_Mcs04))	)
+	{
+		writeVal = pwr_val[3];
+		if(RegOffset == rTxAGC_A_Mcs15_Mcs12 || RegOffset == rTxAGC_A_Mcs07_Mcs04)
+			RegOffset = 0xc90;
+		if(RegOffset == rTxAGC_B_Mcs15_Mcs12 || RegOffset == rTxAGC_B_Mcs07_Mcs04)
+			RegOffset = 0xc98;
+		for(i=0; i<3; i++)
 		{
-			writeVal = pwr_val[3];
-			if(RegOffset == rTxAGC_A_Mcs15_Mcs12 || RegOffset == rTxAGC_A_Mcs07_Mcs04)
-				RegOffset = 0xc90;
-			if(RegOffset == rTxAGC_B_Mcs15_Mcs12 || RegOffset == rTxAGC_B_Mcs07_Mcs04)
-				RegOffset = 0xc98;
-			for(i=0; i<3; i++)
-			{
-				if(i!=2)
-					writeVal = (writeVal>8)?(writeVal-8):0;
-				else
-					writeVal = (writeVal>6)?(writeVal-6):0;
-				rtw_write8(Adapter, (u32)(RegOffset+i), (u8)writeVal);
-			}
+			if(i!=2)
+				writeVal = (writeVal>8)?(writeVal-8):0;
+			else
+				writeVal = (writeVal>6)?(writeVal-6):0;
+			rtw_write8(Adapter, (u32)(RegOffset+i), (u8)writeVal);
 		}
 	}
 }
@@ -637,8 +633,8 @@ rtl8192d_PHY_RF6052SetOFDMTxPower(
 	u8*		pPowerLevel,
 	u8		Channel)
 {
-	u32	writeVal[2], powerBase0[2], powerBase1[2];
-	u8	index = 0;
+	u32	writeVal[6][2], powerBase0[2], powerBase1[2];
+	u8	index = 0, rf;
 
 	//DBG_871X("PHY_RF6052SetOFDMTxPower, channel(%d) \n", Channel);
 
@@ -647,9 +643,15 @@ rtl8192d_PHY_RF6052SetOFDMTxPower(
 	for(index=0; index<6; index++)
 	{
 		getTxPowerWriteValByRegulatory(Adapter, pPowerLevel, Channel, index,
-			&powerBase0[0], &powerBase1[0], &writeVal[0]);
+			&powerBase0[0], &powerBase1[0], &writeVal[index][0]);
+	}
 
-		writeOFDMPowerReg(Adapter, index, &writeVal[0]);
+	// Write path by path so each path's rate registers are address-contiguous
+	// and can share one vendor request under rtw_io_batch_begin().
+	for(rf=0; rf<2; rf++)
+	{
+		for(index=0; index<6; index++)
+			writeOFDMPowerReg(Adapter, index, rf, writeVal[index][rf]);
 	}
 }
 
@@ -68,8 +68,40 @@ int	rtl8192du_init_recv_priv(_adapter *padapter)
 	     (unsigned long)padapter);
 
 	_rtw_init_queue(&precvpriv->recv_buf_pending_queue);
+
+#ifdef CONFIG_RTW_NAPI
+	skb_queue_head_init(&precvpriv->rx_napi_skb_queue);
+	// only the primary adapter owns the bulk-in pipe, the others indicate through its poll
+	if (padapter->registrypriv.en_napi && is_primary_adapter(padapter) && padapter->pnetdev) {
+	#if (LINUX_VERSION_CODE >= KERNEL_VERSION(6, 1, 0))
+		netif_napi_add_weight(padapter->pnetdev, &precvpriv->napi, rtl8192du_recv_napi_poll, RTL8192DU_NAPI_WEIGHT);
+	#else
+		netif_napi_add(padapter->pnetdev, &precvpriv->napi, rtl8192du_recv_napi_poll, RTL8192DU_NAPI_WEIGHT);
+	#endif
+		napi_enable(&precvpriv->napi);
+		precvpriv->napi_en = _TRUE;
+		precvpriv->gro_en = padapter->registrypriv.en_gro ? _TRUE : _FALSE;
+	}
+#endif
 #endif	// PLATFORM_LINUX
 
+#ifdef CONFIG_USB_RX_AGG_TUNE
+	_rtw_memset(&precvpriv->rx_agg_tune, 0, sizeof(struct rx_agg_tune));
+	precvpriv->rx_agg_tune.level = RX_AGG_LVL_BULK;
+	precvpriv->rx_agg_tune.target = RX_AGG_LVL_BULK;
+	precvpriv->rx_agg_tune.fixed = -1;
+#endif
+
+#ifdef CONFIG_USB_RX_URB_SCALE
+	_rtw_memset(&precvpriv->rx_urb_scale, 0, sizeof(struct rx_urb_scale));
+	precvpriv->rx_urb_scale.depth_max = NR_RECVBUFF;
+	precvpriv->rx_urb_scale.depth_fixed = padapter->registrypriv.rx_urb_num;
+	if (precvpriv->rx_urb_scale.depth_fixed > NR_RECVBUFF)
+		precvpriv->rx_urb_scale.depth_fixed = NR_RECVBUFF;
+	precvpriv->rx_urb_scale.depth = precvpriv->rx_urb_scale.depth_fixed ? precvpriv->rx_urb_scale.depth_fixed : NR_RECVBUFF_MIN;
+	precvpriv->rx_urb_scale.skb_pool = NR_PREALLOC_RECV_SKB;
+#endif
+
 #ifdef CONFIG_USB_INTERRUPT_IN_PIPE
 
 #ifdef PLATFORM_LINUX
@@ -198,6 +230,16 @@ void rtl8192du_free_recv_priv (_adapter *padapter)
 
 #ifdef PLATFORM_LINUX
 
+#ifdef CONFIG_RTW_NAPI
+	if (precvpriv->napi_en) {
+		napi_disable(&precvpriv->napi);
+		netif_napi_del(&precvpriv->napi);
+		precvpriv->napi_en = _FALSE;
+	}
+
+	rtw_skb_queue_purge(&precvpriv->rx_napi_skb_queue);
+#endif
+
 	if (skb_queue_len(&precvpriv->rx_skb_queue)) {
 		DBG_8192C(KERN_WARNING "rx_skb_queue not empty\n");
 	}
@@ -216,3 +258,101 @@ void rtl8192du_free_recv_priv (_adapter *padapter)
 
 #endif // PLATFORM_LINUX
 }
+
+#ifdef CONFIG_USB_RX_URB_SCALE
+#define RX_URB_IDLE_TH		16	// idle gaps per watchdog period that ask for more URBs
+#define RX_URB_GROW_STEP	2
+#define RX_URB_QUIET_HOLD	15	// quiet periods before one URB is given back
+
+//
+// Called from the DM watchdog. The number of bulk-in URBs kept posted grows when the
+// pipe was seen without any posted URB or the RX FIFO overflowed, and shrinks back
+// slowly once neither happens. Surplus URBs are parked by usb_read_port_complete().
+//
+void rtl8192du_rx_urb_scale(_adapter *padapter)
+{
+	struct recv_priv *precvpriv = &padapter->recvpriv;
+	struct rx_urb_scale *pscale = &precvpriv->rx_urb_scale;
+	struct debug_priv *pdbgpriv = &adapter_to_dvobj(padapter)->drv_dbg;
+	struct recv_buf *precvbuf;
+	struct sk_buff *pskb;
+	SIZE_PTR tmpaddr, alignment;
+	u8 ovf_hit, depth;
+	u16 pool;
+	u32 idle;
+
+	idle = pscale->idle_cnt - pscale->last_idle_cnt;
+	pscale->last_idle_cnt = pscale->idle_cnt;
+
+	ovf_hit = (pdbgpriv->dbg_rx_fifo_curr_overflow != pscale->last_fifo_ovf) ? _TRUE : _FALSE;
+	pscale->last_fifo_ovf = pdbgpriv->dbg_rx_fifo_curr_overflow;
+	if (ovf_hit)
+		pscale->fifo_ovf_cnt++;
+
+	depth = pscale->depth;
+	if (pscale->depth_fixed) {
+		depth = pscale->depth_fixed;
+	} else if (ovf_hit || idle >= RX_URB_IDLE_TH) {
+		pscale->quiet_cnt = 0;
+		depth += RX_URB_GROW_STEP;
+		if (depth > pscale->depth_max)
+			depth = pscale->depth_max;
+	} else if (idle) {
+		pscale->quiet_cnt = 0;
+	} else if (++pscale->quiet_cnt >= RX_URB_QUIET_HOLD) {
+		pscale->quiet_cnt = 0;
+		if (depth > NR_RECVBUFF_MIN)
+			depth--;
+	}
+
+	if (depth > pscale->depth)
+		pscale->grow_cnt++;
+	else if (depth < pscale->depth)
+		pscale->shrink_cnt++;
+	pscale->depth = depth;
+
+	pool = pscale->skb_pool_fixed;
+	if (pool == 0)
+		pool = (depth * 2 > NR_PREALLOC_RECV_SKB) ? depth * 2 : NR_PREALLOC_RECV_SKB;
+	if (pool > NR_PREALLOC_RECV_SKB_MAX)
+		pool = NR_PREALLOC_RECV_SKB_MAX;
+	pscale->skb_pool = pool;
+
+	if (padapter->bDriverStopped || padapter->bSurpriseRemoved || padapter->bReadPortCancel)
+		return;
+
+	// top up the spare skbs here, in process context, so completions don't have to allocate
+	while (skb_queue_len(&precvpriv->free_recv_skb_queue) < pool) {
+		pskb = rtw_skb_alloc(MAX_RECVBUF_SZ + RECVBUFF_ALIGN_SZ);
+		if (pskb == NULL)
+			break;
+
+		pskb->dev = padapter->pnetdev;
+
+		tmpaddr = (SIZE_PTR)pskb->data;
+		alignment = tmpaddr & (RECVBUFF_ALIGN_SZ-1);
+		skb_reserve(pskb, (RECVBUFF_ALIGN_SZ - alignment));
+
+		skb_queue_tail(&precvpriv->free_recv_skb_queue, pskb);
+	}
+
+	// retry buffers a completion couldn't find an skb for, then post up to depth
+	while (NULL != (precvbuf = rtw_dequeue_recvbuf(&precvpriv->recv_buf_pending_queue))) {
+		precvbuf->pskb = NULL;
+		precvbuf->reuse = _FALSE;
+		if (rtw_read_port(padapter, precvpriv->ff_hwaddr, 0, (unsigned char *)precvbuf) == _FAIL)
+			break;
+	}
+
+	while (ATOMIC_READ(&precvpriv->rx_pending_cnt) < depth) {
+		precvbuf = rtw_dequeue_recvbuf(&precvpriv->free_recv_buf_queue);
+		if (precvbuf == NULL)
+			break;
+
+		precvbuf->pskb = NULL;
+		precvbuf->reuse = _FALSE;
+		if (rtw_read_port(padapter, precvpriv->ff_hwaddr, 0, (unsigned char *)precvbuf) == _FAIL)
+			break;
+	}
+}
+#endif //CONFIG_USB_RX_URB_SCALE
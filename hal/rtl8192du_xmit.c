@@ -38,6 +38,27 @@ s32	rtl8192du_init_xmit_priv(_adapter *padapter)
 	     (unsigned long)padapter);
 #endif
 
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+	{
+		int i;
+
+		for (i = VO_QUEUE_INX; i <= BK_QUEUE_INX; i++) {
+			struct tx_agg_ctrl *pctrl = &pxmitpriv->tx_agg_ctrl[i];
+
+			_rtw_memset(pctrl, 0, sizeof(*pctrl));
+			// voice and video start from a small aggregate, best effort and background from the full buffer
+			pctrl->max_len = (i <= VI_QUEUE_INX) ? TX_AGG_LEN_STEP : MAX_XMITBUF_SZ;
+			pctrl->max_desc = (i <= VI_QUEUE_INX) ? 1 : BLK_DESC_NUM_MASK;
+		}
+		rtw_tx_agg_set_budget(padapter, padapter->registrypriv.tx_agg_budget);
+	}
+#endif
+
+#ifdef CONFIG_USB_TX_SG
+	pxmitpriv->tx_sg_en = rtw_os_xmit_sg_supported(padapter);
+	DBG_871X("%s: tx_sg_en=%u\n", __func__, pxmitpriv->tx_sg_en);
+#endif
+
 	return _SUCCESS;
 }
 
@@ -259,6 +280,9 @@ static s32 update_txdesc(struct xmit_frame *pxmitframe, u8 *pmem, s32 sz, u8 bag
 	struct wifidirect_info	*pwdinfo = &padapter->wdinfo;
 	struct registry_priv	*pregistrypriv = &padapter->registrypriv;
 #endif //CONFIG_P2P
+#ifdef CONFIG_TX_TMPL_CACHE
+	struct tx_tmpl		*ptmpl = NULL;
+#endif
 
 
 #ifndef CONFIG_USE_USB_BUFFER_ALLOC_TX
@@ -282,15 +306,31 @@ if (padapter->registrypriv.mp_mode == 0)
 	{
 		//DBG_8192C("pxmitframe->frame_tag == DATA_FRAMETAG\n");
 
-		//offset 4
-		ptxdesc->txdw1 |= cpu_to_le32(pattrib->mac_id&0x1f);
+#ifdef CONFIG_TX_TMPL_CACHE
+		ptmpl = rtw_tx_tmpl_get(padapter, pattrib);
+		if (ptmpl && ptmpl->txdesc_valid)
+		{
+			// MACID, RAID and sectype only: QSEL differs per frame (bc/mc moved to HIQ)
+			ptxdesc->txdw1 = ptmpl->txdw1;
+		}
+		else
+#endif
+		{
+			//offset 4
+			ptxdesc->txdw1 |= cpu_to_le32(pattrib->mac_id&0x1f);
 
-		qsel = (uint)(pattrib->qsel & 0x0000001f);
-		ptxdesc->txdw1 |= cpu_to_le32((qsel << QSEL_SHT) & 0x00001f00);
+			ptxdesc->txdw1 |= cpu_to_le32((pattrib->raid<< 16) & 0x000f0000);
 
-		ptxdesc->txdw1 |= cpu_to_le32((pattrib->raid<< 16) & 0x000f0000);
+			fill_txdesc_sectype(pattrib, ptxdesc);
+
+#ifdef CONFIG_TX_TMPL_CACHE
+			if (ptmpl)
+				ptmpl->txdw1 = ptxdesc->txdw1;
+#endif
+		}
 
-		fill_txdesc_sectype(pattrib, ptxdesc);
+		qsel = (uint)(pattrib->qsel & 0x0000001f);
+		ptxdesc->txdw1 |= cpu_to_le32((qsel << QSEL_SHT) & 0x00001f00);
 
 		if(pattrib->ampdu_en==_TRUE){
 			ptxdesc->txdw1 |= cpu_to_le32(BIT(5));//AGG EN
@@ -322,11 +362,32 @@ if (padapter->registrypriv.mp_mode == 0)
 		{
 		//Non EAP & ARP & DHCP type data packet
 
-			fill_txdesc_vcs(pattrib, &ptxdesc->txdw4);
-			fill_txdesc_phy(pattrib, &ptxdesc->txdw4);
+#ifdef CONFIG_TX_TMPL_CACHE
+			if (ptmpl && ptmpl->txdesc_valid)
+			{
+				ptxdesc->txdw4 = ptmpl->txdw4;
+				ptxdesc->txdw5 = ptmpl->txdw5;
+			}
+			else
+#endif
+			{
+				fill_txdesc_phy(pattrib, &ptxdesc->txdw4);
+
+				ptxdesc->txdw4 |= cpu_to_le32(0x00000008);//RTS Rate=24M
+				ptxdesc->txdw5 |= cpu_to_le32(0x0001ff00);//
+
+#ifdef CONFIG_TX_TMPL_CACHE
+				if (ptmpl)
+				{
+					ptmpl->txdw4 = ptxdesc->txdw4;
+					ptmpl->txdw5 = ptxdesc->txdw5;
+					ptmpl->txdesc_valid = _TRUE;
+				}
+#endif
+			}
 
-			ptxdesc->txdw4 |= cpu_to_le32(0x00000008);//RTS Rate=24M
-			ptxdesc->txdw5 |= cpu_to_le32(0x0001ff00);//
+			// protection follows the current medium state, never cached
+			fill_txdesc_vcs(pattrib, &ptxdesc->txdw4);
 
 			//use REG_INIDATA_RATE_SEL value
 			data_rate = pdmpriv->INIDATA_RATE[pattrib->mac_id];
@@ -553,6 +614,10 @@ static s32 rtw_dump_xframe(_adapter *padapter, struct xmit_frame *pxmitframe)
 
 	mem_addr = pxmitframe->buf_addr;
 
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+	pxmitbuf->agg_stop = TX_AGG_STOP_NONE;
+#endif
+
        RT_TRACE(_module_rtl871x_xmit_c_,_drv_info_,("rtw_dump_xframe()\n"));
 
 	for (t = 0; t < pattrib->nr_frags; t++)
@@ -667,6 +732,58 @@ void UpdateEarlyModeInfo8192D(_adapter *padapter, struct xmit_frame *pxmitframe,
 
 }
 
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+/*
+ * Called on every bulk-out completion of a data queue. Over budget the size
+ * limit is cut by a quarter and one descriptor per bulk is taken away; under
+ * budget with frames still queued on the AC and the last aggregate closed by
+ * a limit, the limit grows by one step.
+ */
+void rtl8192du_tx_agg_update(_adapter *padapter, u8 qidx, u32 lat_us, u8 agg_stop)
+{
+	HAL_DATA_TYPE *pHalData = GET_HAL_DATA(padapter);
+	struct xmit_priv *pxmitpriv = &padapter->xmitpriv;
+	struct tx_agg_ctrl *pctrl;
+	u32 hw_max_len;
+
+	if (qidx > BK_QUEUE_INX)
+		return;
+
+	pctrl = &pxmitpriv->tx_agg_ctrl[qidx];
+	hw_max_len = (pHalData->MacPhyMode92D == SINGLEMAC_SINGLEPHY) ? MAX_XMITBUF_SZ : 0x3D00;
+
+	pctrl->urb_cnt++;
+	if (pctrl->lat_us == 0)
+		pctrl->lat_us = lat_us;
+	else
+		pctrl->lat_us = (pctrl->lat_us * 7 + lat_us) >> 3;
+
+	if (pctrl->lat_us > pctrl->budget_us)
+	{
+		if (pctrl->max_len > TX_AGG_LEN_STEP || pctrl->max_desc > 1)
+			pctrl->shrink_cnt++;
+
+		pctrl->max_len -= pctrl->max_len >> 2;
+		if (pctrl->max_len < TX_AGG_LEN_STEP)
+			pctrl->max_len = TX_AGG_LEN_STEP;
+		if (pctrl->max_desc > 1)
+			pctrl->max_desc--;
+	}
+	else if (agg_stop != TX_AGG_STOP_NONE && pxmitpriv->hwxmits[qidx].accnt > 0)
+	{
+		if (agg_stop == TX_AGG_STOP_LEN && pctrl->max_len < hw_max_len) {
+			pctrl->max_len += TX_AGG_LEN_STEP;
+			if (pctrl->max_len > hw_max_len)
+				pctrl->max_len = hw_max_len;
+			pctrl->grow_cnt++;
+		} else if (agg_stop == TX_AGG_STOP_DESC && pctrl->max_desc < pHalData->UsbTxAggDescNum) {
+			pctrl->max_desc++;
+			pctrl->grow_cnt++;
+		}
+	}
+}
+#endif //CONFIG_USB_TX_AGG_ADAPTIVE
+
 #define IDEA_CONDITION 1	// check all packets before enqueue
 s32 rtl8192du_xmitframe_complete(_adapter *padapter, struct xmit_priv *pxmitpriv, struct xmit_buf *pxmitbuf)
 {
@@ -688,6 +805,10 @@ s32 rtl8192du_xmitframe_complete(_adapter *padapter, struct xmit_priv *pxmitpriv
 	u32	bulkSize = pHalData->UsbBulkOutSize;
 	u32	bulkPtr=0;
 	u8	descCount=0;
+	u8	aggDescNum = pHalData->UsbTxAggDescNum;
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+	u8	agg_stop = TX_AGG_STOP_NONE;
+#endif
 	u8	ac_index;
 	u8	bfirst = _TRUE;//first aggregation xmitframe
 	u8	bulkstart = _FALSE;
@@ -735,6 +856,13 @@ s32 rtl8192du_xmitframe_complete(_adapter *padapter, struct xmit_priv *pxmitpriv
 			_enter_critical_bh(&pxmitpriv->lock, &irqL);
 			ptxservq = rtw_get_sta_pending(padapter, pfirstframe->attrib.psta, pfirstframe->attrib.priority, (u8 *)(&ac_index));
 			_exit_critical_bh(&pxmitpriv->lock, &irqL);
+
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+			if (aggMaxLength > pxmitpriv->tx_agg_ctrl[ac_index].max_len)
+				aggMaxLength = pxmitpriv->tx_agg_ctrl[ac_index].max_len;
+			if (aggDescNum > pxmitpriv->tx_agg_ctrl[ac_index].max_desc)
+				aggDescNum = pxmitpriv->tx_agg_ctrl[ac_index].max_desc;
+#endif
 		}
 		//3 2. aggregate same priority and same DA(AP or STA) frames
 		else
@@ -762,6 +890,9 @@ s32 rtl8192du_xmitframe_complete(_adapter *padapter, struct xmit_priv *pxmitpriv
 					if (pbuf + _RND8(len) > aggMaxLength)
 					{
 						bulkstart = _TRUE;
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+						agg_stop = TX_AGG_STOP_LEN;
+#endif
 					}
 					else
 					{
@@ -839,8 +970,12 @@ s32 rtl8192du_xmitframe_complete(_adapter *padapter, struct xmit_priv *pxmitpriv
 		if (pbuf < bulkPtr)
 		{
 			descCount++;
-			if (descCount == pHalData->UsbTxAggDescNum)
+			if (descCount >= aggDescNum) {
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+				agg_stop = TX_AGG_STOP_DESC;
+#endif
 				break;
+			}
 		}
 		else
 		{
@@ -872,6 +1007,15 @@ s32 rtl8192du_xmitframe_complete(_adapter *padapter, struct xmit_priv *pxmitpriv
 	//3 4. write xmit buffer to USB FIFO
 	ff_hwaddr = rtw_get_ff_hwaddr(pfirstframe);
 
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+	pxmitbuf->agg_stop = agg_stop;
+	if (agg_stop == TX_AGG_STOP_LEN)
+		pxmitpriv->tx_agg_ctrl[ac_index].len_stop_cnt++;
+	else if (agg_stop == TX_AGG_STOP_DESC)
+		pxmitpriv->tx_agg_ctrl[ac_index].desc_stop_cnt++;
+	pxmitpriv->tx_agg_ctrl[ac_index].pkt_cnt += pfirstframe->agg_num;
+#endif
+
 	// xmit address == ((xmit_frame*)pxmitbuf->priv_data)->buf_addr
 	rtw_write_port(padapter, ff_hwaddr, pbuf_tail, (u8*)pxmitbuf);
 
@@ -288,11 +288,31 @@ static BOOLEAN HalUsbSetQueuePipeMapping8192DUsb(
 
 }
 
+#ifdef CONFIG_IO_SHADOW
+// Registers rewritten by the DM watchdog on every tick, mostly with the
+// value they already hold. None of them is changed by the hardware.
+static const u32 io_shadow_regs_8192du[] = {
+	REG_EDCA_VO_PARAM, REG_EDCA_VI_PARAM, REG_EDCA_BE_PARAM, REG_EDCA_BK_PARAM,
+	rCCK0_CCA, rOFDM0_XAAGCCore1, rOFDM0_XBAGCCore1, 0xc90, 0xc98,
+	rTxAGC_A_Rate18_06, rTxAGC_A_Rate54_24, rTxAGC_A_CCK1_Mcs32,
+	rTxAGC_A_Mcs03_Mcs00, rTxAGC_A_Mcs07_Mcs04, rTxAGC_A_Mcs11_Mcs08, rTxAGC_A_Mcs15_Mcs12,
+	rTxAGC_B_Rate18_06, rTxAGC_B_Rate54_24, rTxAGC_B_CCK1_55_Mcs32,
+	rTxAGC_B_Mcs03_Mcs00, rTxAGC_B_Mcs07_Mcs04, rTxAGC_B_Mcs11_Mcs08, rTxAGC_B_Mcs15_Mcs12,
+	rTxAGC_B_CCK11_A_CCK2_11,
+};
+#endif //CONFIG_IO_SHADOW
+
 void rtl8192du_interface_configure(_adapter *padapter);
 void rtl8192du_interface_configure(_adapter *padapter)
 {
 	HAL_DATA_TYPE	*pHalData	= GET_HAL_DATA(padapter);
 	struct dvobj_priv	*pdvobjpriv = adapter_to_dvobj(padapter);
+#ifdef CONFIG_IO_SHADOW
+	int	i;
+
+	for (i = 0; i < sizeof(io_shadow_regs_8192du) / sizeof(u32); i++)
+		rtw_io_shadow_add(padapter, io_shadow_regs_8192du[i]);
+#endif
 
 	if (pdvobjpriv->ishighspeed == _TRUE)
 	{
@@ -307,7 +327,7 @@ void rtl8192du_interface_configure(_adapter *padapter)
 	pHalData->RtBulkInPipe = pdvobjpriv->ep_num[0];
 	pHalData->RtBulkOutPipe[0] = pdvobjpriv->ep_num[1];
 	pHalData->RtBulkOutPipe[1] = pdvobjpriv->ep_num[2];
-	pHalData->RtIntInPipe = pdvobjpriv->ep_num[3];
+	pHalData->RtIntInPipe = pdvobjpriv->int_in_ep;
 	pHalData->RtBulkOutPipe[2] = pdvobjpriv->ep_num[4];
 	//DBG_8192C("Bulk In = %x, Bulk Out = %x %x %x\n",pHalData->RtBulkInPipe, pHalData->RtBulkOutPipe[0],pHalData->RtBulkOutPipe[1],pHalData->RtBulkOutPipe[2]);
 #ifdef CONFIG_USB_TX_AGGREGATION
@@ -1482,11 +1502,127 @@ _InitUsbAggregationSetting(
 			break;
 	}
 
+#ifdef CONFIG_USB_RX_AGG_TUNE
+	// the registers now hold the init setting
+	Adapter->recvpriv.rx_agg_tune.level = RX_AGG_LVL_BULK;
+	Adapter->recvpriv.rx_agg_tune.target_cnt = 0;
+	Adapter->recvpriv.rx_agg_tune.last_time = 0;
+	if (Adapter->recvpriv.rx_agg_tune.fixed >= 0)
+		rtl8192du_rx_agg_set_level(Adapter, Adapter->recvpriv.rx_agg_tune.fixed);
+#endif
 }
 #endif
 
 }
 
+#ifdef CONFIG_USB_RX_AGG_TUNE
+#define RX_AGG_BULK_PPS		1000	// RX frames per second to enter RX_AGG_LVL_BULK
+#define RX_AGG_BULK_SZ		1000	// average RX frame size to enter RX_AGG_LVL_BULK
+#define RX_AGG_IDLE_PPS		50	// below this every frame is handed up right away
+#define RX_AGG_SMALL_SZ		300	// average frame size of VoIP/interactive traffic
+#define RX_AGG_SMALL_PPS	300	// small frames above this rate (e.g. TCP ACKs of an upload) still aggregate
+#define RX_AGG_HOLD		2	// periods a new level must be asked for before it is applied
+
+static u8 rx_agg_level_page_th(_adapter *Adapter, u8 level)
+{
+	HAL_DATA_TYPE	*pHalData = GET_HAL_DATA(Adapter);
+
+	switch (level) {
+	case RX_AGG_LVL_LATENCY:
+		return 1;	// TH=1 invalidates RX DMA aggregation
+	case RX_AGG_LVL_MID:
+		return (pHalData->UsbRxAggPageCount >> 2) > 2 ? (pHalData->UsbRxAggPageCount >> 2) : 2;
+	case RX_AGG_LVL_BULK:
+	default:
+		return pHalData->UsbRxAggPageCount;
+	}
+}
+
+void rtl8192du_rx_agg_set_level(_adapter *Adapter, u8 level)
+{
+	struct rx_agg_tune *ptune = &Adapter->recvpriv.rx_agg_tune;
+	struct rx_agg_hist *phist;
+
+	if (level >= RX_AGG_LVL_NUM)
+		return;
+
+	phist = &ptune->hist[ptune->hist_idx];
+	phist->time = rtw_get_current_time();
+	phist->from = ptune->level;
+	phist->to = level;
+	phist->pps = ptune->pps;
+	phist->avg_sz = ptune->avg_sz;
+	ptune->hist_idx = (ptune->hist_idx + 1) % RX_AGG_HIST_NUM;
+	ptune->change_cnt++;
+
+	ptune->level = level;
+	ptune->target = level;
+	ptune->target_cnt = 0;
+
+	if (!ptune->force_off)
+		rtw_write8(Adapter, REG_RXDMA_AGG_PG_TH, rx_agg_level_page_th(Adapter, level));
+}
+
+/*
+ * Called from the DM watchdog. Bulk transfers get the init (largest)
+ * threshold, sparse traffic or small frames at a low rate get none,
+ * everything in between a quarter of it. A level must be asked for
+ * RX_AGG_HOLD periods in a row before it is programmed, and BULK is only
+ * left once the rate falls under 3/4 of its entry thresholds.
+ */
+void rtl8192du_rx_agg_tune(_adapter *Adapter)
+{
+	struct recv_priv *precvpriv = &Adapter->recvpriv;
+	struct rx_agg_tune *ptune = &precvpriv->rx_agg_tune;
+	u32 now = rtw_get_current_time();
+	u64 pkts, bytes;
+	s32 ms;
+	u8 target;
+
+	if (ptune->last_time == 0)
+		goto record;
+
+	ms = rtw_get_time_interval_ms(ptune->last_time, now);
+	if (ms <= 0)
+		goto record;
+
+	pkts = precvpriv->rx_pkts - ptune->last_pkts;
+	bytes = precvpriv->rx_bytes - ptune->last_bytes;
+	ptune->pps = (u32)rtw_division64(pkts * 1000, ms);
+	ptune->avg_sz = pkts ? (u32)rtw_division64(bytes, pkts) : 0;
+
+	if (ptune->fixed >= 0 || ptune->force_off)
+		goto record;
+
+	if (ptune->pps >= RX_AGG_BULK_PPS && ptune->avg_sz >= RX_AGG_BULK_SZ)
+		target = RX_AGG_LVL_BULK;
+	else if (ptune->pps < RX_AGG_IDLE_PPS
+		|| (ptune->avg_sz < RX_AGG_SMALL_SZ && ptune->pps < RX_AGG_SMALL_PPS))
+		target = RX_AGG_LVL_LATENCY;
+	else
+		target = RX_AGG_LVL_MID;
+
+	if (ptune->level == RX_AGG_LVL_BULK && target == RX_AGG_LVL_MID
+		&& ptune->pps >= RX_AGG_BULK_PPS * 3 / 4 && ptune->avg_sz >= RX_AGG_BULK_SZ * 3 / 4)
+		target = RX_AGG_LVL_BULK;
+
+	if (target == ptune->level) {
+		ptune->target = target;
+		ptune->target_cnt = 0;
+	} else if (target != ptune->target) {
+		ptune->target = target;
+		ptune->target_cnt = 1;
+	} else if (++ptune->target_cnt >= RX_AGG_HOLD) {
+		rtl8192du_rx_agg_set_level(Adapter, target);
+	}
+
+record:
+	ptune->last_time = now;
+	ptune->last_pkts = precvpriv->rx_pkts;
+	ptune->last_bytes = precvpriv->rx_bytes;
+}
+#endif //CONFIG_USB_RX_AGG_TUNE
+
 
 static VOID
 _InitOperationMode(
@@ -1783,6 +1919,7 @@ u32 rtl8192du_hal_init(_adapter *padapter)
 	PADAPTER	BuddyAdapter = padapter->pbuddy_adapter;
 #endif
 	u32 init_start_time = rtw_get_current_time();
+	u32 init_vendor_req_cnt = padapter->iopriv.vendor_req_cnt;
 
 
 #ifdef DBG_HAL_INIT_PROFILING
@@ -1834,11 +1971,17 @@ u32 rtl8192du_hal_init(_adapter *padapter)
 
 	int hal_init_profiling_i;
 	u32 hal_init_stages_timestamp[HAL_INIT_STAGES_NUM]; //used to record the time of each stage's starting point
+	u32 hal_init_stages_vendor_req[HAL_INIT_STAGES_NUM]; //vendor request count at each stage's starting point
 
-	for(hal_init_profiling_i=0;hal_init_profiling_i<HAL_INIT_STAGES_NUM;hal_init_profiling_i++)
+	for(hal_init_profiling_i=0;hal_init_profiling_i<HAL_INIT_STAGES_NUM;hal_init_profiling_i++) {
 		hal_init_stages_timestamp[hal_init_profiling_i]=0;
+		hal_init_stages_vendor_req[hal_init_profiling_i]=0;
+	}
 
-	#define HAL_INIT_PROFILE_TAG(stage) hal_init_stages_timestamp[(stage)]=rtw_get_current_time();
+	#define HAL_INIT_PROFILE_TAG(stage) do { \
+		hal_init_stages_timestamp[(stage)]=rtw_get_current_time(); \
+		hal_init_stages_vendor_req[(stage)]=padapter->iopriv.vendor_req_cnt; \
+	} while(0)
 #else
 	#define HAL_INIT_PROFILE_TAG(stage) do {} while(0)
 #endif //DBG_HAL_INIT_PROFILING
@@ -1847,6 +1990,9 @@ _func_enter_;
 HAL_INIT_PROFILE_TAG(HAL_INIT_STAGES_BEGIN);
 	padapter->init_adpt_in_progress = _TRUE;
 
+	// registers are back at their power-on defaults
+	rtw_io_shadow_invalidate(padapter);
+
 #ifdef CONFIG_DUALMAC_CONCURRENT
 	if(BuddyAdapter != NULL)
 	{
@@ -2250,7 +2396,9 @@ HAL_INIT_PROFILE_TAG(HAL_INIT_STAGES_MISC11);
 
 HAL_INIT_PROFILE_TAG(HAL_INIT_STAGES_IQK);
 		// do IQK for 2.4G for better scan result, if current bandtype is 2.4G.
-		if(pHalData->CurrentBandType92D == BAND_ON_2_4G)
+		// A result cached under the same conditions is loaded instead.
+		if(pHalData->CurrentBandType92D == BAND_ON_2_4G
+			&& rtl8192d_PHY_RestoreIQKResult(padapter) == _FALSE)
 			rtl8192d_PHY_IQCalibrate(padapter, _FALSE);
 
 HAL_INIT_PROFILE_TAG(HAL_INIT_STAGES_PW_TRACK);
@@ -2365,17 +2513,22 @@ exit:
 
 HAL_INIT_PROFILE_TAG(HAL_INIT_STAGES_END);
 
-	DBG_871X("%s in %dms\n", __FUNCTION__, rtw_get_passing_time_ms(init_start_time));
+	padapter->iopriv.init_time_ms = rtw_get_passing_time_ms(init_start_time);
+	padapter->iopriv.init_vendor_req_cnt = padapter->iopriv.vendor_req_cnt - init_vendor_req_cnt;
+	DBG_871X("%s in %dms, %u vendor requests\n", __FUNCTION__
+		, padapter->iopriv.init_time_ms, padapter->iopriv.init_vendor_req_cnt);
 
 	#ifdef DBG_HAL_INIT_PROFILING
 	hal_init_stages_timestamp[HAL_INIT_STAGES_END]=rtw_get_current_time();
+	hal_init_stages_vendor_req[HAL_INIT_STAGES_END]=padapter->iopriv.vendor_req_cnt;
 
 	for(hal_init_profiling_i=0;hal_init_profiling_i<HAL_INIT_STAGES_NUM-1;hal_init_profiling_i++) {
-		DBG_871X("DBG_HAL_INIT_PROFILING: %35s, %u, %5u, %5u\n"
+		DBG_871X("DBG_HAL_INIT_PROFILING: %35s, %u, %5u, %5u, %5u\n"
 			, hal_init_stages_str[hal_init_profiling_i]
 			, hal_init_stages_timestamp[hal_init_profiling_i]
 			, (hal_init_stages_timestamp[hal_init_profiling_i+1]-hal_init_stages_timestamp[hal_init_profiling_i])
 			, rtw_get_time_interval_ms(hal_init_stages_timestamp[hal_init_profiling_i], hal_init_stages_timestamp[hal_init_profiling_i+1])
+			, (hal_init_stages_vendor_req[hal_init_profiling_i+1]-hal_init_stages_vendor_req[hal_init_profiling_i])
 		);
 	}
 	#endif
@@ -3053,6 +3206,8 @@ _func_enter_;
 
 	RT_SET_PS_LEVEL(pwrpriv, RT_RF_OFF_LEVL_HALT_NIC);
 
+	rtw_io_shadow_invalidate(padapter);
+
 	padapter->bHaltInProgress = _FALSE;
 
 _func_exit_;
@@ -3085,8 +3240,20 @@ _func_enter_;
 
 	//issue Rx irp to receive data
 	precvbuf = (struct recv_buf *)precvpriv->precv_buf;
+#ifdef CONFIG_USB_RX_URB_SCALE
+	// buffers above the current depth wait in free_recv_buf_queue, see rtl8192du_rx_urb_scale()
+	while (rtw_dequeue_recvbuf(&precvpriv->free_recv_buf_queue) != NULL)
+		;
+#endif
 	for(i=0; i<NR_RECVBUFF; i++)
 	{
+#ifdef CONFIG_USB_RX_URB_SCALE
+		if (i >= precvpriv->rx_urb_scale.depth) {
+			rtw_enqueue_recvbuf(precvbuf, &precvpriv->free_recv_buf_queue);
+			precvbuf++;
+			continue;
+		}
+#endif
 		if(_read_port(pintfhdl, precvpriv->ff_hwaddr, 0, (unsigned char *)precvbuf) == _FALSE )
 		{
 			RT_TRACE(_module_hci_hal_init_c_,_drv_err_,("usb_rx_init: usb_read_port error \n"));
@@ -3099,11 +3266,18 @@ _func_enter_;
 	}
 
 #ifdef CONFIG_USB_INTERRUPT_IN_PIPE
-	_read_interrupt = pintfhdl->io_ops._read_interrupt;
-	if(_read_interrupt(pintfhdl, RECV_INT_IN_ADDR) == _FALSE )
+	if(adapter_to_dvobj(padapter)->int_in_ep == 0 || precvpriv->int_in_urb == NULL)
 	{
-		RT_TRACE(_module_hci_hal_init_c_,_drv_err_,("usb_rx_init: usb_read_interrupt error \n"));
-		status = _FAIL;
+		DBG_871X("%s: no interrupt-in pipe, C2H events are polled\n", __FUNCTION__);
+	}
+	else
+	{
+		_read_interrupt = pintfhdl->io_ops._read_interrupt;
+		if(_read_interrupt(pintfhdl, RECV_INT_IN_ADDR) == _FALSE )
+		{
+			RT_TRACE(_module_hci_hal_init_c_,_drv_err_,("usb_rx_init: usb_read_interrupt error \n"));
+			status = _FAIL;
+		}
 	}
 #endif
 
@@ -5024,6 +5198,11 @@ _func_enter_;
 			#ifdef CONFIG_USB_RX_AGGREGATION
 			{
 				u8	threshold = *((u8 *)val);
+#ifdef CONFIG_USB_RX_AGG_TUNE
+				Adapter->recvpriv.rx_agg_tune.force_off = (threshold == 1) ? _TRUE : _FALSE;
+				if (threshold == 0)
+					threshold = rx_agg_level_page_th(Adapter, Adapter->recvpriv.rx_agg_tune.level);
+#endif
 				if( threshold == 0)
 				{
 					threshold = pHalData->UsbRxAggPageCount;
@@ -5032,6 +5211,23 @@ _func_enter_;
 			}
 			#endif
 			break;
+		case HW_VAR_RX_AGG_LEVEL:
+			#ifdef CONFIG_USB_RX_AGG_TUNE
+			{
+				// <0: back to automatic tuning, else pin the level
+				s8	level = *((s8 *)val);
+				struct rx_agg_tune *ptune = &Adapter->recvpriv.rx_agg_tune;
+
+				if (level < 0 || level >= RX_AGG_LVL_NUM) {
+					ptune->fixed = -1;
+				} else {
+					ptune->fixed = level;
+					if (ptune->level != level)
+						rtl8192du_rx_agg_set_level(Adapter, level);
+				}
+			}
+			#endif
+			break;
 		case HW_VAR_SET_RPWM:
 			{
 				u8	RpwmVal = (*(u8 *)val);
@@ -5345,6 +5541,9 @@ _func_enter_;
 		case HW_VAR_RF_TYPE:
 			val[0] = pHalData->rf_type;
 			break;
+		case HW_VAR_CPWM:
+			val[0] = rtw_read8(Adapter, REG_USB_HCPWM);
+			break;
 		case HW_VAR_FWLPS_RF_ON:
 			{
 				//When we halt NIC, we should check if FW LPS is leave.
@@ -5782,6 +5981,9 @@ _func_enter_;
 	pHalFunc->hal_xmit = &rtl8192du_hal_xmit;
 	pHalFunc->mgnt_xmit = &rtl8192du_mgnt_xmit;
         pHalFunc->hal_xmitframe_enqueue = &rtl8192du_hal_xmitframe_enqueue;
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+	pHalFunc->tx_agg_update = &rtl8192du_tx_agg_update;
+#endif
 
 	//pHalFunc->read_bbreg = &rtl8192d_PHY_QueryBBReg;
 	//pHalFunc->write_bbreg = &rtl8192d_PHY_SetBBReg;
@@ -71,6 +71,10 @@ static int usbctrl_vendorreq(struct intf_hdl *pintfhdl, u8 request, u16 value, u
 		goto exit;
 	}
 
+#ifdef CONFIG_USB_VENDOR_REQ_MUTEX
+	_enter_critical_mutex(&pdvobjpriv->usb_vendor_req_mutex, NULL);
+#endif
+
 	// Acquire IO memory for vendorreq
 #ifdef CONFIG_USB_VENDOR_REQ_BUFFER_PREALLOC
 	pIo_buf = pdvobjpriv->usb_vendor_req_buf;
@@ -94,6 +98,8 @@ static int usbctrl_vendorreq(struct intf_hdl *pintfhdl, u8 request, u16 value, u
 		goto release_mutex;
 	}
 
+	padapter->iopriv.vendor_req_cnt++;
+
 	while(++vendorreq_times<= MAX_USBCTRL_VENDORREQ_TIMES)
 	{
 		_rtw_memset(pIo_buf, 0, len);
@@ -173,6 +179,9 @@ static int usbctrl_vendorreq(struct intf_hdl *pintfhdl, u8 request, u16 value, u
 	#endif
 
 release_mutex:
+#ifdef CONFIG_USB_VENDOR_REQ_MUTEX
+	_exit_critical_mutex(&pdvobjpriv->usb_vendor_req_mutex, NULL);
+#endif
 exit:
 	return status;
 
@@ -318,6 +327,27 @@ static u32 usb_read32(struct intf_hdl *pintfhdl, u32 addr)
 
 }
 
+void usb_read_mem(struct intf_hdl *pintfhdl, u32 addr, u32 cnt, u8 *rmem)
+{
+	u16 wvalue;
+	u16 len;
+
+	_func_enter_;
+
+	while (cnt) {
+		wvalue = (u16)(addr&0x0000ffff);
+		len = (cnt > VENDOR_CMD_MAX_DATA_LEN) ? VENDOR_CMD_MAX_DATA_LEN : cnt;
+
+		usb_read_reg(pintfhdl, wvalue, rmem, len);
+
+		addr += len;
+		rmem += len;
+		cnt -= len;
+	}
+
+	_func_exit_;
+}
+
 static int usb_write8(struct intf_hdl *pintfhdl, u32 addr, u8 val)
 {
 	u16 wvalue;
@@ -406,6 +436,52 @@ static int usb_writeN(struct intf_hdl *pintfhdl, u32 addr, u32 length, u8 *pdata
 }
 
 #ifdef CONFIG_USB_INTERRUPT_IN_PIPE
+/*
+ * The interrupt-in message carries the C2H message registers and the
+ * HISR/HISRE snapshot. Runs in URB completion context, so everything that
+ * needs register access is handed over to c2h_wk.
+ */
+static void usb_interrupt_msg_hdl(_adapter *padapter, u8 *pbuf, u32 len)
+{
+	PINTERRUPT_MSG_FORMAT_EX pmsg = (PINTERRUPT_MSG_FORMAT_EX)pbuf;
+	struct recv_priv *precvpriv = &padapter->recvpriv;
+	struct evt_priv *pevtpriv = &padapter->evtpriv;
+	struct c2h_evt_hdr *c2h_evt;
+	u32 hisr;
+	u8 kick = _FALSE;
+
+	if (len < offsetof(INTERRUPT_MSG_FORMAT_EX, HISRE))
+		return;
+
+	hisr = le32_to_cpu(pmsg->HISR);
+
+	if ((hisr & IMR_C2HCMD) || pbuf[C2H_EVT_MSG_LEN] == C2H_EVT_FW_CLOSE) {
+		precvpriv->int_c2h_cnt++;
+
+		c2h_evt = (struct c2h_evt_hdr *)kzalloc(16, GFP_ATOMIC);
+		if (c2h_evt)
+			memcpy(c2h_evt, pbuf, C2H_EVT_MSG_LEN);
+
+		if (c2h_evt == NULL || c2h_evt->plen > C2H_EVT_MSG_LEN - sizeof(*c2h_evt)
+			|| rtw_cbuf_push(pevtpriv->c2h_queue, (void *)c2h_evt) != _SUCCESS) {
+			if (c2h_evt)
+				rtw_mfree((u8*)c2h_evt, 16);
+			/* Special pointer, have c2h_wk clear the message so FW can post the next one */
+			rtw_cbuf_push(pevtpriv->c2h_queue, (void *)pevtpriv);
+		}
+		kick = _TRUE;
+	}
+
+	if (hisr & IMR_CPWM) {
+		precvpriv->int_cpwm_cnt++;
+		pevtpriv->cpwm_pending = _TRUE;
+		kick = _TRUE;
+	}
+
+	if (kick)
+		_set_workitem(&pevtpriv->c2h_wk);
+}
+
 static void usb_read_interrupt_complete(struct urb *purb, struct pt_regs *regs)
 {
 	int	err;
@@ -418,11 +494,21 @@ static void usb_read_interrupt_complete(struct urb *purb, struct pt_regs *regs)
 		{
 			DBG_8192C("usb_read_interrupt_complete: purb->actual_length > sizeof(INTERRUPT_MSG_FORMAT_EX) \n");
 		}
+		else
+		{
+			usb_interrupt_msg_hdl(padapter, purb->transfer_buffer, purb->actual_length);
+		}
+
+		if (padapter->bDriverStopped || padapter->bSurpriseRemoved) {
+			padapter->recvpriv.int_in_active = _FALSE;
+			return;
+		}
 
 		err = usb_submit_urb(purb, GFP_ATOMIC);
 		if((err) && (err != (-EPERM)))
 		{
 			DBG_8192C("cannot submit interrupt in-token(err = 0x%08x),urb_status = %d\n",err, purb->status);
+			padapter->recvpriv.int_in_active = _FALSE;
 		}
 	}
 	else
@@ -439,8 +525,10 @@ static void usb_read_interrupt_complete(struct urb *purb, struct pt_regs *regs)
 			case -ENOENT:
 				padapter->bDriverStopped=_TRUE;
 				RT_TRACE(_module_hci_ops_os_c_,_drv_err_,("usb_read_port_complete:bDriverStopped=TRUE\n"));
+				padapter->recvpriv.int_in_active = _FALSE;
 				break;
 			case -EPROTO:
+				padapter->recvpriv.int_in_active = _FALSE;
 				break;
 			case -EINPROGRESS:
 				DBG_8192C("ERROR: URB IS IN PROGRESS!/n");
@@ -479,6 +567,10 @@ _func_enter_;
 		DBG_8192C("cannot submit interrupt in-token(err = 0x%08x),urb_status = %d\n",err, precvpriv->int_in_urb->status);
 		ret = _FAIL;
 	}
+	else
+	{
+		precvpriv->int_in_active = _TRUE;
+	}
 
 _func_exit_;
 
@@ -896,7 +988,7 @@ static void usb_read_port_complete(struct urb *purb, struct pt_regs *regs)
 
 	RT_TRACE(_module_hci_ops_os_c_,_drv_err_,("usb_read_port_complete!!!\n"));
 
-	precvpriv->rx_pending_cnt --;
+	ATOMIC_DEC(&precvpriv->rx_pending_cnt);
 
 	if(padapter->bSurpriseRemoved || padapter->bDriverStopped||padapter->bReadPortCancel)
 	{
@@ -987,7 +1079,7 @@ _func_enter_;
 
 		if(precvbuf->pbuf)
 		{
-			precvpriv->rx_pending_cnt++;
+			ATOMIC_INC(&precvpriv->rx_pending_cnt);
 
 			purb = precvbuf->purb;
 
@@ -1004,6 +1096,12 @@ _func_enter_;
 			purb->transfer_flags |= URB_NO_TRANSFER_DMA_MAP;
 
 			err = usb_submit_urb(purb, GFP_ATOMIC);
+			if (err)
+			{
+				// nothing was posted, undo the count and keep the buffer where the refill finds it
+				ATOMIC_DEC(&precvpriv->rx_pending_cnt);
+				rtw_enqueue_recvbuf(precvbuf, &precvpriv->free_recv_buf_queue);
+			}
 			if((err) && (err != (-EPERM)))
 			{
 				RT_TRACE(_module_hci_ops_os_c_,_drv_err_,("cannot submit rx in-token(err=0x%.8x), URB_STATUS =0x%.8x", err, purb->status));
@@ -1025,11 +1123,45 @@ _func_exit_;
 	return ret;
 }
 #else	// CONFIG_USE_USB_BUFFER_ALLOC_RX
+#ifdef CONFIG_USB_RX_ZEROCOPY
+// every clone is charged the truesize of the whole bulk-in skb, so small
+// sub-frames (TCP ACKs, management) are cheaper to copy than to share
+#define RECVBUF_SHARE_MIN_SZ	512
+
+/*
+ * A sub-frame can be indicated straight out of the bulk-in skb unless it is
+ * small, has to be defragmented (needs room to append the next fragments) or
+ * its IP header would end up misaligned on a platform that can't afford it.
+ */
+static u8 recvframe_can_share_recvbuf(_adapter *padapter, struct rx_pkt_attrib *pattrib, u8 *pdata)
+{
+	if (!padapter->registrypriv.rx_zerocopy)
+		return _FALSE;
+
+	if (pattrib->pkt_len < RECVBUF_SHARE_MIN_SZ)
+		return _FALSE;
+
+	if ((pattrib->mfrag == 1) || (pattrib->frag_num != 0))
+		return _FALSE;
+
+#ifndef CONFIG_HAVE_EFFICIENT_UNALIGNED_ACCESS
+	// WLAN header is 24 bytes, 26 with QoS; IV and LLC/SNAP keep 4-byte alignment
+	if (((SIZE_PTR)pdata + (pattrib->qos ? 26 : 24)) & 3)
+		return _FALSE;
+#endif
+
+	return _TRUE;
+}
+#endif //CONFIG_USB_RX_ZEROCOPY
+
 static int recvbuf2recvframe(_adapter *padapter, _pkt *pskb)
 {
 	u8	*pbuf;
 	u8	shift_sz = 0;
 	u16	pkt_cnt;
+#ifdef CONFIG_USB_RX_ZEROCOPY
+	u8	*pdata;
+#endif
 	u32	pkt_offset, skb_len, alloc_sz;
 	int	transfer_len;
 	struct recv_stat	*prxstat;
@@ -1091,60 +1223,74 @@ static int recvbuf2recvframe(_adapter *padapter, _pkt *pskb)
 			goto _exit_recvbuf2recvframe;
 		}
 #ifdef CONFIG_USB_RX_AGGREGATION //no usb rx aggregation, no skb copy
-		//	Modified by Albert 20101213
-		//	For 8 bytes IP header alignment.
-		if (pattrib->qos)	//	Qos data, wireless lan header length is 26
-		{
-			shift_sz = 6;
-		}
-		else
-		{
-			shift_sz = 0;
-		}
-
 		skb_len = pattrib->pkt_len;
 
-		// for first fragment packet, driver need allocate 1536+drvinfo_sz+RXDESC_SIZE to defrag packet.
-		// modify alloc_sz for recvive crc error packet by thomas 2011-06-02
-		if((pattrib->mfrag == 1)&&(pattrib->frag_num == 0)){
-			//alloc_sz = 1664;	//1664 is 128 alignment.
-			if(skb_len <= 1650)
-				alloc_sz = 1664;
-			else
-				alloc_sz = skb_len + 14;
-		}
-		else {
-			alloc_sz = skb_len;
-			//	6 is for IP header 8 bytes alignment in QoS packet case.
-			//	8 is for skb->data 4 bytes alignment.
-			alloc_sz += 14;
-		}
-
-		pkt_copy = rtw_skb_alloc(alloc_sz);
+#ifdef CONFIG_USB_RX_ZEROCOPY
+		pdata = pbuf + pattrib->shift_sz + pattrib->drvinfo_sz + RXDESC_SIZE;
 
-		if(pkt_copy)
+		if ((recvframe_can_share_recvbuf(padapter, pattrib, pdata) == _TRUE)
+			&& ((pkt_copy = rtw_skb_clone(pskb)) != NULL))
 		{
 			precvframe->u.hdr.pkt = pkt_copy;
-			precvframe->u.hdr.rx_head = pkt_copy->data;
-			precvframe->u.hdr.rx_end = pkt_copy->data + alloc_sz;
-			skb_reserve( pkt_copy, 8 - ((SIZE_PTR)( pkt_copy->data ) & 7 ));//force pkt_copy->data at 8-byte alignment address
-			skb_reserve( pkt_copy, shift_sz );//force ip_hdr at 8-byte alignment address according to shift_sz.
-			memcpy(pkt_copy->data, (pbuf + pattrib->shift_sz + pattrib->drvinfo_sz + RXDESC_SIZE), skb_len);
-			precvframe->u.hdr.rx_data = precvframe->u.hdr.rx_tail = pkt_copy->data;
+			precvframe->u.hdr.rx_head = precvframe->u.hdr.rx_data = precvframe->u.hdr.rx_tail = pdata;
+			precvframe->u.hdr.rx_end = pdata + skb_len;
 		}
 		else
+#endif //CONFIG_USB_RX_ZEROCOPY
 		{
-			precvframe->u.hdr.pkt = rtw_skb_clone(pskb);
+			//	Modified by Albert 20101213
+			//	For 8 bytes IP header alignment.
+			if (pattrib->qos)	//	Qos data, wireless lan header length is 26
+			{
+				shift_sz = 6;
+			}
+			else
+			{
+				shift_sz = 0;
+			}
+
+			// for first fragment packet, driver need allocate 1536+drvinfo_sz+RXDESC_SIZE to defrag packet.
+			// modify alloc_sz for recvive crc error packet by thomas 2011-06-02
+			if((pattrib->mfrag == 1)&&(pattrib->frag_num == 0)){
+				//alloc_sz = 1664;	//1664 is 128 alignment.
+				if(skb_len <= 1650)
+					alloc_sz = 1664;
+				else
+					alloc_sz = skb_len + 14;
+			}
+			else {
+				alloc_sz = skb_len;
+				//	6 is for IP header 8 bytes alignment in QoS packet case.
+				//	8 is for skb->data 4 bytes alignment.
+				alloc_sz += 14;
+			}
+
+			pkt_copy = rtw_skb_alloc(alloc_sz);
+
 			if(pkt_copy)
 			{
-				precvframe->u.hdr.rx_head = precvframe->u.hdr.rx_data = precvframe->u.hdr.rx_tail = pbuf;
-				precvframe->u.hdr.rx_end = pbuf + alloc_sz;
+				precvframe->u.hdr.pkt = pkt_copy;
+				precvframe->u.hdr.rx_head = pkt_copy->data;
+				precvframe->u.hdr.rx_end = pkt_copy->data + alloc_sz;
+				skb_reserve( pkt_copy, 8 - ((SIZE_PTR)( pkt_copy->data ) & 7 ));//force pkt_copy->data at 8-byte alignment address
+				skb_reserve( pkt_copy, shift_sz );//force ip_hdr at 8-byte alignment address according to shift_sz.
+				memcpy(pkt_copy->data, (pbuf + pattrib->shift_sz + pattrib->drvinfo_sz + RXDESC_SIZE), skb_len);
+				precvframe->u.hdr.rx_data = precvframe->u.hdr.rx_tail = pkt_copy->data;
 			}
 			else
 			{
-				DBG_8192C("recvbuf2recvframe: rtw_skb_clone fail\n");
-				rtw_free_recvframe(precvframe, pfree_recv_queue);
-				goto _exit_recvbuf2recvframe;
+				precvframe->u.hdr.pkt = rtw_skb_clone(pskb);
+				if(pkt_copy)
+				{
+					precvframe->u.hdr.rx_head = precvframe->u.hdr.rx_data = precvframe->u.hdr.rx_tail = pbuf;
+					precvframe->u.hdr.rx_end = pbuf + alloc_sz;
+				}
+				else
+				{
+					DBG_8192C("recvbuf2recvframe: rtw_skb_clone fail\n");
+					rtw_free_recvframe(precvframe, pfree_recv_queue);
+					goto _exit_recvbuf2recvframe;
+				}
 			}
 		}
 
@@ -1213,27 +1359,108 @@ _exit_recvbuf2recvframe:
 	return _SUCCESS;
 }
 
+#ifdef CONFIG_USB_RX_URB_SCALE
+static void rx_urb_scale_submit(struct recv_priv *precvpriv, struct recv_buf *precvbuf)
+{
+	struct rx_urb_scale *pscale = &precvpriv->rx_urb_scale;
+	u32 gap_us;
+
+	precvbuf->submit_time = ktime_get();
+
+	if (pscale->idle) {
+		pscale->idle = _FALSE;
+		gap_us = (u32)ktime_us_delta(precvbuf->submit_time, pscale->idle_start);
+		if (gap_us >= RX_URB_IDLE_MIN_US) {
+			pscale->idle_cnt++;
+			pscale->idle_us += gap_us;
+			if (gap_us > pscale->idle_max_us)
+				pscale->idle_max_us = gap_us;
+		}
+	}
+}
 
-void rtl8192du_recv_tasklet(void *priv)
+static void rx_urb_scale_complete(struct recv_priv *precvpriv, struct recv_buf *precvbuf, int pending)
+{
+	struct rx_urb_scale *pscale = &precvpriv->rx_urb_scale;
+	ktime_t now = ktime_get();
+	u32 lat_us;
+	u8 bucket;
+
+	lat_us = (u32)ktime_us_delta(now, precvbuf->submit_time);
+	if (lat_us < 250)
+		bucket = RX_URB_LAT_250US;
+	else if (lat_us < 1000)
+		bucket = RX_URB_LAT_1MS;
+	else if (lat_us < 4000)
+		bucket = RX_URB_LAT_4MS;
+	else if (lat_us < 16000)
+		bucket = RX_URB_LAT_16MS;
+	else
+		bucket = RX_URB_LAT_LONG;
+	pscale->lat_hist[bucket]++;
+
+	if (lat_us > pscale->lat_max_us)
+		pscale->lat_max_us = lat_us;
+	if (pscale->lat_avg_us == 0)
+		pscale->lat_avg_us = lat_us;
+	else
+		pscale->lat_avg_us = pscale->lat_avg_us - (pscale->lat_avg_us >> 3) + (lat_us >> 3);
+
+	// no IN token on the bus until the next submit
+	if (pending == 0) {
+		pscale->idle = _TRUE;
+		pscale->idle_start = now;
+	}
+}
+#endif //CONFIG_USB_RX_URB_SCALE
+
+//
+// Parse one completed bulk-in buffer into recv_frames and give the skb back to the pool.
+// Returns _FALSE when there was nothing to parse or the driver is stopping.
+//
+static u8 rtl8192du_recv_buf_process(_adapter *padapter)
 {
 	_pkt			*pskb;
-	_adapter		*padapter = (_adapter*)priv;
 	struct recv_priv	*precvpriv = &padapter->recvpriv;
-	struct recv_buf *precvbuf = NULL;
 
-	while (NULL != (pskb = skb_dequeue(&precvpriv->rx_skb_queue)))
+	if (NULL != (pskb = skb_dequeue(&precvpriv->rx_skb_queue)))
 	{
 		if ((padapter->bDriverStopped == _TRUE)||(padapter->bSurpriseRemoved== _TRUE))
 		{
 			DBG_8192C("recv_tasklet => bDriverStopped or bSurpriseRemoved \n");
 			rtw_skb_free(pskb);
-			break;
+			return _FALSE;
 		}
 
 		recvbuf2recvframe(padapter, pskb);
 #ifdef CONFIG_USB_RX_AGGREGATION //no usb rx aggregation, no copy
 #ifdef CONFIG_PREALLOC_RECV_SKB
 
+		// sub-frames still hold the buffer, put a fresh skb in the pool in its place
+		if (skb_cloned(pskb)) {
+			rtw_skb_free(pskb);
+#ifdef CONFIG_USB_RX_URB_SCALE
+			if (skb_queue_len(&precvpriv->free_recv_skb_queue) >= precvpriv->rx_urb_scale.skb_pool)
+				return _TRUE;
+#endif
+			pskb = rtw_skb_alloc(MAX_RECVBUF_SZ + RECVBUFF_ALIGN_SZ);
+			if (pskb == NULL)
+				return _TRUE;
+
+			pskb->dev = padapter->pnetdev;
+			skb_reserve(pskb, RECVBUFF_ALIGN_SZ - ((SIZE_PTR)pskb->data & (RECVBUFF_ALIGN_SZ-1)));
+			skb_queue_tail(&precvpriv->free_recv_skb_queue, pskb);
+			return _TRUE;
+		}
+
+#ifdef CONFIG_USB_RX_URB_SCALE
+		// the pool shrank with the URB depth
+		if (skb_queue_len(&precvpriv->free_recv_skb_queue) >= precvpriv->rx_urb_scale.skb_pool) {
+			rtw_skb_free(pskb);
+			return _TRUE;
+		}
+#endif
+
 		skb_reset_tail_pointer(pskb);
 		pskb->len = 0;
 
@@ -1244,8 +1471,17 @@ void rtl8192du_recv_tasklet(void *priv)
 #endif
 #endif //CONFIG_USB_RX_AGGREGATION, no usb rx aggregation, no copy
 
+		return _TRUE;
 	}
 
+	return _FALSE;
+}
+
+static void rtl8192du_recv_buf_resubmit(_adapter *padapter)
+{
+	struct recv_priv	*precvpriv = &padapter->recvpriv;
+	struct recv_buf *precvbuf = NULL;
+
 	while (NULL != (precvbuf = rtw_dequeue_recvbuf(&precvpriv->recv_buf_pending_queue)))
 	{
 		precvbuf->pskb = NULL;
@@ -1254,6 +1490,71 @@ void rtl8192du_recv_tasklet(void *priv)
 	}
 }
 
+void rtl8192du_recv_tasklet(void *priv)
+{
+	_adapter		*padapter = (_adapter*)priv;
+
+	while (rtl8192du_recv_buf_process(padapter) == _TRUE)
+		;
+
+	rtl8192du_recv_buf_resubmit(padapter);
+}
+
+#ifdef CONFIG_RTW_NAPI
+//
+// NAPI counterpart of rtl8192du_recv_tasklet(). recv_func() queues the MSDUs of a bulk-in
+// buffer on rx_napi_skb_queue, where the A-MPDU reorder timeout also puts the frames it
+// flushes, so both are handed up in order here. budget counts MSDUs, a new buffer is only
+// parsed once the MSDUs before it are gone.
+//
+int rtl8192du_recv_napi_poll(struct napi_struct *napi, int budget)
+{
+	struct recv_priv	*precvpriv = container_of(napi, struct recv_priv, napi);
+	_adapter		*padapter = precvpriv->adapter;
+	_pkt			*pskb;
+	gro_result_t gro_ret;
+	int work = 0;
+
+	precvpriv->napi_poll_cnt++;
+
+	while (work < budget) {
+		pskb = skb_dequeue(&precvpriv->rx_napi_skb_queue);
+		if (pskb == NULL) {
+			if (rtl8192du_recv_buf_process(padapter) == _FALSE)
+				break;
+			continue;
+		}
+
+		if (precvpriv->gro_en) {
+			gro_ret = napi_gro_receive(napi, pskb);
+			if ((gro_ret == GRO_MERGED) || (gro_ret == GRO_MERGED_FREE))
+				precvpriv->gro_merged_cnt++;
+		} else {
+			netif_receive_skb(pskb);
+		}
+		work++;
+	}
+
+	rtl8192du_recv_buf_resubmit(padapter);
+
+	if (work < budget) {
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(3, 19, 0))
+		napi_complete_done(napi, work);
+#else
+		napi_complete(napi);
+#endif
+		// a completion or the reorder timeout may have queued more after the checks above
+		if ((padapter->bDriverStopped == _FALSE) && (padapter->bSurpriseRemoved == _FALSE)
+			&& (skb_queue_len(&precvpriv->rx_napi_skb_queue) || skb_queue_len(&precvpriv->rx_skb_queue)))
+			napi_schedule(napi);
+	} else {
+		precvpriv->napi_budget_cnt++;
+	}
+
+	return work;
+}
+#endif //CONFIG_RTW_NAPI
+
 
 static void usb_read_port_complete(struct urb *purb, struct pt_regs *regs)
 {
@@ -1270,7 +1571,11 @@ static void usb_read_port_complete(struct urb *purb, struct pt_regs *regs)
 	//precvpriv->rx_pending_cnt --;
 	//_exit_critical(&precvpriv->lock, &irqL);
 
-	precvpriv->rx_pending_cnt --;
+#ifdef CONFIG_USB_RX_URB_SCALE
+	rx_urb_scale_complete(precvpriv, precvbuf, ATOMIC_DEC_RETURN(&precvpriv->rx_pending_cnt));
+#else
+	ATOMIC_DEC(&precvpriv->rx_pending_cnt);
+#endif
 
 	//if(precvpriv->rx_pending_cnt== 0)
 	//{
@@ -1310,10 +1615,20 @@ static void usb_read_port_complete(struct urb *purb, struct pt_regs *regs)
 			skb_queue_tail(&precvpriv->rx_skb_queue, precvbuf->pskb);
 
 			if (skb_queue_len(&precvpriv->rx_skb_queue)<=1)
-				tasklet_schedule(&precvpriv->recv_tasklet);
+				rtl8192du_recv_schedule(padapter);
 
 			precvbuf->pskb = NULL;
 			precvbuf->reuse = _FALSE;
+
+#ifdef CONFIG_USB_RX_URB_SCALE
+			// depth was lowered, keep this buffer off the pipe until rtl8192du_rx_urb_scale() wants it back
+			if (ATOMIC_READ(&precvpriv->rx_pending_cnt) >= precvpriv->rx_urb_scale.depth) {
+				precvpriv->rx_urb_scale.park_cnt++;
+				rtw_enqueue_recvbuf(precvbuf, &precvpriv->free_recv_buf_queue);
+				goto exit;
+			}
+#endif
+
 			rtw_read_port(padapter, precvpriv->ff_hwaddr, 0, (unsigned char *)precvbuf);
 		}
 	}
@@ -1386,6 +1701,9 @@ _func_enter_;
 		if (NULL != (precvbuf->pskb = skb_dequeue(&precvpriv->free_recv_skb_queue)))
 		{
 			precvbuf->reuse = _TRUE;
+		#ifdef CONFIG_USB_RX_URB_SCALE
+			precvpriv->rx_urb_scale.spare_cnt++;
+		#endif
 		}
 	}
 #endif
@@ -1403,9 +1721,15 @@ _func_enter_;
 			if(precvbuf->pskb == NULL)
 			{
 				RT_TRACE(_module_hci_ops_os_c_,_drv_err_,("init_recvbuf(): alloc_skb fail!\n"));
+			#ifdef CONFIG_USB_RX_URB_SCALE
+				precvpriv->rx_urb_scale.defer_cnt++;
+			#endif
 				rtw_enqueue_recvbuf(precvbuf, &precvpriv->recv_buf_pending_queue);
 				return _FAIL;
 			}
+		#ifdef CONFIG_USB_RX_URB_SCALE
+			precvpriv->rx_urb_scale.alloc_cnt++;
+		#endif
 
 			tmpaddr = (SIZE_PTR)precvbuf->pskb->data;
 			alignment = tmpaddr & (RECVBUFF_ALIGN_SZ-1);
@@ -1433,7 +1757,10 @@ _func_enter_;
 		//precvbuf->irp_pending = _TRUE;
 		//_exit_critical(&precvpriv->lock, &irqL);
 
-		precvpriv->rx_pending_cnt++;
+		ATOMIC_INC(&precvpriv->rx_pending_cnt);
+#ifdef CONFIG_USB_RX_URB_SCALE
+		rx_urb_scale_submit(precvpriv, precvbuf);
+#endif
 
 		purb = precvbuf->purb;
 
@@ -1447,6 +1774,19 @@ _func_enter_;
 						precvbuf);//context is precvbuf
 
 		err = usb_submit_urb(purb, GFP_ATOMIC);
+		if (err)
+		{
+			// nothing was posted, undo the count and keep the buffer where the refill finds it
+			ATOMIC_DEC(&precvpriv->rx_pending_cnt);
+		#ifdef CONFIG_PREALLOC_RECV_SKB
+			skb_queue_tail(&precvpriv->free_recv_skb_queue, precvbuf->pskb);
+		#else
+			rtw_skb_free(precvbuf->pskb);
+		#endif
+			precvbuf->pskb = NULL;
+			precvbuf->reuse = _FALSE;
+			rtw_enqueue_recvbuf(precvbuf, &precvpriv->free_recv_buf_queue);
+		}
 		if((err) && (err != (-EPERM)))
 		{
 			RT_TRACE(_module_hci_ops_os_c_,_drv_err_,("cannot submit rx in-token(err=0x%.8x), URB_STATUS =0x%.8x", err, purb->status));
@@ -1472,6 +1812,10 @@ void rtl8192du_xmit_tasklet(void *priv)
 	_adapter *padapter = (_adapter*)priv;
 	struct xmit_priv *pxmitpriv = &padapter->xmitpriv;
 
+#ifdef CONFIG_XMIT_STAGING_RING
+	rtw_xmit_staging_drain(padapter);
+#endif
+
 	if(check_fwstate(&padapter->mlmepriv, _FW_UNDER_SURVEY) == _TRUE
 #ifdef CONFIG_DUALMAC_CONCURRENT
 		|| (dc_check_xmit(padapter)== _FALSE)
@@ -1491,6 +1835,11 @@ void rtl8192du_xmit_tasklet(void *priv)
 
 		if(ret==_FALSE)
 			break;
+
+#ifdef CONFIG_XMIT_STAGING_RING
+		// pick up frames staged while the previous bulk was built
+		rtw_xmit_staging_drain(padapter);
+#endif
 	}
 
 }
@@ -471,6 +471,11 @@ rtl8192d_PHY_InitRxSetting(
 	PADAPTER Adapter
 );
 
+BOOLEAN
+rtl8192d_PHY_RestoreIQKResult(
+	PADAPTER Adapter
+);
+
 VOID
 rtl8192d_PHY_ResetIQKResult(
 	PADAPTER Adapter
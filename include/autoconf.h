@@ -120,6 +120,11 @@
 //	#define CONFIG_TDLS_AUTOCHECKALIVE		1
 #endif
 
+#define CONFIG_TX_TMPL_CACHE	1	// reuse per station/TID TX attrib, 802.11 header and TX descriptor words on the data path
+#ifdef CONFIG_TDLS
+	#undef CONFIG_TX_TMPL_CACHE	// direct link frames are retargeted to the TDLS peer after update_attrib
+#endif
+
 #define CONFIG_SKB_COPY	1//for amsdu
 
 #define CONFIG_DFS	1
@@ -144,6 +149,7 @@
 #endif	// CONFIG_BR_EXT
 
 #define CONFIG_TX_MCAST2UNI	1	// Support IP multicast->unicast
+#define CONFIG_STA_LOOKUP_TABLE	1	// lock-free open-addressed station lookup for rtw_get_stainfo
 //#define CONFIG_CHECK_AC_LIFETIME	1	// Check packet lifetime of 4 ACs.
 //#define CONFIG_DISABLE_MCS13TO15	1	// Disable MSC13-15 rates for more stable TX throughput with some 5G APs
 
@@ -170,14 +176,26 @@
 /*
  * Interface  Related Config
  */
-//#define CONFIG_USB_INTERRUPT_IN_PIPE	1
+#define CONFIG_USB_INTERRUPT_IN_PIPE	1	// C2H events and CPWM are pushed by the FW on the interrupt-in endpoint
+#ifdef CONFIG_USB_INTERRUPT_IN_PIPE
+	#define CONFIG_C2H_WK	// C2H events taken off the interrupt pipe are handled from c2h_wk
+#endif
 
 #ifndef CONFIG_MINIMAL_MEMORY_USAGE
 	#define CONFIG_USB_TX_AGGREGATION	1
+	#define CONFIG_USB_TX_AGG_ADAPTIVE	1	// per AC aggregate size/descriptor limits driven by URB completion latency
 	#define CONFIG_USB_RX_AGGREGATION	1
+	#define CONFIG_USB_RX_AGG_TUNE	1	// re-program the RX DMA aggregation threshold from the measured RX rate and frame size
+	#define CONFIG_USB_RX_ZEROCOPY	1	// indicate aggregated sub-frames as clones of the bulk-in skb instead of copying them
+	#define CONFIG_USB_RX_URB_SCALE	1	// number of posted bulk-in URBs and spare RX skbs follows pipe idle gaps and RX FIFO overflows
 #endif
 
 #define CONFIG_PREALLOC_RECV_SKB	1
+#define CONFIG_RTW_NAPI	1	// bulk-in buffers are parsed in a NAPI poll, MSDUs go up through napi_gro_receive
+#define CONFIG_RTW_TX_GSO	1	// take TSO skbs from the stack and segment them in the xmit path
+#define CONFIG_RTW_TX_AQM	1	// byte queue limits on the netdev queues, CoDel on the per-station AC queues
+#define CONFIG_TX_AIRTIME_DRR	1	// AP mode: deficit round robin on estimated airtime between the stations of an AC
+#define CONFIG_XMIT_STAGING_RING	1	// ndo_start_xmit hands data frames to the xmit tasklet through per-queue SPSC rings, without taking xmitpriv->lock
 //#define CONFIG_REDUCE_USB_TX_INT	1	// Trade-off: Improve performance, but may cause TX URBs blocked by USB Host/Bus driver on few platforms.
 //#define CONFIG_EASY_REPLACEMENT	1
 
@@ -189,6 +207,13 @@
 //#define CONFIG_USE_USB_BUFFER_ALLOC_RX 1	// For RX path
 #ifdef CONFIG_USE_USB_BUFFER_ALLOC_RX
 #undef CONFIG_PREALLOC_RECV_SKB
+#undef CONFIG_USB_RX_URB_SCALE	// needs the skb based bulk-in path and its spare skb pool
+#undef CONFIG_RTW_NAPI
+#endif
+
+#define CONFIG_USB_TX_SG	1	// bulk-out URBs carry data payload straight from the skb, only on hosts without SG length constraints
+#ifdef CONFIG_USE_USB_BUFFER_ALLOC_TX
+#undef CONFIG_USB_TX_SG	// coherent xmitbuf memory can't go into a scatterlist
 #endif
 
 /*
@@ -199,6 +224,13 @@
 #define CONFIG_USB_VENDOR_REQ_BUFFER_PREALLOC
 
 #define CONFIG_USB_VENDOR_REQ_MUTEX
+#define CONFIG_IO_BATCH	1	// coalesce contiguous register writes of TX power setting into one vendor request
+#define CONFIG_IO_SHADOW	1	// skip writes of unchanged values to the hot DM registers
+#define CONFIG_PHY_TBL_IMAGE	1	// load the MAC init table as pre-built runs of contiguous registers
+#define CONFIG_USB_FWDL_PIPELINE	1	// download firmware as pipelined maximum-size vendor requests
+#ifdef CONFIG_DUALMAC_CONCURRENT
+#undef CONFIG_IO_SHADOW	// the buddy MAC writes our BB registers through the 0x4000 PHY window
+#endif
 #define CONFIG_VENDOR_REQ_RETRY
 //#define CONFIG_USB_SUPPORT_ASYNC_VDN_REQ 1
 
@@ -238,7 +270,10 @@
 #ifdef CONFIG_MP_INCLUDED
 	#define MP_DRIVER 1
 	#undef CONFIG_USB_TX_AGGREGATION
+	#undef CONFIG_USB_TX_AGG_ADAPTIVE
 	#undef CONFIG_USB_RX_AGGREGATION
+	#undef CONFIG_USB_RX_AGG_TUNE
+	#undef CONFIG_USB_RX_ZEROCOPY
 #else
 	#define MP_DRIVER 0
 #endif
@@ -269,3 +304,6 @@
 //#define CONFIG_SINGLE_XMIT_BUF
 //RX use 1 urb
 //#define CONFIG_SINGLE_RECV_BUF
+#ifdef CONFIG_SINGLE_RECV_BUF
+#undef CONFIG_USB_RX_URB_SCALE
+#endif
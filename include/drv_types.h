@@ -208,6 +208,25 @@ struct registry_priv
 #endif
 
 	u8 hiq_filter;
+
+	u16 max_sta;	// sta_info pool limit, see NUM_STA_LIMIT
+
+#ifdef CONFIG_USB_RX_ZEROCOPY
+	u8 rx_zerocopy;
+#endif
+
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+	u32 tx_agg_budget;	// us, see struct tx_agg_ctrl
+#endif
+
+#ifdef CONFIG_USB_RX_URB_SCALE
+	u8 rx_urb_num;	// 0: auto-scaled, see struct rx_urb_scale
+#endif
+
+#ifdef CONFIG_RTW_NAPI
+	u8 en_napi;
+	u8 en_gro;
+#endif
 };
 
 
@@ -311,6 +330,7 @@ struct dvobj_priv
 	u8	RtNumInPipes;
 	u8	RtNumOutPipes;
 	int	ep_num[5]; //endpoint number
+	int	int_in_ep; //interrupt-in endpoint number, 0 if the interface has none
 
 	int	RegUsbSS;
 
@@ -547,9 +567,10 @@ struct _ADAPTER{
 	struct nat25_network_db_entry	*nethash[NAT25_HASH_SIZE];
 	int				pppoe_connection_in_progress;
 	unsigned char			pppoe_addr[MACADDRLEN];
-	unsigned char			scdb_mac[MACADDRLEN];
-	unsigned char			scdb_ip[4];
-	struct nat25_network_db_entry	*scdb_entry;
+	u32				nat25_hash_seed;
+	int				nat25_expire_idx;
+	atomic_t			nat25_flow_gen;
+	struct nat25_flow_cache		*nat25_flow;	// per-CPU, from alloc_percpu()
 	unsigned char			br_mac[MACADDRLEN];
 	unsigned char			br_ip[4];
 
@@ -171,6 +171,8 @@ u8	MRateToHwRate(u8 rate);
 
 void hal_init_macaddr(_adapter *adapter);
 
+#define C2H_EVT_MSG_LEN	15	/* header and content, the trigger byte follows */
+
 void c2h_evt_clear(_adapter *adapter);
 s32 c2h_evt_read(_adapter *adapter, u8 *buf);
 
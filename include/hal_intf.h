@@ -86,7 +86,9 @@ typedef enum _HW_VARIABLES{
 	HW_VAR_AMPDU_MIN_SPACE,
 	HW_VAR_AMPDU_FACTOR,
 	HW_VAR_RXDMA_AGG_PG_TH,
+	HW_VAR_RX_AGG_LEVEL,
 	HW_VAR_SET_RPWM,
+	HW_VAR_CPWM,
 	HW_VAR_H2C_FW_PWRMODE,
 	HW_VAR_H2C_FW_JOINBSSRPT,
 	HW_VAR_FWLPS_RF_ON,
@@ -196,6 +198,9 @@ struct hal_ops {
 	s32	(*hal_xmit)(PADAPTER Adapter, struct xmit_frame *pxmitframe);
 	s32	(*mgnt_xmit)(PADAPTER Adapter, struct xmit_frame *pmgntframe);
         s32	(*hal_xmitframe_enqueue)(_adapter *padapter, struct xmit_frame *pxmitframe);
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+	void	(*tx_agg_update)(_adapter *padapter, u8 qidx, u32 lat_us, u8 agg_stop);
+#endif
 
 	u32	(*read_bbreg)(PADAPTER Adapter, u32 RegAddr, u32 BitMask);
 	void	(*write_bbreg)(PADAPTER Adapter, u32 RegAddr, u32 BitMask, u32 Data);
@@ -426,6 +431,10 @@ void rtw_hal_notch_filter(_adapter * adapter, bool enable);
 void rtw_hal_reset_security_engine(_adapter * adapter);
 
 s32 rtw_hal_c2h_handler(_adapter *adapter, struct c2h_evt_hdr *c2h_evt);
+
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+void rtw_hal_tx_agg_update(_adapter *padapter, u8 qidx, u32 lat_us, u8 agg_stop);
+#endif
 c2h_id_filter rtw_hal_c2h_id_filter_ccx(_adapter *adapter);
 
 #endif //__HAL_INTF_H__
@@ -31,6 +31,7 @@ extern void _rtw_free_recv_priv (struct recv_priv *precvpriv);
 
 extern s32  rtw_recv_entry(union recv_frame *precv_frame);
 extern int rtw_recv_indicatepkt(_adapter *adapter, union recv_frame *precv_frame);
+extern void rtw_os_recv_indicate_skb(_adapter *padapter, _pkt *pkt);
 extern void rtw_recv_returnpacket(_nic_hdl cnxt, _pkt *preturnedpkt);
 
 extern void rtw_hostapd_mlme_rx(_adapter *padapter, union recv_frame *precv_frame);
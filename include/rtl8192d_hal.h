@@ -368,6 +368,10 @@ typedef struct _BT_COEXIST_STR{
 //Added for 92D IQK setting.
 typedef struct _IQK_MATRIX_REGS_SETTING{
 	BOOLEAN		bIQKDone;
+	// Conditions the result was taken under; it is only replayed while they still hold.
+	u8		ThermalValue;
+	u8		MacPhyMode;
+	u8		ChannelBW;	// HT_CHANNEL_WIDTH
 #if 1
 	int		Value[1][IQK_Matrix_REG_NUM];
 #else
@@ -741,6 +745,10 @@ struct hal_data_8192du
 	BOOLEAN		bNeedIQK;
 
 	BOOLEAN		bLCKInProgress;
+	// Last full LCK sweep; the CV curves are reloaded instead of swept again while it still applies.
+	BOOLEAN		bLCKDone;
+	u8		LCKMacPhyMode;
+	u8		LCKBandSet;
 
 	BOOLEAN		bEarlyModeEnable;
 
@@ -27,11 +27,22 @@
 
 #ifdef CONFIG_SINGLE_RECV_BUF
 	#define NR_RECVBUFF (1)
+#elif defined(CONFIG_USB_RX_URB_SCALE)
+	#define NR_RECVBUFF (16)	// allocated, recvpriv.rx_urb_scale.depth of them are posted
 #else
 	#define NR_RECVBUFF (4)
 #endif //CONFIG_SINGLE_RECV_BUF
 	#define NR_PREALLOC_RECV_SKB (8)
 
+#ifdef CONFIG_RTW_NAPI
+	#define RTL8192DU_NAPI_WEIGHT (64)	// MSDUs per poll
+#endif
+
+#ifdef CONFIG_USB_RX_URB_SCALE
+	#define NR_RECVBUFF_MIN (4)	// posted at init, floor of the auto-scaling
+	#define NR_PREALLOC_RECV_SKB_MAX (NR_RECVBUFF * 2)
+#endif
+
 #define RECV_BLK_SZ 512
 #define RECV_BLK_CNT 16
 #define RECV_BLK_TH RECV_BLK_CNT
@@ -143,6 +154,15 @@ void rtl8192du_init_recvbuf(_adapter *padapter, struct recv_buf *precvbuf);
 int	rtl8192du_init_recv_priv(_adapter * padapter);
 void	rtl8192du_free_recv_priv(_adapter * padapter);
 
+#ifdef CONFIG_USB_RX_AGG_TUNE
+void rtl8192du_rx_agg_set_level(_adapter *Adapter, u8 level);
+void rtl8192du_rx_agg_tune(_adapter *Adapter);
+#endif
+
+#ifdef CONFIG_USB_RX_URB_SCALE
+void rtl8192du_rx_urb_scale(_adapter *padapter);
+#endif
+
 void rtl8192d_translate_rx_signal_stuff(union recv_frame *precvframe, struct phy_stat *pphy_info);
 void rtl8192d_query_rx_desc_status(union recv_frame *precvframe, struct recv_stat *pdesc);
 
@@ -108,6 +108,10 @@ void rtl8192du_cal_txdesc_chksum(struct tx_desc	*ptxdesc);
 
 s32 rtl8192du_xmitframe_complete(_adapter *padapter, struct xmit_priv *pxmitpriv, struct xmit_buf *pxmitbuf);
 
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+void rtl8192du_tx_agg_update(_adapter *padapter, u8 qidx, u32 lat_us, u8 agg_stop);
+#endif
+
 s32 rtl8192du_mgnt_xmit(_adapter *padapter, struct xmit_frame *pmgntframe);
 
 s32 rtl8192du_hal_xmit(_adapter *padapter, struct xmit_frame *pxmitframe);
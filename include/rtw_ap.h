@@ -47,6 +47,12 @@ void rtw_set_macaddr_acl(_adapter *padapter, int mode);
 int rtw_acl_add_sta(_adapter *padapter, u8 *addr);
 int rtw_acl_remove_sta(_adapter *padapter, u8 *addr);
 
+#ifdef CONFIG_TX_MCAST2UNI
+void rtw_mc2u_snoop(_adapter *padapter, u8 *sta, u8 *frame, uint len);
+void rtw_mc2u_sta_leave(_adapter *padapter, u8 *sta);
+int rtw_mc2u_get_members(_adapter *padapter, u8 *frame, uint len, u8 (*members)[ETH_ALEN], int max);
+#endif
+
 #ifdef CONFIG_NATIVEAP_MLME
 void associated_clients_update(_adapter *padapter, u8 updated);
 void bss_cap_update_on_sta_join(_adapter *padapter, struct sta_info *psta);
@@ -32,9 +32,11 @@
 #define GET_MY_HWADDR(padapter)		((padapter)->eeprompriv.mac_addr)
 #endif	// rtw_wifi_driver
 
-#define NAT25_HASH_BITS		4
+#define NAT25_HASH_BITS		6
 #define NAT25_HASH_SIZE		(1 << NAT25_HASH_BITS)
 #define NAT25_AGEING_TIME	300
+#define NAT25_EXPIRE_BUCKETS	(NAT25_HASH_SIZE / 8)	// buckets swept per nat25_db_expire() call
+#define NAT25_FLOW_CACHE_NUM	4			// IPv4 -> MAC flows cached per CPU
 
 #ifdef CL_IPV6_PASS
 #define MAX_NETWORK_ADDR_LEN	17
@@ -50,6 +52,23 @@ struct nat25_network_db_entry
 	unsigned char					macAddr[6];
 	unsigned long					ageing_timer;
 	unsigned char					networkAddr[MAX_NETWORK_ADDR_LEN];
+	struct rcu_head					rcu;
+};
+
+// Readers walk the hash chains under rcu_read_lock(), writers hold br_ext_lock.
+// A cached flow is only trusted while its gen matches nat25_flow_gen, which is
+// bumped whenever an entry leaves the table or changes its MAC address.
+struct nat25_flow_entry
+{
+	struct nat25_network_db_entry	*db;
+	u32								gen;
+	unsigned char					ipAddr[4];
+	unsigned char					macAddr[ETH_ALEN];
+};
+
+struct nat25_flow_cache
+{
+	struct nat25_flow_entry			entry[NAT25_FLOW_CACHE_NUM];	// entry[0] is the most recently used
 };
 
 enum NAT25_METHOD {
@@ -70,6 +89,9 @@ struct br_ext_info {
 	unsigned int	nat25sc_disable;
 };
 
+int nat25_db_init(_adapter *priv);
+void nat25_db_deinit(_adapter *priv);
 void nat25_db_cleanup(_adapter *priv);
+int nat25_flow_tx_lookup(_adapter *priv, unsigned char *macAddr, unsigned char *ipAddr);
 
 #endif // _RTW_BR_EXT_H_
@@ -90,7 +90,9 @@ struct	evt_priv {
 	_workitem c2h_wk;
 	bool c2h_wk_alive;
 	struct rtw_cbuf *c2h_queue;
+	bool cpwm_pending;	// CPWM interrupt seen, HCPWM to be read by c2h_wk
 	#define C2H_QUEUE_MAX_LEN 10
+	#define C2H_EVT_BATCH_MAX 8	// events drained per "not read" kick
 #endif
 
 #ifdef CONFIG_H2CLBK
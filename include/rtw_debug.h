@@ -335,6 +335,23 @@ int proc_get_survey_info(struct seq_file *m, void *v);
 int proc_get_ap_info(struct seq_file *m, void *v);
 int proc_get_adapter_state(struct seq_file *m, void *v);
 int proc_get_trx_info(struct seq_file *m, void *v);
+int proc_get_io_stat(struct seq_file *m, void *v);
+#ifdef CONFIG_USB_RX_URB_SCALE
+int proc_get_rx_urb(struct seq_file *m, void *v);
+ssize_t proc_set_rx_urb(struct file *file, const char __user *buffer, size_t count, loff_t *pos, void *data);
+#endif
+#ifdef CONFIG_RTW_TX_AQM
+int proc_get_tx_aqm(struct seq_file *m, void *v);
+ssize_t proc_set_tx_aqm(struct file *file, const char __user *buffer, size_t count, loff_t *pos, void *data);
+#endif
+#ifdef CONFIG_USB_RX_AGG_TUNE
+int proc_get_rx_agg(struct seq_file *m, void *v);
+ssize_t proc_set_rx_agg(struct file *file, const char __user *buffer, size_t count, loff_t *pos, void *data);
+#endif
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+int proc_get_tx_agg(struct seq_file *m, void *v);
+ssize_t proc_set_tx_agg(struct file *file, const char __user *buffer, size_t count, loff_t *pos, void *data);
+#endif
 int proc_get_rate_ctl(struct seq_file *m, void *v);
 ssize_t proc_set_rate_ctl(struct file *file, const char __user *buffer, size_t count, loff_t *pos, void *data);
 
@@ -342,6 +359,9 @@ ssize_t proc_set_wait_hiq_empty(struct file *file, const char __user *buffer, si
 
 #ifdef CONFIG_AP_MODE
 int proc_get_all_sta_info(struct seq_file *m, void *v);
+#ifdef CONFIG_TX_MCAST2UNI
+int proc_get_mc2u(struct seq_file *m, void *v);
+#endif
 #endif /* CONFIG_AP_MODE */
 
 #ifdef CONFIG_FIND_BEST_CHANNEL
@@ -127,7 +127,7 @@ struct _io_ops
 		int (*_write32_async)(struct intf_hdl *pintfhdl, u32 addr, u32 val);
 
 		void (*_read_mem)(struct intf_hdl *pintfhdl, u32 addr, u32 cnt, u8 *pmem);
-		void (*_write_mem)(struct intf_hdl *pintfhdl, u32 addr, u32 cnt, u8 *pmem);
+		int (*_write_mem)(struct intf_hdl *pintfhdl, u32 addr, u32 cnt, u8 *pmem);
 
 		void (*_sync_irp_protocol_rw)(struct io_queue *pio_q);
 
@@ -293,12 +293,78 @@ struct io_queue {
 	struct	intf_hdl	intf;
 };
 
+#ifdef CONFIG_IO_BATCH
+#define IO_BATCH_MAX_LEN	254	// same as VENDOR_CMD_MAX_DATA_LEN, one vendor request per flush
+
+//
+// Register writes issued between rtw_io_batch_begin() and rtw_io_batch_end()
+// are held back while they extend one contiguous address run, and then sent
+// by a single _writeN vendor request. Any read or non-contiguous write from
+// the owner flushes the pending run first, so the owner's own order is kept.
+// Writes from other contexts bypass the batch and may reach the chip ahead of
+// the pending run; only batch registers no other context writes meanwhile.
+//
+struct io_batch {
+	_lock	lock;		// taking and releasing the batch, the owner alone touches the run
+	void	*owner;		// task which opened the batch
+	u8	depth;
+	u32	addr;		// start of the pending run
+	u16	len;
+	u8	buf[IO_BATCH_MAX_LEN];
+
+	u32	write_cnt;	// register writes recorded in a batch
+	u32	xfer_cnt;	// vendor requests used to flush them
+};
+#endif //CONFIG_IO_BATCH
+
+#ifdef CONFIG_IO_SHADOW
+#define IO_SHADOW_NUM	32
+
+//
+// Write-through copy of registers the HAL registered as hot. A write whose
+// value already sits in the shadow is not sent, and PHY_SetBBReg takes its
+// read-modify-write base from here. An entry only takes a value once the
+// write carrying it has succeeded; failed or still-batched writes drop it.
+// Only registers the hardware never changes by itself may be registered;
+// the shadow is dropped on hal init/deinit and power-save transitions.
+//
+struct io_shadow_reg {
+	u32	addr;		// dword aligned
+	u32	val;
+	u8	valid;
+};
+
+struct io_shadow {
+	struct io_shadow_reg reg[IO_SHADOW_NUM];
+	u8	num;
+	_mutex	lock;		// held across a shadowed register access and its shadow update
+
+	u32	write_saved_cnt;	// writes suppressed as redundant
+	u32	read_saved_cnt;		// reads served from the shadow
+};
+#endif //CONFIG_IO_SHADOW
+
 struct io_priv{
 
 	_adapter *padapter;
 
 	struct intf_hdl intf;
 
+#ifdef CONFIG_IO_BATCH
+	struct io_batch batch;
+#endif
+
+#ifdef CONFIG_IO_SHADOW
+	struct io_shadow shadow;
+#endif
+
+	u32 vendor_req_cnt;		// control transfers issued
+	u32 init_vendor_req_cnt;	// control transfers spent by the last hal init
+	u32 init_time_ms;		// duration of the last hal init
+	u32 fwdl_vendor_req_cnt;	// control transfers spent by the last firmware download
+	u32 fwdl_time_ms;		// duration of the last firmware download
+	u32 fwdl_retry;			// image rewrites needed by the last firmware download
+
 };
 
 extern uint ioreq_flush(_adapter *adapter, struct io_queue *ioqueue);
@@ -328,11 +394,31 @@ extern int _rtw_write16(_adapter *adapter, u32 addr, u16 val);
 extern int _rtw_write32(_adapter *adapter, u32 addr, u32 val);
 extern int _rtw_writeN(_adapter *adapter, u32 addr, u32 length, u8 *pdata);
 
+#ifdef CONFIG_IO_BATCH
+extern void rtw_io_batch_begin(_adapter *adapter);
+extern void rtw_io_batch_end(_adapter *adapter);
+extern void rtw_io_batch_flush(_adapter *adapter);
+#else
+#define rtw_io_batch_begin(adapter) do {} while (0)
+#define rtw_io_batch_end(adapter) do {} while (0)
+#define rtw_io_batch_flush(adapter) do {} while (0)
+#endif //CONFIG_IO_BATCH
+
+#ifdef CONFIG_IO_SHADOW
+extern void rtw_io_shadow_add(_adapter *adapter, u32 addr);
+extern void rtw_io_shadow_invalidate(_adapter *adapter);
+extern u8 rtw_io_shadow_read32(_adapter *adapter, u32 addr, u32 *pval);
+#else
+#define rtw_io_shadow_add(adapter, addr) do {} while (0)
+#define rtw_io_shadow_invalidate(adapter) do {} while (0)
+#define rtw_io_shadow_read32(adapter, addr, pval) _FALSE
+#endif //CONFIG_IO_SHADOW
+
 extern int _rtw_write8_async(_adapter *adapter, u32 addr, u8 val);
 extern int _rtw_write16_async(_adapter *adapter, u32 addr, u16 val);
 extern int _rtw_write32_async(_adapter *adapter, u32 addr, u32 val);
 
-extern void _rtw_write_mem(_adapter *adapter, u32 addr, u32 cnt, u8 *pmem);
+extern int _rtw_write_mem(_adapter *adapter, u32 addr, u32 cnt, u8 *pmem);
 extern u32 _rtw_write_port(_adapter *adapter, u32 addr, u32 cnt, u8 *pmem);
 u32 _rtw_write_port_and_wait(_adapter *adapter, u32 addr, u32 cnt, u8 *pmem, int timeout_ms);
 extern void _rtw_write_port_cancel(_adapter *adapter);
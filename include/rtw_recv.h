@@ -54,6 +54,10 @@ static u8 rtw_bridge_tunnel_header[] =
 { 0xaa, 0xaa, 0x03, 0x00, 0x00, 0xf8 };
 
 //for Rx reordering buffer control
+// Reorder buffer slots, indexed by seq_num % REORDER_RING_SIZE.
+// Must be a power of 2 and not smaller than the largest wsize_b.
+#define REORDER_RING_SIZE	64
+
 struct recv_reorder_ctrl
 {
 	_adapter	*padapter;
@@ -61,8 +65,11 @@ struct recv_reorder_ctrl
 	u16 indicate_seq;//=wstart_b, init_value=0xffff
 	u16 wend_b;
 	u8 wsize_b;
-	_queue pending_recvframe_queue;
+	_queue pending_recvframe_queue;	// only its lock is used, frames are held in reorder_ring
 	_timer reordering_ctrl_timer;
+	union recv_frame *reorder_ring[REORDER_RING_SIZE];
+	u16 ring_seq;	// lowest seq_num that can still be held in reorder_ring
+	u8 pending_cnt;
 };
 
 struct	stainfo_rxcache	{
@@ -193,6 +200,90 @@ accesser of recv_priv: rtw_recv_entry(dispatch / passive level); recv_thread(pas
 
 using enter_critical section to protect
 */
+#ifdef CONFIG_USB_RX_AGG_TUNE
+enum {
+	RX_AGG_LVL_LATENCY,	// hand every frame up right away
+	RX_AGG_LVL_MID,
+	RX_AGG_LVL_BULK,	// init setting, largest aggregates
+	RX_AGG_LVL_NUM,
+};
+
+#define RX_AGG_HIST_NUM	16
+
+struct rx_agg_hist {
+	u32	time;
+	u8	from;
+	u8	to;
+	u32	pps;
+	u32	avg_sz;
+};
+
+/*
+ * RX aggregation level picked by rtl8192du_rx_agg_tune() once per watchdog
+ * period, from the RX frame rate and average frame size of the last period.
+ */
+struct rx_agg_tune {
+	u8	level;		// programmed into the hardware
+	u8	target;		// level the last periods asked for
+	u8	target_cnt;	// consecutive periods target was seen
+	s8	fixed;		// -1: automatic, else level pinned through proc
+	u8	force_off;	// aggregation turned off by mlme (non-HT link or wifi_spec)
+
+	u32	last_time;
+	u64	last_pkts;
+	u64	last_bytes;
+	u32	pps;
+	u32	avg_sz;
+
+	u32	change_cnt;
+	u8	hist_idx;	// next slot of hist
+	struct rx_agg_hist hist[RX_AGG_HIST_NUM];
+};
+#endif
+
+#ifdef CONFIG_USB_RX_URB_SCALE
+#define RX_URB_IDLE_MIN_US	200	// shorter gaps without a posted bulk-in URB are not counted
+
+enum {
+	RX_URB_LAT_250US,
+	RX_URB_LAT_1MS,
+	RX_URB_LAT_4MS,
+	RX_URB_LAT_16MS,
+	RX_URB_LAT_LONG,
+	RX_URB_LAT_NUM,
+};
+
+struct rx_urb_scale {
+	u8	depth;		// bulk-in URBs kept posted
+	u8	depth_max;	// recv_buf allocated
+	u8	depth_fixed;	// 0: auto-scaled, else pinned through rtw_rx_urb_num or proc
+	u8	quiet_cnt;	// consecutive periods without idle gap or RX FIFO overflow
+	u16	skb_pool;	// target length of free_recv_skb_queue
+	u16	skb_pool_fixed;	// 0: follows depth, else pinned through proc
+
+	u8	idle;		// every posted URB has completed, pipe sends no IN token
+	ktime_t	idle_start;
+	u32	idle_cnt;
+	u32	idle_max_us;
+	u64	idle_us;
+
+	u32	last_idle_cnt;
+	u64	last_fifo_ovf;
+	u32	fifo_ovf_cnt;	// watchdog periods that saw the RX FIFO overflow
+
+	u32	spare_cnt;	// resubmitted with a pooled skb
+	u32	alloc_cnt;	// resubmitted with a freshly allocated skb
+	u32	defer_cnt;	// no skb, resubmission left to the recv tasklet
+	u32	park_cnt;	// not resubmitted, more URBs posted than depth
+	u32	grow_cnt;
+	u32	shrink_cnt;
+
+	u32	lat_hist[RX_URB_LAT_NUM];	// submit to complete time
+	u32	lat_avg_us;	// EWMA, 1/8 weight
+	u32	lat_max_us;
+};
+#endif
+
 struct recv_priv
 {
 	  _lock	lock;
@@ -229,15 +320,35 @@ struct recv_priv
 	//u8 *pallocated_urb_buf;
 	_sema allrxreturnevt;
 	uint	ff_hwaddr;
-	u8	rx_pending_cnt;
+	ATOMIC_T	rx_pending_cnt;	// bulk-in URBs on the pipe, decremented from URB completion
+
+#ifdef CONFIG_USB_RX_AGG_TUNE
+	struct rx_agg_tune rx_agg_tune;
+#endif
+#ifdef CONFIG_USB_RX_URB_SCALE
+	struct rx_urb_scale rx_urb_scale;
+#endif
 
 #ifdef CONFIG_USB_INTERRUPT_IN_PIPE
 	PURB	int_in_urb;
 
 	u8	*int_in_buf;
+	u8	int_in_active;	// interrupt-in URB is posted, C2H/CPWM need no polling
+	u32	int_cnt;
+	u32	int_c2h_cnt;
+	u32	int_cpwm_cnt;
 #endif
 	struct tasklet_struct irq_prepare_beacon_tasklet;
 	struct tasklet_struct recv_tasklet;
+#ifdef CONFIG_RTW_NAPI
+	struct napi_struct napi;	// replaces recv_tasklet when napi_en
+	struct sk_buff_head rx_napi_skb_queue;	// MSDUs waiting to be handed up by the poll
+	u8	napi_en;
+	u8	gro_en;
+	u32	napi_poll_cnt;
+	u32	napi_budget_cnt;	// polls that used up their budget
+	u32	gro_merged_cnt;
+#endif
 	struct sk_buff_head free_recv_skb_queue;
 	struct sk_buff_head rx_skb_queue;
 #ifdef CONFIG_RX_INDICATE_QUEUE
@@ -332,6 +443,9 @@ struct recv_buf
 
 	_pkt *pskb;
 	u8	reuse;
+#ifdef CONFIG_USB_RX_URB_SCALE
+	ktime_t	submit_time;
+#endif
 };
 
 /*
@@ -121,6 +121,7 @@ struct security_priv
 	u32 dot118021XGrpPrivacy;	// This specify the privacy algthm. used for Grp key
 	u32	dot118021XGrpKeyid;		// key id used for Grp Key ( tx key index)
 	union Keytype	dot118021XGrpKey[4];	// 802.1x Group Key, for inx0 and inx1
+	u32	dot118021XGrpKey_rk[4][AES_PRIV_SIZE / 4];	// CCMP key schedules, built where the group key is set
 	union Keytype	dot118021XGrptxmickey[4];
 	union Keytype	dot118021XGrprxmickey[4];
 	union pn48		dot11Grptxpn;			// PN48 used for Grp Key xmit.
@@ -293,6 +294,37 @@ struct mic_data
 	u32     nBytesInM;      // # bytes in M
 };
 
+// One Michael block function round on the (L, R) state
+#define MICHAEL_BLOCK( L, R )	\
+do{\
+	(R) ^= ROL32( (L), 17 );\
+	(L) += (R);\
+	(R) ^= (((L) & 0xff00ff00) >> 8) | (((L) & 0x00ff00ff) << 8);\
+	(L) += (R);\
+	(R) ^= ROL32( (L), 3 );\
+	(L) += (R);\
+	(R) ^= ROR32( (L), 2 );\
+	(L) += (R);\
+}while(0)
+
+// TKIP phase-1 output only changes with TK, TA and IV32, i.e. once every
+// 2^16 MPDUs, so each station keeps the last result per direction.
+enum TKIP_P1K_DIR {
+	TKIP_P1K_TX = 0,
+	TKIP_P1K_RX = 1,
+	TKIP_P1K_RX_GRP = 2,	// group key frames from the same TA
+	TKIP_P1K_NUM
+};
+
+struct tkip_p1k_cache
+{
+	u8	valid;
+	u8	ta[ETH_ALEN];
+	u8	tk[16];
+	u32	iv32;
+	u16	p1k[5];
+};
+
 extern const u32 Te0[256];
 extern const u32 Te1[256];
 extern const u32 Te2[256];
@@ -431,6 +463,7 @@ void rtw_seccalctkipmic(
 	u8 *Miccode,
 	u8   priority);
 
+void rtw_aes_key_setup(u32 *rk, const u8 *key);
 u32 rtw_aes_encrypt(_adapter *padapter, u8 *pxmitframe);
 u32 rtw_tkip_encrypt(_adapter *padapter, u8 *pxmitframe);
 void rtw_wep_encrypt(_adapter *padapter, u8  *pxmitframe);
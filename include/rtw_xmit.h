@@ -346,6 +346,54 @@ int rtw_sctx_wait(struct submit_ctx *sctx);
 void rtw_sctx_done_err(struct submit_ctx **sctx, int status);
 void rtw_sctx_done(struct submit_ctx **sctx);
 
+#ifdef CONFIG_RTW_TX_GSO
+#define RTW_GSO_MAX_SEGS	32	// segments of one TSO skb, well below the NR_XMITFRAME/2 queue stop mark
+#endif
+
+#ifdef CONFIG_USB_TX_SG
+#define XMITBUF_SG_PKT_NUM	16
+#define XMITBUF_SG_NUM		(XMITBUF_SG_PKT_NUM * 2 + 1)
+
+// a data payload left in its skb, occupying [offset, offset + len) of the xmitbuf layout
+struct xmitbuf_sg_pkt {
+	_pkt	*pkt;
+	u8	*data;
+	u32	offset;
+	u32	len;
+};
+#endif
+
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+#define TX_AGG_LEN_STEP		2048	// additive increase and floor of max_len
+#define TX_AGG_BUDGET_DEF	4000	// us, BE/BK URB latency target; VI gets 1/4 and VO 1/8
+
+// why an aggregate was closed
+enum {
+	TX_AGG_STOP_NONE,	// queue ran dry, qsel change or packet count limit
+	TX_AGG_STOP_LEN,	// max_len reached
+	TX_AGG_STOP_DESC,	// max_desc reached
+};
+
+/*
+ * Aggregation limits of one access category. Shrunk when the bulk-out URBs of
+ * the AC complete later than budget_us, grown while the AC has backlog and the
+ * limits are what closed the aggregate. See rtl8192du_tx_agg_update().
+ */
+struct tx_agg_ctrl {
+	u32	max_len;	// aggregate size limit in bytes
+	u8	max_desc;	// descriptors per bulk limit
+	u32	budget_us;
+	u32	lat_us;		// URB completion latency, EWMA 1/8
+
+	u32	urb_cnt;
+	u32	pkt_cnt;
+	u32	len_stop_cnt;
+	u32	desc_stop_cnt;
+	u32	grow_cnt;
+	u32	shrink_cnt;
+};
+#endif
+
 struct xmit_buf
 {
 	_list	list;
@@ -371,6 +419,19 @@ struct xmit_buf
 	dma_addr_t dma_transfer_addr;	/* (in) dma addr for transfer_buffer */
 #endif
 
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+	u8 agg_stop;	// TX_AGG_STOP_*
+#if defined(PLATFORM_LINUX)
+	ktime_t submit_time;
+#endif
+#endif
+
+#ifdef CONFIG_USB_TX_SG
+	u8 sg_pkt_cnt;
+	struct xmitbuf_sg_pkt sg_pkt[XMITBUF_SG_PKT_NUM];
+	struct scatterlist sg[XMITBUF_SG_NUM];
+#endif
+
 	u8 bpending[8];
 
 	sint last[8];
@@ -407,18 +468,106 @@ struct xmit_frame
 	u8 ack_report;
 #endif
 
+#ifdef CONFIG_RTW_TX_AQM
+	s64	enqueue_us;	// accepted by rtw_xmit(), sojourn time starts here
+	u32	bql_len;	// bytes charged to the netdev queue, 0 once discharged
+	u16	bql_qidx;
+#endif
+
 	u8 *alloc_addr; /* the actual address this xmitframe allocated */
 	u8 ext_tag; /* 0:data, 1:mgmt */
 
 };
 
+#ifdef CONFIG_RTW_TX_AQM
+#define TX_AQM_TARGET_US	5000
+#define TX_AQM_INTERVAL_US	100000
+
+// CoDel state of one station AC queue, see tx_aqm_dequeue()
+struct tx_aqm_vars {
+	s64	first_above_us;	// when a sojourn above target turns into a standing queue, 0 while below
+	s64	drop_next_us;
+	u32	count;		// drops/marks of the current dropping state
+	u32	lastcount;
+	u8	dropping;
+};
+
+// per AC, indexed like hwxmits
+struct tx_aqm_stat {
+	u32	sojourn_avg_us;	// EWMA 1/8
+	u32	sojourn_max_us;
+	u32	dequeued;
+	u32	drops;
+	u32	marks;		// ECN CE instead of a drop
+};
+#endif
+
 struct tx_servq {
 	_list	tx_pending;
 	_queue	sta_pending;
 	int qcnt;
+#ifdef CONFIG_RTW_TX_AQM
+	struct tx_aqm_vars aqm;
+#endif
+#ifdef CONFIG_TX_AIRTIME_DRR
+	s32	deficit_us;	// airtime credit, the station is skipped while <= 0
+#endif
 };
 
+#ifdef CONFIG_TX_AIRTIME_DRR
+#define TX_AIRTIME_QUANTUM_US	8000	// credit per visit of a station in debt
+#define TX_AIRTIME_OVERHEAD_US	100	// preamble, contention and BlockAck of one bulk
+// a 20k bulk at 1Mbps costs ~21 quanta, visit every station that often at most
+#define TX_AIRTIME_MAX_VISITS	(NUM_STA * 32)
+#endif
+
+
 
+#ifdef CONFIG_TX_TMPL_CACHE
+// which header addresses are refreshed from the frame on a template hit
+enum {
+	TX_TMPL_ADDR_STA,	// addr3 = DA
+	TX_TMPL_ADDR_AP,	// addr1 = DA, addr3 = SA
+	TX_TMPL_ADDR_ADHOC,	// addr1 = DA
+};
+
+/*
+ * What the data path derives from the station alone, per TID. Valid while
+ * gen equals xmit_priv.tx_tmpl_gen, see rtw_tx_tmpl_invalidate(). Duration,
+ * DA/SA, sequence number, MData/EOSP, length and everything depending on the
+ * frame size are still filled per frame.
+ */
+struct tx_tmpl {
+	u32	gen;
+
+	// update_attrib
+	u8	qos_en;
+	u8	ht_en;
+	u8	raid;
+	u8	bwmode;
+	u8	ch_offset;
+	u8	sgi;
+	u8	encrypt;
+	u8	iv_len;
+	u8	icv_len;
+	u8	key_idx;
+	u8	bswenc;
+	u8	sw_encrypt;	// security_priv inputs of bswenc, the RX path flips
+	u8	hw_decrypted;	// hw_decrypted without invalidating the templates
+
+	// rtw_make_wlanhdr
+	u8	hdr_valid;
+	u8	hdrlen;
+	u8	addr_sel;
+	u8	hdr[WLAN_HDR_A3_QOS_LEN];
+
+	// HAL TX descriptor words, little endian
+	u8	txdesc_valid;
+	u32	txdw1;		// MACID, RAID and sectype, QSEL is filled per frame
+	u32	txdw4;
+	u32	txdw5;
+};
+#endif
 
 struct sta_xmit_priv
 {
@@ -437,6 +586,15 @@ struct sta_xmit_priv
 
 	u16 txseq_tid[16];
 
+#ifdef CONFIG_TX_TMPL_CACHE
+	struct tx_tmpl tx_tmpl[8];	// indexed by TID
+#endif
+
+#ifdef CONFIG_TX_AIRTIME_DRR
+	u32	airtime_kbps;	// rate the last bulk was charged at
+	u64	airtime_us;	// airtime charged so far
+#endif
+
 	//uint	sta_tx_bytes;
 	//u64	sta_tx_pkts;
 	//uint	sta_tx_fail;
@@ -444,6 +602,24 @@ struct sta_xmit_priv
 };
 
 
+#ifdef CONFIG_XMIT_STAGING_RING
+// power of 2; CIRC_SPACE leaves one slot unused, so it must exceed NR_XMITFRAME
+// for a push never to find the ring full
+#define XMIT_STAGING_RING_SZ	512
+
+/*
+ * Single-producer/single-consumer ring between ndo_start_xmit and the xmit tasklet.
+ * Only the producer (the netdev subqueue owner) writes head,
+ * only the consumer (xmit tasklet) writes tail.
+ * rtw_xmit_staging_purge also consumes, on stop/free, under the same xmitpriv->lock.
+ */
+struct xmit_staging_ring {
+	struct xmit_frame *frame[XMIT_STAGING_RING_SZ];
+	volatile u32 head;
+	volatile u32 tail;
+};
+#endif //CONFIG_XMIT_STAGING_RING
+
 struct	hw_txqueue	{
 	volatile sint	head;
 	volatile sint	tail;
@@ -522,6 +698,10 @@ struct	xmit_priv	{
 	int viq_cnt;
 	int voq_cnt;
 
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+	struct tx_agg_ctrl tx_agg_ctrl[4];	// indexed by VO_QUEUE_INX..BK_QUEUE_INX
+#endif
+
 
 	_queue free_xmitbuf_queue;
 	_queue pending_xmitbuf_queue;
@@ -536,6 +716,37 @@ struct	xmit_priv	{
 
 	u16	nqos_ssn;
 
+#ifdef CONFIG_TX_TMPL_CACHE
+	u32	tx_tmpl_gen;
+	u32	tx_tmpl_hit;
+	u32	tx_tmpl_miss;
+#endif
+
+#ifdef CONFIG_USB_TX_SG
+	u8	tx_sg_en;	// host controller takes unaligned SG segments
+	u32	tx_sg_pkt_cnt;	// payloads sent from the skb
+	u64	tx_sg_bytes;	// payload bytes not copied into xmitbufs
+#endif
+
+#ifdef CONFIG_RTW_TX_GSO
+	u32	tx_gso_cnt;	// GSO skbs segmented by rtw_os_xmit_gso()
+	u32	tx_gso_segs;
+	u32	tx_gso_busy;	// returned to the stack, not enough free xmit_frames
+	unsigned long	tx_gso_stopped;	// subqueues stopped by tx_gso_busy, woken by rtw_free_xmitframe
+#endif
+
+#ifdef CONFIG_RTW_TX_AQM
+	u32	tx_aqm_target_us;	// 0: CoDel off, byte queue limits stay on
+	u32	tx_aqm_interval_us;
+	struct tx_aqm_stat tx_aqm_stat[HWXMIT_ENTRY];
+	_lock	bql_lock;	// serializes netdev_tx_completed_queue()
+#endif
+
+#ifdef CONFIG_XMIT_STAGING_RING
+	// one ring per netdev subqueue, indexed by skb queue mapping
+	struct xmit_staging_ring staging_ring[HWXMIT_ENTRY];
+#endif
+
 #ifdef CONFIG_XMIT_ACK
 	int	ack_tx;
 	_mutex ack_tx_mutex;
@@ -579,6 +790,22 @@ s32 _rtw_init_hw_txqueue(struct hw_txqueue* phw_txqueue, u8 ac_tag);
 void _rtw_init_sta_xmit_priv(struct sta_xmit_priv *psta_xmitpriv);
 
 
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+void rtw_tx_agg_set_budget(_adapter *padapter, u32 budget_us);
+#endif
+
+#ifdef CONFIG_TX_TMPL_CACHE
+void rtw_tx_tmpl_invalidate(_adapter *padapter);
+struct tx_tmpl *rtw_tx_tmpl_get(_adapter *padapter, struct pkt_attrib *pattrib);
+#endif
+
+#ifdef CONFIG_XMIT_STAGING_RING
+s32 rtw_xmit_staging_push(_adapter *padapter, u8 qidx, struct xmit_frame *pxmitframe);
+u32 rtw_xmit_staging_cnt(struct xmit_priv *pxmitpriv, u8 qidx);
+void rtw_xmit_staging_drain(_adapter *padapter);
+void rtw_xmit_staging_purge(_adapter *padapter);
+#endif //CONFIG_XMIT_STAGING_RING
+
 s32 rtw_txframes_pending(_adapter *padapter);
 s32 rtw_txframes_sta_ac_pending(_adapter *padapter, struct pkt_attrib *pattrib);
 void rtw_init_hwxmits(struct hw_xmit *phwxmit, sint entry);
@@ -593,6 +820,12 @@ void rtw_free_hwxmits(_adapter *padapter);
 
 
 s32 rtw_xmit(_adapter *padapter, _pkt **pkt);
+#ifdef CONFIG_TX_MCAST2UNI
+s32 rtw_xmit_unicast(_adapter *padapter, _pkt **ppkt, u8 *da);
+#endif
+#ifdef CONFIG_RTW_TX_GSO
+u32 rtw_xmit_gso(_adapter *padapter, _pkt *segs);
+#endif
 bool xmitframe_hiq_filter(struct xmit_frame *xmitframe);
 #if defined(CONFIG_AP_MODE) || defined(CONFIG_TDLS)
 sint xmitframe_enqueue_for_sleeping_sta(_adapter *padapter, struct xmit_frame *pxmitframe);
@@ -26,7 +26,18 @@
 #include <wifi.h>
 
 #define IBSS_START_MAC_ID	2
-#define NUM_STA 32
+#define NUM_STA 32	// hardware MACID entries, also the default of rtw_max_sta
+#define NUM_STA_LIMIT	256	// upper bound of rtw_max_sta: TIM IE carries bitmap control + a 32-octet partial virtual bitmap
+
+#define STAINFO_POOL_RESERVE	4	// sta_info kept on free_sta_queue however long it idles
+#define STAINFO_IDLE_TIMEOUT	60000	// ms, a freed sta_info idle this long goes back to the slab
+
+#ifdef CONFIG_STA_LOOKUP_TABLE
+// open-addressed MAC -> sta_info table, twice max_stainfo slots rounded up to a power of 2
+#define STA_LOOKUP_DELETED	((struct sta_info *)1)
+#define STA_LOOKUP_MAX_DELETED(size)	((size) / 4)	// tombstones tolerated before an in-place rebuild
+#define STA_MAC_KEY_INVALID	(~0ULL)	// never produced by wifi_mac_key()
+#endif
 #define NUM_ACL 16
 
 
@@ -48,6 +59,20 @@ struct wlan_acl_pool {
 	_queue	acl_node_q;
 };
 
+#ifdef CONFIG_TX_MCAST2UNI
+#define MC2U_MEMBER_NUM		128
+#define MC2U_MEMBER_TIMEOUT_MS	260000	// IGMP/MLD default membership interval
+#define MC2U_GROUP_MAX_STA	16	// upper bound of rtw_mc2u_max_sta
+
+// one station subscribed to one group, learned from its IGMP/MLD reports
+struct mc2u_member {
+	u8	group[ETH_ALEN];	// multicast MAC the group maps to
+	u8	sta[ETH_ALEN];
+	u32	time;			// last report
+	u8	used;
+};
+#endif	// CONFIG_TX_MCAST2UNI
+
 typedef struct _RSSI_STA{
 	s32	UndecoratedSmoothedPWDB;
 	s32	UndecoratedSmoothedCCK;
@@ -97,6 +122,9 @@ struct sta_info {
 	_lock	lock;
 	_list	list; //free_sta_queue
 	_list	hash_list; //sta_hash
+	u16	stainfo_idx;	// slot in sta_priv.stainfo_tbl, kept across _rtw_init_stainfo
+	u32	free_time;	// when it went onto free_sta_queue
+	struct rcu_head	rcu;	// for handing it back to the slab
 	//_list asoc_list; //20061114
 	//_list sleep_list;//sleep_q
 	//_list wakeup_list;//wakeup_q
@@ -112,12 +140,19 @@ struct sta_info {
 	uint mac_id;
 	uint qos_option;
 	u8	hwaddr[ETH_ALEN];
+#ifdef CONFIG_STA_LOOKUP_TABLE
+	u64	mac_key;	// hwaddr as an integer, STA_MAC_KEY_INVALID while not in sta_lookup
+#endif
 
 	uint	ieee8021x_blocked;	//0: allowed, 1:blocked
 	uint	dot118021XPrivacy; //aes, tkip...
+	u8	no_hw_key;	// shares the bc/mc MACID, has no pairwise CAM entry: sw enc/dec only
 	union Keytype	dot11tkiptxmickey;
 	union Keytype	dot11tkiprxmickey;
 	union Keytype	dot118021x_UncstKey;
+	u32	aes_rk[AES_PRIV_SIZE / 4];	// CCMP key schedule of the pairwise key (TPK for TDLS), built where it is set
+	_lock			tkip_p1k_lock;
+	struct tkip_p1k_cache	tkip_p1k[TKIP_P1K_NUM];
 	union pn48		dot11txpn;			// PN48 used for Unicast xmit.
 #ifdef CONFIG_IEEE80211W
 	union pn48		dot11wtxpn;			// PN48 used for Unicast mgmt xmit.
@@ -353,12 +388,23 @@ struct sta_info {
 
 struct	sta_priv {
 
-	u8 *pallocated_stainfo_buf;
-	u8 *pstainfo_buf;
 	_queue	free_sta_queue;
 
+	// every sta_info currently taken from the slab, indexed by stainfo_idx
+	struct sta_info **stainfo_tbl;
+	u16 max_stainfo;	// rtw_max_sta, number of stainfo_tbl slots
+	u16 stainfo_cnt;	// slots in use
+
 	_lock sta_hash_lock;
 	_list   sta_hash[NUM_STA];
+#ifdef CONFIG_STA_LOOKUP_TABLE
+	// updated under sta_hash_lock, read under rcu_read_lock
+	struct sta_info **sta_lookup;
+	u32 sta_lookup_size;
+	u32 sta_lookup_deleted;		// STA_LOOKUP_DELETED slots
+	seqcount_t sta_lookup_seq;	// write side held across rtw_sta_lookup_rebuild
+	struct sta_info *last_sta;	// last hit of rtw_get_stainfo
+#endif
 	int asoc_sta_count;
 	_queue sleep_q;
 	_queue wakeup_q;
@@ -371,8 +417,8 @@ struct	sta_priv {
 	_list auth_list;
 	_lock asoc_list_lock;
 	_lock auth_list_lock;
-	u8 asoc_list_cnt;
-	u8 auth_list_cnt;
+	u16 asoc_list_cnt;
+	u16 auth_list_cnt;
 
 	unsigned int auth_to;  //sec, time to expire in authenticating.
 	unsigned int assoc_to; //sec, time to expire before associating.
@@ -382,14 +428,27 @@ struct	sta_priv {
 	 * AID is in the range 1-2007, so sta_aid[0] corresponders to AID 1
 	 * and so on
 	 */
-	struct sta_info *sta_aid[NUM_STA];
+	struct sta_info **sta_aid;	// max_stainfo entries
+	unsigned long *aid_bitmap;	// bit n set while AID n+1 is allocated
 
-	u16 sta_dz_bitmap;//only support 15 stations, staion aid bitmap for sleeping sta.
-	u16 tim_bitmap;//only support 15 stations, aid=0~15 mapping bit0~bit15
+	u8 *sta_dz_bitmap;//aid bitmap for sleeping sta, bit0 for bc/mc
+	u8 *tim_bitmap;//aid=0~max_stainfo mapping bit0~bitN, octet order as in the TIM IE
+	u16 tim_bitmap_len;	// octets in sta_dz_bitmap and tim_bitmap
 
 	u16 max_num_sta;
 
 	struct wlan_acl_pool acl_list;
+
+#ifdef CONFIG_TX_MCAST2UNI
+	_lock	mc2u_lock;
+	struct mc2u_member mc2u_member[MC2U_MEMBER_NUM];
+	u32	mc2u_overflow_time;	// members were lost, group membership is unknown for a timeout
+	u8	mc2u_overflow;
+	u32	mc2u_report_cnt;
+	u32	mc2u_unicast_cnt;	// frames converted for their subscribers only
+	u32	mc2u_mcast_cnt;		// sent as real multicast, no or too many subscribers
+	u32	mc2u_flood_cnt;		// link-local or unknown membership, converted for every station
+#endif	// CONFIG_TX_MCAST2UNI
 #endif
 
 };
@@ -412,11 +471,47 @@ __inline static u32 wifi_mac_hash(u8 *mac)
         return x;
 }
 
+#ifdef CONFIG_STA_LOOKUP_TABLE
+__inline static u64 wifi_mac_key(u8 *mac)
+{
+	return ((u64)mac[0] << 40) | ((u64)mac[1] << 32) | ((u64)mac[2] << 24)
+		| ((u64)mac[3] << 16) | ((u64)mac[4] << 8) | (u64)mac[5];
+}
+
+// Fibonacci hashing, spreads the vendor OUI and NIC bytes over the whole table
+__inline static u32 wifi_mac_key_hash(u64 key, u32 size)
+{
+	return (u32)((key * 0x9E3779B97F4A7C15ULL) >> 40) & (size - 1);
+}
+#endif
+
+#ifdef CONFIG_AP_MODE
+#define rtw_tim_map_set(map, id)	((map)[(id) >> 3] |= BIT((id) & 7))
+#define rtw_tim_map_clear(map, id)	((map)[(id) >> 3] &= ~BIT((id) & 7))
+#define rtw_tim_map_is_set(map, id)	((map)[(id) >> 3] & BIT((id) & 7))
+
+__inline static int _rtw_tim_map_anyone_be_set(struct sta_priv *pstapriv, u8 *map, u8 first_mask)
+{
+	int i;
+
+	if (map[0] & first_mask)
+		return _TRUE;
+	for (i = 1; i < pstapriv->tim_bitmap_len; i++)
+		if (map[i])
+			return _TRUE;
+	return _FALSE;
+}
+
+#define rtw_tim_map_anyone_be_set(pstapriv, map)	_rtw_tim_map_anyone_be_set(pstapriv, map, 0xff)
+// any sta in the map, bit0 (bc/mc) not counted
+#define rtw_tim_map_anyone_be_set_exclude_aid0(pstapriv, map)	_rtw_tim_map_anyone_be_set(pstapriv, map, 0xfe)
+#endif
+
 
 extern u32	_rtw_init_sta_priv(struct sta_priv *pstapriv);
 extern u32	_rtw_free_sta_priv(struct sta_priv *pstapriv);
 
-#define stainfo_offset_valid(offset) (offset < NUM_STA && offset >= 0)
+#define stainfo_offset_valid(stapriv, offset) ((offset) < (stapriv)->max_stainfo && (offset) >= 0)
 int rtw_stainfo_offset(struct sta_priv *stapriv, struct sta_info *sta);
 struct sta_info *rtw_get_stainfo_by_offset(struct sta_priv *stapriv, int offset);
 
@@ -424,6 +519,10 @@ extern struct sta_info *rtw_alloc_stainfo(struct	sta_priv *pstapriv, u8 *hwaddr)
 extern u32	rtw_free_stainfo(_adapter *padapter , struct sta_info *psta);
 extern void rtw_free_all_stainfo(_adapter *padapter);
 extern struct sta_info *rtw_get_stainfo(struct sta_priv *pstapriv, u8 *hwaddr);
+extern void rtw_shrink_stainfo(struct sta_priv *pstapriv);
+#ifdef CONFIG_AP_MODE
+extern uint rtw_alloc_aid(struct sta_priv *pstapriv, struct sta_info *psta);
+#endif
 extern u32 rtw_init_bcmc_stainfo(_adapter* padapter);
 extern struct sta_info* rtw_get_bcmc_stainfo(_adapter* padapter);
 extern u8 rtw_access_ctrl(_adapter *padapter, u8 *mac_addr);
@@ -59,6 +59,22 @@ void rtl8192du_set_intf_ops(struct _io_ops *pops);
 #define usb_set_intf_ops	rtl8192du_set_intf_ops
 
 void rtl8192du_recv_tasklet(void *priv);
+#ifdef CONFIG_RTW_NAPI
+int rtl8192du_recv_napi_poll(struct napi_struct *napi, int budget);
+#endif
+
+static inline void rtl8192du_recv_schedule(_adapter *padapter)
+{
+	struct recv_priv *precvpriv = &padapter->recvpriv;
+
+#ifdef CONFIG_RTW_NAPI
+	if (precvpriv->napi_en) {
+		napi_schedule(&precvpriv->napi);
+		return;
+	}
+#endif
+	tasklet_schedule(&precvpriv->recv_tasklet);
+}
 
 void rtl8192du_xmit_tasklet(void *priv);
 
@@ -25,6 +25,10 @@
 #define RTW_USB_CONTROL_MSG_TIMEOUT_TEST	10//ms
 #define RTW_USB_CONTROL_MSG_TIMEOUT	500//ms
 
+// payload of each vendor request issued by usb_write_mem(), the firmware block
+// size later Realtek USB chips download with, below VENDOR_CMD_MAX_DATA_LEN
+#define USB_WRITE_MEM_BLOCK_SIZE	196
+
 #if defined(CONFIG_VENDOR_REQ_RETRY) && defined(CONFIG_USB_VENDOR_REQ_MUTEX)
 /* vendor req retry should be in the situation when each vendor req is atomically submitted from others */
 #define MAX_USBCTRL_VENDORREQ_TIMES	10
@@ -52,7 +56,7 @@ int usb_async_write32(struct intf_hdl *pintfhdl, u32 addr, u32 val);
 unsigned int ffaddr2pipehdl(struct dvobj_priv *pdvobj, u32 addr);
 
 void usb_read_mem(struct intf_hdl *pintfhdl, u32 addr, u32 cnt, u8 *rmem);
-void usb_write_mem(struct intf_hdl *pintfhdl, u32 addr, u32 cnt, u8 *wmem);
+int usb_write_mem(struct intf_hdl *pintfhdl, u32 addr, u32 cnt, u8 *wmem);
 
 void usb_read_port_cancel(struct intf_hdl *pintfhdl);
 
@@ -59,6 +59,24 @@ extern sint rtw_endofpktfile (struct pkt_file *pfile);
 extern void rtw_os_pkt_complete(_adapter *padapter, _pkt *pkt);
 extern void rtw_os_xmit_complete(_adapter *padapter, struct xmit_frame *pxframe);
 
+#ifdef CONFIG_RTW_TX_AQM
+void rtw_os_bql_sent(_adapter *padapter, struct xmit_frame *pxframe);
+void rtw_os_bql_complete(_adapter *padapter, struct xmit_frame *pxframe);
+u8 rtw_os_pkt_ecn_mark(_pkt *pkt);
+#endif
+
+#ifdef CONFIG_USB_TX_SG
+u8 rtw_os_xmit_sg_supported(_adapter *padapter);
+u8 rtw_os_xmitframe_sg_check(_adapter *padapter, struct xmit_frame *pxmitframe);
+void rtw_os_xmitframe_sg_add(_adapter *padapter, struct xmit_frame *pxmitframe, u8 *payload);
+int rtw_os_xmitbuf_sg_map(struct xmit_buf *pxmitbuf, u8 *start, u32 cnt);
+void rtw_os_xmitbuf_sg_release(_adapter *padapter, struct xmit_buf *pxmitbuf);
+#endif
+
+#ifdef CONFIG_RTW_TX_GSO
+void rtw_os_gso_wake_queue(_adapter *padapter);
+#endif
+
 void rtw_os_wake_queue_at_free_stainfo(_adapter *padapter, int *qcnt_freed);
 
 void dump_os_queue(void *sel, _adapter *padapter);
@@ -776,6 +776,8 @@ static u8 set_pairwise_key(_adapter *padapter, struct sta_info *psta)
 
 	memcpy(psetstakey_para->key, &psta->dot118021x_UncstKey, 16);
 
+	if (psetstakey_para->algorithm == _AES_)
+		rtw_aes_key_setup(psta->aes_rk, psetstakey_para->key);
 
 	res = rtw_enqueue_cmd(pcmdpriv, ph2c);
 
@@ -832,6 +834,9 @@ static int set_group_key(_adapter *padapter, u8 *key, u8 alg, int keyid)
 
 	memcpy(&(psetkeyparm->key[0]), key, keylen);
 
+	if (alg == _AES_)
+		rtw_aes_key_setup(padapter->securitypriv.dot118021XGrpKey_rk[keyid], psetkeyparm->key);
+
 	pcmd->cmdcode = _SetKey_CMD_;
 	pcmd->parmbuf = (u8 *)psetkeyparm;
 	pcmd->cmdsz =  (sizeof(struct setkey_parm));
@@ -6923,7 +6923,7 @@ static int rtw_dbg_port(struct net_device *dev,
 							pxmitpriv->free_xmitbuf_cnt, pxmitpriv->free_xmitframe_cnt,
 							pxmitpriv->free_xmit_extbuf_cnt, pxmitpriv->free_xframe_ext_cnt,
 							precvpriv->free_recvframe_cnt);
-						DBG_871X("rx_urb_pending_cn=%d\n", precvpriv->rx_pending_cnt);
+						DBG_871X("rx_urb_pending_cn=%d\n", ATOMIC_READ(&precvpriv->rx_pending_cnt));
 					}
 					break;
 				case 0x09:
@@ -6933,7 +6933,7 @@ static int rtw_dbg_port(struct net_device *dev,
 						struct recv_reorder_ctrl *preorder_ctrl;
 
 #ifdef CONFIG_AP_MODE
-						DBG_871X("sta_dz_bitmap=0x%x, tim_bitmap=0x%x\n", pstapriv->sta_dz_bitmap, pstapriv->tim_bitmap);
+						DBG_871X("sta_dz_bitmap=%*ph, tim_bitmap=%*ph\n", pstapriv->tim_bitmap_len, pstapriv->sta_dz_bitmap, pstapriv->tim_bitmap_len, pstapriv->tim_bitmap);
 #endif
 						_enter_critical_bh(&pstapriv->sta_hash_lock, &irqL);
 
@@ -7432,6 +7432,8 @@ static u8 set_pairwise_key(_adapter *padapter, struct sta_info *psta)
 
 	memcpy(psetstakey_para->key, &psta->dot118021x_UncstKey, 16);
 
+	if (psetstakey_para->algorithm == _AES_)
+		rtw_aes_key_setup(psta->aes_rk, psetstakey_para->key);
 
 	res = rtw_enqueue_cmd(pcmdpriv, ph2c);
 
@@ -7490,6 +7492,9 @@ static int set_group_key(_adapter *padapter, u8 *key, u8 alg, int keyid)
 
 	memcpy(&(psetkeyparm->key[0]), key, keylen);
 
+	if (alg == _AES_)
+		rtw_aes_key_setup(padapter->securitypriv.dot118021XGrpKey_rk[keyid], psetkeyparm->key);
+
 	pcmd->cmdcode = _SetKey_CMD_;
 	pcmd->parmbuf = (u8 *)psetkeyparm;
 	pcmd->cmdsz =  (sizeof(struct setkey_parm));
@@ -7870,8 +7875,8 @@ static int rtw_set_beacon(struct net_device *dev, struct ieee_param *param, int
 
 	memcpy(&pstapriv->max_num_sta, param->u.bcn_ie.reserved, 2);
 
-	if((pstapriv->max_num_sta>NUM_STA) || (pstapriv->max_num_sta<=0))
-		pstapriv->max_num_sta = NUM_STA;
+	if((pstapriv->max_num_sta>pstapriv->max_stainfo) || (pstapriv->max_num_sta<=0))
+		pstapriv->max_num_sta = pstapriv->max_stainfo;
 
 
 	if(rtw_check_beacon_data(padapter, pbuf,  (len-12-2)) == _SUCCESS)// 12 = param header, 2:no packed
@@ -7946,6 +7951,13 @@ static int rtw_add_sta(struct net_device *dev, struct ieee_param *param)
 
 		//DBG_871X("rtw_add_sta(), init sta's variables, psta=%p\n", psta);
 
+		// the TIM bitmaps only cover AIDs up to rtw_max_sta
+		if (param->u.add_sta.aid > pstapriv->max_stainfo)
+		{
+			DBG_871X("rtw_add_sta(), aid %d exceeds rtw_max_sta %d\n", param->u.add_sta.aid, pstapriv->max_stainfo);
+			return -EINVAL;
+		}
+
 		psta->aid = param->u.add_sta.aid;//aid=1~2007
 
 		memcpy(psta->bssrateset, param->u.add_sta.tx_supp_rates, 16);
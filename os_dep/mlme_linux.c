@@ -442,7 +442,7 @@ void rtw_indicate_sta_assoc_event(_adapter *padapter, struct sta_info *psta)
 	if(psta==NULL)
 		return;
 
-	if(psta->aid > NUM_STA)
+	if(psta->aid == 0 || psta->aid > pstapriv->max_stainfo)
 		return;
 
 	if(pstapriv->sta_aid[psta->aid - 1] != psta)
@@ -467,7 +467,7 @@ void rtw_indicate_sta_disassoc_event(_adapter *padapter, struct sta_info *psta)
 	if(psta==NULL)
 		return;
 
-	if(psta->aid > NUM_STA)
+	if(psta->aid == 0 || psta->aid > pstapriv->max_stainfo)
 		return;
 
 	if(pstapriv->sta_aid[psta->aid - 1] != psta)
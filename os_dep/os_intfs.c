@@ -151,6 +151,7 @@ int rtw_hw_wps_pbc = 1;
 
 #ifdef CONFIG_TX_MCAST2UNI
 int rtw_mc2u_disable = 0;
+int rtw_mc2u_max_sta = 4;	// groups with more subscribers are sent as multicast
 #endif	// CONFIG_TX_MCAST2UNI
 
 int rtw_mac_phy_mode = 0; //0:by efuse, 1:smsp, 2:dmdp, 3:dmsp.
@@ -241,6 +242,8 @@ MODULE_PARM_DESC(rtw_fw_file_path, "The path of fw image");
 
 #ifdef CONFIG_TX_MCAST2UNI
 module_param(rtw_mc2u_disable, int, 0644);
+module_param(rtw_mc2u_max_sta, int, 0644);
+MODULE_PARM_DESC(rtw_mc2u_max_sta, "snooped groups with more subscribers than this (max 16) are sent as multicast");
 #endif	// CONFIG_TX_MCAST2UNI
 
 module_param(rtw_mac_phy_mode, int, 0644);
@@ -257,6 +260,38 @@ uint rtw_hiq_filter = CONFIG_RTW_HIQ_FILTER;
 module_param(rtw_hiq_filter, uint, 0644);
 MODULE_PARM_DESC(rtw_hiq_filter, "0:allow all, 1:allow special, 2:deny all");
 
+#ifdef CONFIG_USB_RX_ZEROCOPY
+uint rtw_rx_zerocopy = 1;
+module_param(rtw_rx_zerocopy, uint, 0644);
+MODULE_PARM_DESC(rtw_rx_zerocopy, "0:copy every aggregated RX frame, 1:indicate frames in place from the bulk-in buffer");
+#endif
+
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+uint rtw_tx_agg_budget = TX_AGG_BUDGET_DEF;
+module_param(rtw_tx_agg_budget, uint, 0644);
+MODULE_PARM_DESC(rtw_tx_agg_budget, "BE/BK bulk-out URB latency target in us, VI uses 1/4 and VO 1/8 of it");
+#endif
+
+#ifdef CONFIG_USB_RX_URB_SCALE
+uint rtw_rx_urb_num = 0;
+module_param(rtw_rx_urb_num, uint, 0644);
+MODULE_PARM_DESC(rtw_rx_urb_num, "0:scale posted bulk-in URBs from pipe idle gaps and RX FIFO overflows, else number of bulk-in URBs kept posted");
+#endif
+
+#ifdef CONFIG_RTW_NAPI
+uint rtw_en_napi = 1;
+module_param(rtw_en_napi, uint, 0644);
+MODULE_PARM_DESC(rtw_en_napi, "0:recv tasklet and netif_rx, 1:NAPI poll");
+
+uint rtw_en_gro = 1;
+module_param(rtw_en_gro, uint, 0644);
+MODULE_PARM_DESC(rtw_en_gro, "0:netif_receive_skb, 1:napi_gro_receive, only with rtw_en_napi");
+#endif
+
+uint rtw_max_sta = NUM_STA;
+module_param(rtw_max_sta, uint, 0644);
+MODULE_PARM_DESC(rtw_max_sta, "Station table size in AP mode, 32~256");
+
 static uint loadparam( _adapter *padapter,  _nic_hdl	pnetdev);
 int _netdev_open(struct net_device *pnetdev);
 int netdev_open (struct net_device *pnetdev);
@@ -384,6 +419,25 @@ _func_enter_;
 #endif //CONFIG_MULTI_VIR_IFACES
 
 	registry_par->hiq_filter = (u8)rtw_hiq_filter;
+
+	registry_par->max_sta = (u16)rtw_max_sta;
+
+#ifdef CONFIG_USB_RX_ZEROCOPY
+	registry_par->rx_zerocopy = (u8)rtw_rx_zerocopy;
+#endif
+
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+	registry_par->tx_agg_budget = (u32)rtw_tx_agg_budget;
+#endif
+
+#ifdef CONFIG_USB_RX_URB_SCALE
+	registry_par->rx_urb_num = (u8)rtw_rx_urb_num;
+#endif
+
+#ifdef CONFIG_RTW_NAPI
+	registry_par->en_napi = (u8)rtw_en_napi;
+	registry_par->en_gro = (u8)rtw_en_gro;
+#endif
 _func_exit_;
 
 	return status;
@@ -678,6 +732,16 @@ struct net_device *rtw_init_netdev(_adapter *old_padapter)
 
 #ifdef CONFIG_TCP_CSUM_OFFLOAD_TX
 	pnetdev->features |= NETIF_F_IP_CSUM;
+#endif
+#ifdef CONFIG_RTW_TX_GSO
+	// TSO skbs are segmented by rtw_os_xmit_gso(), checksums the hardware can't do are filled in software
+	pnetdev->features |= NETIF_F_SG | NETIF_F_IP_CSUM | NETIF_F_IPV6_CSUM | NETIF_F_TSO | NETIF_F_TSO6;
+	pnetdev->hw_features |= NETIF_F_SG | NETIF_F_IP_CSUM | NETIF_F_IPV6_CSUM | NETIF_F_TSO | NETIF_F_TSO6;
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(6, 0, 0))
+	netif_set_gso_max_segs(pnetdev, RTW_GSO_MAX_SEGS);
+#else
+	pnetdev->gso_max_segs = RTW_GSO_MAX_SEGS;
+#endif
 #endif
 	//pnetdev->tx_timeout = NULL;
 	pnetdev->watchdog_timeo = HZ*3; /* 3 second timeout */
@@ -1051,6 +1115,7 @@ _func_enter_;
 
 	//_init_timer(&(padapter->securitypriv.tkip_timer), padapter->pifp, rtw_use_tkipkey_handler, padapter);
 
+	padapter->stapriv.padapter = padapter;
 	if(_rtw_init_sta_priv(&padapter->stapriv) == _FAIL)
 	{
 		DBG_871X("Can't _rtw_init_sta_priv\n");
@@ -1058,7 +1123,6 @@ _func_enter_;
 		goto exit;
 	}
 
-	padapter->stapriv.padapter = padapter;
 	padapter->setband = GHZ24_50;
 	padapter->fix_rate = 0xFF;
 	rtw_init_bcmc_stainfo(padapter);
@@ -1096,6 +1160,12 @@ _func_enter_;
 
 #ifdef CONFIG_BR_EXT
 	_rtw_spinlock_init(&padapter->br_ext_lock);
+	if (nat25_db_init(padapter) == _FAIL)
+	{
+		DBG_871X("Can't nat25_db_init\n");
+		ret8=_FAIL;
+		goto exit;
+	}
 #endif	// CONFIG_BR_EXT
 
 exit:
@@ -1181,6 +1251,7 @@ u8 rtw_free_drv_sw(_adapter *padapter)
 	_rtw_spinlock_free(&padapter->security_key_mutex);
 
 #ifdef CONFIG_BR_EXT
+	nat25_db_deinit(padapter);
 	_rtw_spinlock_free(&padapter->br_ext_lock);
 #endif	// CONFIG_BR_EXT
 
@@ -2277,6 +2348,11 @@ static int netdev_close(struct net_device *pnetdev)
 		rtw_led_control(padapter, LED_CTL_POWER_OFF);
 	}
 
+#ifdef CONFIG_XMIT_STAGING_RING
+	// the queue is stopped and the core no longer calls ndo_start_xmit here
+	rtw_xmit_staging_purge(padapter);
+#endif
+
 #ifdef CONFIG_BR_EXT
 	//if (OPMODE & (WIFI_STATION_STATE | WIFI_ADHOC_STATE))
 	{
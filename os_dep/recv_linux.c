@@ -225,6 +225,27 @@ void rtw_hostapd_mlme_rx(_adapter *padapter, union recv_frame *precv_frame)
 #endif
 }
 
+//
+// Hand an ethernet frame to the stack. With NAPI it waits on the primary adapter's
+// rx_napi_skb_queue for rtl8192du_recv_napi_poll(), also when we are called from the
+// reorder timeout, so GRO only ever runs from the poll.
+//
+void rtw_os_recv_indicate_skb(_adapter *padapter, _pkt *pkt)
+{
+#ifdef CONFIG_RTW_NAPI
+	struct recv_priv *precvpriv = &GET_PRIMARY_ADAPTER(padapter)->recvpriv;
+
+	if (precvpriv->napi_en) {
+		pkt->dev = padapter->pnetdev;
+		skb_queue_tail(&precvpriv->rx_napi_skb_queue, pkt);
+		napi_schedule(&precvpriv->napi);
+		return;
+	}
+#endif
+
+	rtw_netif_rx(padapter->pnetdev, pkt);
+}
+
 int rtw_recv_indicatepkt(_adapter *padapter, union recv_frame *precv_frame)
 {
 	struct recv_priv *precvpriv;
@@ -282,6 +303,11 @@ _func_enter_;
 
 		//DBG_871X("bmcast=%d\n", bmcast);
 
+#ifdef CONFIG_TX_MCAST2UNI
+		if (bmcast && precv_frame->u.hdr.psta)
+			rtw_mc2u_snoop(padapter, precv_frame->u.hdr.psta->hwaddr, skb->data, skb->len);
+#endif
+
 		if(_rtw_memcmp(pattrib->dst, myid(&padapter->eeprompriv), ETH_ALEN)==_FALSE)
 		{
 			//DBG_871X("not ap psta=%p, addr=%pM\n", psta, pattrib->dst);
@@ -373,7 +399,7 @@ _func_enter_;
 	skb->dev = padapter->pnetdev;
 	skb->protocol = eth_type_trans(skb, padapter->pnetdev);
 
-	rtw_netif_rx(padapter->pnetdev, skb);
+	rtw_os_recv_indicate_skb(padapter, skb);
 
 _recv_indicatepkt_end:
 
@@ -435,6 +435,19 @@ const struct rtw_proc_hdl adapter_proc_hdls [] = {
 	{"ap_info", proc_get_ap_info, NULL},
 	{"adapter_state", proc_get_adapter_state, NULL},
 	{"trx_info", proc_get_trx_info, NULL},
+	{"io_stat", proc_get_io_stat, NULL},
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+	{"tx_agg", proc_get_tx_agg, proc_set_tx_agg},
+#endif
+#ifdef CONFIG_USB_RX_AGG_TUNE
+	{"rx_agg", proc_get_rx_agg, proc_set_rx_agg},
+#endif
+#ifdef CONFIG_USB_RX_URB_SCALE
+	{"rx_urb", proc_get_rx_urb, proc_set_rx_urb},
+#endif
+#ifdef CONFIG_RTW_TX_AQM
+	{"tx_aqm", proc_get_tx_aqm, proc_set_tx_aqm},
+#endif
 	{"rate_ctl", proc_get_rate_ctl, proc_set_rate_ctl},
 	{"mac_qinfo", proc_get_mac_qinfo, NULL},
 	{"cam", proc_get_cam, proc_set_cam},
@@ -457,6 +470,9 @@ const struct rtw_proc_hdl adapter_proc_hdls [] = {
 
 #ifdef CONFIG_AP_MODE
 	{"all_sta_info", proc_get_all_sta_info, NULL},
+#ifdef CONFIG_TX_MCAST2UNI
+	{"mc2u", proc_get_mc2u, NULL},
+#endif
 #endif
 
 #ifdef CONFIG_FIND_BEST_CHANNEL
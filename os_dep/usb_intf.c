@@ -296,6 +296,7 @@ _func_enter_;
 			} else if (RT_usb_endpoint_is_int_in(pendp_desc)) {
 				DBG_871X("RT_usb_endpoint_is_int_in = %x, Interval = %x\n", RT_usb_endpoint_num(pendp_desc),pendp_desc->bInterval);
 				pdvobjpriv->RtNumInPipes++;
+				pdvobjpriv->int_in_ep = RT_usb_endpoint_num(pendp_desc);
 			} else if (RT_usb_endpoint_is_bulk_out(pendp_desc)) {
 				DBG_871X("RT_usb_endpoint_is_bulk_out = %x\n", RT_usb_endpoint_num(pendp_desc));
 				pdvobjpriv->RtNumOutPipes++;
@@ -19,6 +19,7 @@
 #define _USB_OPS_LINUX_C_
 
 #include <drv_types.h>
+#include <usb_ops.h>
 #include <usb_ops_linux.h>
 #include <rtw_sreset.h>
 
@@ -170,7 +171,7 @@ unsigned int ffaddr2pipehdl(struct dvobj_priv *pdvobj, u32 addr)
 		pipe=usb_rcvbulkpipe(pusbd, pHalData->RtBulkInPipe);
 
 	} else if (addr == RECV_INT_IN_ADDR) {
-		pipe=usb_rcvbulkpipe(pusbd, pHalData->RtIntInPipe);
+		pipe=usb_rcvintpipe(pusbd, pHalData->RtIntInPipe);
 
 	} else if (addr < HW_QUEUE_ENTRY) {
 		ep_num = pHalData->Queue2EPNum[addr];
@@ -269,14 +270,145 @@ static u32 usb_bulkout_zero(struct intf_hdl *pintfhdl, u32 addr)
 
 }
 
-void usb_read_mem(struct intf_hdl *pintfhdl, u32 addr, u32 cnt, u8 *rmem)
+struct usb_write_mem_ctx {
+	atomic_t err_cnt;
+	int status;
+};
+
+static void usb_write_mem_complete(struct urb *purb, struct pt_regs *regs)
 {
+	struct usb_write_mem_ctx *ctx = (struct usb_write_mem_ctx *)purb->context;
 
+	if (purb->status) {
+		ctx->status = purb->status;
+		atomic_inc(&ctx->err_cnt);
+	}
 }
 
-void usb_write_mem(struct intf_hdl *pintfhdl, u32 addr, u32 cnt, u8 *wmem)
+/*
+ * Write cnt bytes starting at addr as back-to-back vendor requests of
+ * USB_WRITE_MEM_BLOCK_SIZE. All control URBs are queued on ep0 at once and
+ * reaped with a single wait, so the transfer is not paced by one round trip
+ * per block as with rtw_writeN(). Used for firmware download, which is
+ * checksummed by the chip, so a failed block fails the whole call and is
+ * not retried here. usb_vendor_req_mutex is held for the whole burst, so no
+ * register access from another context lands between two blocks.
+ */
+int usb_write_mem(struct intf_hdl *pintfhdl, u32 addr, u32 cnt, u8 *wmem)
 {
+	_adapter *padapter = pintfhdl->padapter;
+	struct dvobj_priv *pdvobjpriv = adapter_to_dvobj(padapter);
+	struct usb_device *udev = pdvobjpriv->pusbdev;
+	struct usb_write_mem_ctx ctx;
+	struct usb_anchor anchor;
+	struct usb_ctrlrequest *dr;
+	struct urb *purb;
+	u8 *pbuf, *pdata;
+	u32 blocks, bufsz, i, offset, len;
+	int status = 0;
+	int ret = _FAIL;
+
+#ifdef CONFIG_CONCURRENT_MODE
+	if(padapter->adapter_type > PRIMARY_ADAPTER)
+	{
+		padapter = padapter->pbuddy_adapter;
+		pdvobjpriv = adapter_to_dvobj(padapter);
+		udev = pdvobjpriv->pusbdev;
+	}
+#endif
+
+	if((padapter->bSurpriseRemoved) ||(padapter->pwrctrlpriv.pnp_bstop_trx)){
+		RT_TRACE(_module_hci_ops_os_c_,_drv_err_,("usb_write_mem:(padapter->bSurpriseRemoved ||adapter->pwrctrlpriv.pnp_bstop_trx)!!!\n"));
+		goto exit;
+	}
+
+	if (cnt == 0) {
+		ret = _SUCCESS;
+		goto exit;
+	}
+
+	// setup packets first, then a DMA-able copy of the data
+	blocks = (cnt + USB_WRITE_MEM_BLOCK_SIZE - 1) / USB_WRITE_MEM_BLOCK_SIZE;
+	bufsz = blocks * sizeof(struct usb_ctrlrequest) + cnt;
+	pbuf = kzalloc(bufsz, GFP_KERNEL);
+	if (pbuf == NULL) {
+		DBG_8192C("[%s] alloc %u bytes fail\n", __FUNCTION__, bufsz);
+		goto exit;
+	}
+	dr = (struct usb_ctrlrequest *)pbuf;
+	pdata = pbuf + blocks * sizeof(struct usb_ctrlrequest);
+	memcpy(pdata, wmem, cnt);
+
+	atomic_set(&ctx.err_cnt, 0);
+	ctx.status = 0;
+	init_usb_anchor(&anchor);
+
+#ifdef CONFIG_USB_VENDOR_REQ_MUTEX
+	_enter_critical_mutex(&pdvobjpriv->usb_vendor_req_mutex, NULL);
+#endif
+
+	for (i = 0, offset = 0; i < blocks; i++, offset += len) {
+		len = cnt - offset;
+		if (len > USB_WRITE_MEM_BLOCK_SIZE)
+			len = USB_WRITE_MEM_BLOCK_SIZE;
+
+		purb = usb_alloc_urb(0, GFP_KERNEL);
+		if (purb == NULL) {
+			status = -ENOMEM;
+			break;
+		}
+
+		dr[i].bRequestType = REALTEK_USB_VENQT_WRITE;
+		dr[i].bRequest = REALTEK_USB_VENQT_CMD_REQ;
+		dr[i].wValue = cpu_to_le16((addr + offset) & 0xffff);
+		dr[i].wIndex = cpu_to_le16(REALTEK_USB_VENQT_CMD_IDX);
+		dr[i].wLength = cpu_to_le16(len);
 
+		usb_fill_control_urb(purb, udev, usb_sndctrlpipe(udev, 0), (unsigned char *)&dr[i],
+			pdata + offset, len, usb_write_mem_complete, &ctx);
+
+		usb_anchor_urb(purb, &anchor);
+		status = usb_submit_urb(purb, GFP_KERNEL);
+		if (status) {
+			usb_unanchor_urb(purb);
+			usb_free_urb(purb);
+			break;
+		}
+		// the anchor holds its own reference until the URB completes
+		usb_free_urb(purb);
+
+		padapter->iopriv.vendor_req_cnt++;
+	}
+
+	if (!usb_wait_anchor_empty_timeout(&anchor, RTW_USB_CONTROL_MSG_TIMEOUT)) {
+		usb_kill_anchored_urbs(&anchor);
+		if (status == 0)
+			status = -ETIMEDOUT;
+	}
+
+#ifdef CONFIG_USB_VENDOR_REQ_MUTEX
+	_exit_critical_mutex(&pdvobjpriv->usb_vendor_req_mutex, NULL);
+#endif
+
+	if (status == 0 && atomic_read(&ctx.err_cnt))
+		status = ctx.status;
+
+	rtw_mfree(pbuf, bufsz);
+
+	if (status == 0) {
+		rtw_reset_continual_urb_error(pdvobjpriv);
+		ret = _SUCCESS;
+	} else {
+		DBG_8192C("[%s] addr 0x%x, %u bytes fail, status:%d, %u/%u blocks failed\n"
+			, __FUNCTION__, addr, cnt, status, atomic_read(&ctx.err_cnt), blocks);
+
+		if (status == -ESHUTDOWN || status == -ENODEV
+			|| rtw_inc_and_chk_continual_urb_error(pdvobjpriv) == _TRUE)
+			padapter->bSurpriseRemoved = _TRUE;
+	}
+
+exit:
+	return ret;
 }
 
 
@@ -302,7 +434,9 @@ void usb_read_port_cancel(struct intf_hdl *pintfhdl)
 	}
 
 #ifdef CONFIG_USB_INTERRUPT_IN_PIPE
-	usb_kill_urb(padapter->recvpriv.int_in_urb);
+	padapter->recvpriv.int_in_active = _FALSE;
+	if (padapter->recvpriv.int_in_urb)
+		usb_kill_urb(padapter->recvpriv.int_in_urb);
 #endif
 }
 
@@ -391,7 +525,10 @@ _func_enter_;
 
 
 	if (purb->status==0) {
-
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+		rtw_hal_tx_agg_update(padapter, pxmitbuf->flags,
+			(u32)ktime_us_delta(ktime_get(), pxmitbuf->submit_time), pxmitbuf->agg_stop);
+#endif
 	} else {
 		RT_TRACE(_module_hci_ops_os_c_,_drv_err_,("usb_write_port_complete : purb->status(%d) != 0 \n", purb->status));
 		DBG_871X("###=> urb_write_port_complete status(%d)\n",purb->status);
@@ -549,6 +686,19 @@ _func_enter_;
 #endif
 
 
+#ifdef CONFIG_USB_TX_SG
+	purb->sg = NULL;
+	purb->num_sgs = 0;
+	if (pxmitbuf->sg_pkt_cnt) {
+		usb_fill_bulk_urb(purb, pusbd, pipe,
+				NULL,
+				cnt,
+				usb_write_port_complete,
+				pxmitbuf);//context is pxmitbuf
+		purb->sg = pxmitbuf->sg;
+		purb->num_sgs = rtw_os_xmitbuf_sg_map(pxmitbuf, pxmitframe->buf_addr, cnt);
+	} else
+#endif
 	usb_fill_bulk_urb(purb, pusbd, pipe,
 				pxmitframe->buf_addr, //= pxmitbuf->pbuf
 				cnt,
@@ -574,6 +724,10 @@ _func_enter_;
         }
 #endif
 
+#ifdef CONFIG_USB_TX_AGG_ADAPTIVE
+	pxmitbuf->submit_time = ktime_get();
+#endif
+
 	status = usb_submit_urb(purb, GFP_ATOMIC);
 	if (!status) {
 		#ifdef DBG_CONFIG_ERROR_DETECT
@@ -31,6 +31,9 @@
 #include <xmit_osdep.h>
 #include <osdep_intf.h>
 #include <circ_buf.h>
+#ifdef CONFIG_RTW_TX_AQM
+#include <net/inet_ecn.h>
+#endif
 
 #define DBG_DUMP_OS_QUEUE_CTL 0
 
@@ -222,13 +225,50 @@ inline static bool rtw_os_need_stop_queue(_adapter *padapter, u16 qidx)
 {
 	struct xmit_priv *pxmitpriv = &padapter->xmitpriv;
 #if (LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,35))
-	if (pxmitpriv->hwxmits[qidx].accnt > NR_XMITFRAME/2) {
+	int accnt = pxmitpriv->hwxmits[qidx].accnt;
+
+#ifdef CONFIG_XMIT_STAGING_RING
+	accnt += rtw_xmit_staging_cnt(pxmitpriv, qidx);
+#endif
+	if (accnt > NR_XMITFRAME/2) {
 			return _TRUE;
 	}
 #endif
 	return _FALSE;
 }
 
+#ifdef CONFIG_RTW_TX_GSO
+/*
+ * A subqueue stopped for a GSO skb has nothing in hwxmits[].accnt to wake it,
+ * so rtw_free_xmitframe calls here once the pool could take any GSO skb again.
+ */
+void rtw_os_gso_wake_queue(_adapter *padapter)
+{
+	struct xmit_priv *pxmitpriv = &padapter->xmitpriv;
+	u16 qidx;
+
+	if (pxmitpriv->free_xmitframe_cnt < RTW_GSO_MAX_SEGS)
+		return;
+
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,35))
+	for (qidx = 0; qidx < 4; qidx++) {
+		if (test_and_clear_bit(qidx, &pxmitpriv->tx_gso_stopped)) {
+			if (DBG_DUMP_OS_QUEUE_CTL)
+				DBG_871X(FUNC_ADPT_FMT": netif_wake_subqueue[%d]\n", FUNC_ADPT_ARG(padapter), qidx);
+			netif_wake_subqueue(padapter->pnetdev, qidx);
+		}
+	}
+#else
+	qidx = 0;
+	if (test_and_clear_bit(qidx, &pxmitpriv->tx_gso_stopped)) {
+		if (DBG_DUMP_OS_QUEUE_CTL)
+			DBG_871X(FUNC_ADPT_FMT": netif_wake_queue\n", FUNC_ADPT_ARG(padapter));
+		netif_wake_queue(padapter->pnetdev);
+	}
+#endif
+}
+#endif //CONFIG_RTW_TX_GSO
+
 void rtw_os_pkt_complete(_adapter *padapter, _pkt *pkt)
 {
 #if (LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,35))
@@ -259,6 +299,158 @@ void rtw_os_xmit_complete(_adapter *padapter, struct xmit_frame *pxframe)
 	pxframe->pkt = NULL;
 }
 
+#ifdef CONFIG_RTW_TX_AQM
+/*
+ * Byte queue limits of the netdev subqueues. A data frame is charged when
+ * rtw_xmit() accepts it and discharged when it is freed or parked for a dozing
+ * station, so the limit covers the staging ring and tx_servq backlog.
+ */
+void rtw_os_bql_sent(_adapter *padapter, struct xmit_frame *pxframe)
+{
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(3,3,0))
+	_pkt *pkt = pxframe->pkt;
+
+	pxframe->bql_qidx = skb_get_queue_mapping(pkt);
+	pxframe->bql_len = pkt->len;
+	netdev_tx_sent_queue(netdev_get_tx_queue(padapter->pnetdev, pxframe->bql_qidx), pkt->len);
+#endif
+}
+
+void rtw_os_bql_complete(_adapter *padapter, struct xmit_frame *pxframe)
+{
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(3,3,0))
+	struct xmit_priv *pxmitpriv = &padapter->xmitpriv;
+	_irqL irqL;
+
+	if (pxframe->bql_len == 0)
+		return;
+
+	// frames are freed from the tasklet, the xmit thread and the cmd thread
+	_enter_critical_bh(&pxmitpriv->bql_lock, &irqL);
+	netdev_tx_completed_queue(netdev_get_tx_queue(padapter->pnetdev, pxframe->bql_qidx), 1, pxframe->bql_len);
+	_exit_critical_bh(&pxmitpriv->bql_lock, &irqL);
+
+	pxframe->bql_len = 0;
+#endif
+}
+
+// set CE on an ECN capable IPv4/IPv6 packet, _FALSE if it has to be dropped instead
+u8 rtw_os_pkt_ecn_mark(_pkt *pkt)
+{
+	if (pkt == NULL || skb_network_offset(pkt) <= 0)
+		return _FALSE;
+
+	return INET_ECN_set_ce(pkt) ? _TRUE : _FALSE;
+}
+#endif //CONFIG_RTW_TX_AQM
+
+#ifdef CONFIG_USB_TX_SG
+u8 rtw_os_xmit_sg_supported(_adapter *padapter)
+{
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(3,15,0))
+	struct usb_bus *bus = adapter_to_dvobj(padapter)->pusbdev->bus;
+
+	// payload segments are not multiples of wMaxPacketSize
+	if (bus->no_sg_constraint && bus->sg_tablesize >= XMITBUF_SG_NUM)
+		return _TRUE;
+#endif
+	return _FALSE;
+}
+
+/*
+ * Whether the payload of this data frame can be sent from the skb instead of
+ * being copied into the xmitbuf. The driver must not touch the payload
+ * afterwards: no software encryption, no TKIP MIC and no fragmentation.
+ */
+u8 rtw_os_xmitframe_sg_check(_adapter *padapter, struct xmit_frame *pxmitframe)
+{
+	struct xmit_priv *pxmitpriv = &padapter->xmitpriv;
+	struct pkt_attrib *pattrib = &pxmitframe->attrib;
+	struct xmit_buf *pxmitbuf = pxmitframe->pxmitbuf;
+	_pkt *pkt = pxmitframe->pkt;
+
+	if (!pxmitpriv->tx_sg_en || pkt == NULL || pxmitbuf == NULL)
+		return _FALSE;
+
+	if (pxmitbuf->sg_pkt_cnt >= XMITBUF_SG_PKT_NUM)
+		return _FALSE;
+
+	if (pattrib->bswenc || pattrib->encrypt == _TKIP_)
+		return _FALSE;
+
+	if (!IS_MCAST(pattrib->ra) &&
+	    pattrib->hdrlen + pattrib->iv_len + SNAP_SIZE + sizeof(u16) + pattrib->pktlen > pxmitpriv->frag_len - 4)
+		return _FALSE;
+
+	if (skb_is_nonlinear(pkt) || pkt->len != pattrib->pkt_hdrlen + pattrib->pktlen)
+		return _FALSE;
+
+	return _TRUE;
+}
+
+// hand the skb over to the xmitbuf, it is freed when the URB completes
+void rtw_os_xmitframe_sg_add(_adapter *padapter, struct xmit_frame *pxmitframe, u8 *payload)
+{
+	struct xmit_priv *pxmitpriv = &padapter->xmitpriv;
+	struct pkt_attrib *pattrib = &pxmitframe->attrib;
+	struct xmit_buf *pxmitbuf = pxmitframe->pxmitbuf;
+	struct xmitbuf_sg_pkt *psg_pkt = &pxmitbuf->sg_pkt[pxmitbuf->sg_pkt_cnt++];
+
+	psg_pkt->pkt = pxmitframe->pkt;
+	psg_pkt->data = pxmitframe->pkt->data + pattrib->pkt_hdrlen;
+	psg_pkt->offset = payload - pxmitbuf->pbuf;
+	psg_pkt->len = pattrib->pktlen;
+
+	pxmitframe->pkt = NULL;
+
+	pxmitpriv->tx_sg_pkt_cnt++;
+	pxmitpriv->tx_sg_bytes += pattrib->pktlen;
+}
+
+/*
+ * Build the scatterlist for the cnt bytes starting at start: the xmitbuf
+ * between payloads (descriptors, headers, IVs and padding) and the payloads
+ * themselves from the skbs. Returns the number of entries.
+ */
+int rtw_os_xmitbuf_sg_map(struct xmit_buf *pxmitbuf, u8 *start, u32 cnt)
+{
+	struct scatterlist *sg = pxmitbuf->sg;
+	u8 *cur = start, *end = start + cnt;
+	int i, nents = 0;
+
+	sg_init_table(sg, XMITBUF_SG_NUM);
+
+	for (i = 0; i < pxmitbuf->sg_pkt_cnt; i++) {
+		struct xmitbuf_sg_pkt *psg_pkt = &pxmitbuf->sg_pkt[i];
+		u8 *hole = pxmitbuf->pbuf + psg_pkt->offset;
+
+		if (hole > cur)
+			sg_set_buf(&sg[nents++], cur, hole - cur);
+		sg_set_buf(&sg[nents++], psg_pkt->data, psg_pkt->len);
+		cur = hole + psg_pkt->len;
+	}
+
+	if (end > cur)
+		sg_set_buf(&sg[nents++], cur, end - cur);
+
+	sg_mark_end(&sg[nents - 1]);
+
+	return nents;
+}
+
+void rtw_os_xmitbuf_sg_release(_adapter *padapter, struct xmit_buf *pxmitbuf)
+{
+	int i;
+
+	for (i = 0; i < pxmitbuf->sg_pkt_cnt; i++) {
+		rtw_os_pkt_complete(padapter, pxmitbuf->sg_pkt[i].pkt);
+		pxmitbuf->sg_pkt[i].pkt = NULL;
+	}
+
+	pxmitbuf->sg_pkt_cnt = 0;
+}
+#endif //CONFIG_USB_TX_SG
+
 void rtw_os_xmit_schedule(_adapter *padapter)
 {
 	_irqL  irqL;
@@ -324,21 +516,67 @@ void rtw_os_wake_queue_at_free_stainfo(_adapter *padapter, int *qcnt_freed)
 }
 
 #ifdef CONFIG_TX_MCAST2UNI
+static void rtw_mc2u_xmit(_adapter *padapter, struct sk_buff *skb, u8 *da)
+{
+	struct xmit_priv *pxmitpriv = &padapter->xmitpriv;
+	struct sk_buff *newskb;
+	s32 res;
+
+	// the data is shared, the destination goes in the attrib only
+	newskb = rtw_skb_clone(skb);
+	if (newskb == NULL) {
+		DBG_871X("%s-%d: rtw_skb_clone() failed!\n", __FUNCTION__, __LINE__);
+		pxmitpriv->tx_drop++;
+		return;
+	}
+
+	res = rtw_xmit_unicast(padapter, &newskb, da);
+	if (res < 0) {
+		DBG_871X("%s()-%d: rtw_xmit() return error!\n", __FUNCTION__, __LINE__);
+		pxmitpriv->tx_drop++;
+		rtw_skb_free(newskb);
+	} else
+		pxmitpriv->tx_pkts++;
+}
+
 int rtw_mlcst2unicst(_adapter *padapter, struct sk_buff *skb)
 {
+	extern int rtw_mc2u_max_sta;
 	struct	sta_priv *pstapriv = &padapter->stapriv;
-	struct xmit_priv *pxmitpriv = &padapter->xmitpriv;
 	_irqL	irqL;
 	_list	*phead, *plist;
-	struct sk_buff *newskb;
 	struct sta_info *psta = NULL;
-	u8 chk_alive_num = 0;
-	char chk_alive_list[NUM_STA];
+	u16 chk_alive_num = 0;
+	u8 chk_alive_list[NUM_STA_LIMIT];
+	u8 members[MC2U_GROUP_MAX_STA][ETH_ALEN];
 	u8 bc_addr[6]={0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
 	u8 null_addr[6]={0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+	int max_sta = rtw_mc2u_max_sta;
+	int i, num;
+
+	if (max_sta > MC2U_GROUP_MAX_STA)
+		max_sta = MC2U_GROUP_MAX_STA;
+
+	// only the linear part can be read through skb->data
+	num = rtw_mc2u_get_members(padapter, skb->data, skb_headlen(skb), members, max_sta);
+	if (num >= 0) {
+		// nobody to convert for, or cheaper as one multicast at the basic rate
+		if (num == 0 || num > max_sta) {
+			pstapriv->mc2u_mcast_cnt++;
+			return _FALSE;	// Caller shall tx this multicast frame via normal way.
+		}
 
-	int i;
-	s32	res;
+		for (i = 0; i < num; i++) {
+			/* avoid come from STA1 and send back STA1 */
+			if (_rtw_memcmp(members[i], &skb->data[6], 6) == _TRUE)
+				continue;
+			rtw_mc2u_xmit(padapter, skb, members[i]);
+		}
+
+		pstapriv->mc2u_unicast_cnt++;
+		rtw_skb_free(skb);
+		return _TRUE;
+	}
 
 	_enter_critical_bh(&pstapriv->asoc_list_lock, &irqL);
 	phead = &pstapriv->asoc_list;
@@ -351,7 +589,7 @@ int rtw_mlcst2unicst(_adapter *padapter, struct sk_buff *skb)
 		plist = get_next(plist);
 
 		stainfo_offset = rtw_stainfo_offset(pstapriv, psta);
-		if (stainfo_offset_valid(stainfo_offset)) {
+		if (stainfo_offset_valid(pstapriv, stainfo_offset)) {
 			chk_alive_list[chk_alive_num++] = stainfo_offset;
 		}
 	}
@@ -361,37 +599,59 @@ int rtw_mlcst2unicst(_adapter *padapter, struct sk_buff *skb)
 		psta = rtw_get_stainfo_by_offset(pstapriv, chk_alive_list[i]);
 
 		/* avoid come from STA1 and send back STA1 */
-		if (_rtw_memcmp(psta->hwaddr, &skb->data[6], 6) == _TRUE
+		if (psta == NULL
+			|| _rtw_memcmp(psta->hwaddr, &skb->data[6], 6) == _TRUE
 			|| _rtw_memcmp(psta->hwaddr, null_addr, 6) == _TRUE
 			|| _rtw_memcmp(psta->hwaddr, bc_addr, 6) == _TRUE
 		)
 			continue;
 
-		newskb = rtw_skb_copy(skb);
-
-		if (newskb) {
-			memcpy(newskb->data, psta->hwaddr, 6);
-			res = rtw_xmit(padapter, &newskb);
-			if (res < 0) {
-				DBG_871X("%s()-%d: rtw_xmit() return error!\n", __FUNCTION__, __LINE__);
-				pxmitpriv->tx_drop++;
-				rtw_skb_free(newskb);
-			} else
-				pxmitpriv->tx_pkts++;
-		} else {
-			DBG_871X("%s-%d: rtw_skb_copy() failed!\n", __FUNCTION__, __LINE__);
-			pxmitpriv->tx_drop++;
-			//rtw_skb_free(skb);
-			return _FALSE;	// Caller shall tx this multicast frame via normal way.
-		}
+		rtw_mc2u_xmit(padapter, skb, psta->hwaddr);
 	}
 
+	pstapriv->mc2u_flood_cnt++;
 	rtw_skb_free(skb);
 	return _TRUE;
 }
 #endif	// CONFIG_TX_MCAST2UNI
 
 
+#ifdef CONFIG_RTW_TX_GSO
+/*
+ * Split a TSO skb here instead of letting the stack do it in front of every
+ * ndo_start_xmit. Segments keep page fragments of the original, checksums are
+ * filled in by software unless the hardware does TCP/IPv4.
+ */
+static int rtw_os_xmit_gso(_adapter *padapter, _pkt *pkt)
+{
+	struct xmit_priv *pxmitpriv = &padapter->xmitpriv;
+	netdev_features_t features = NETIF_F_SG;
+	_pkt *segs, *seg;
+	u32 queued;
+
+#ifdef CONFIG_TCP_CSUM_OFFLOAD_TX
+	if (pkt->protocol == htons(ETH_P_IP))
+		features |= NETIF_F_IP_CSUM;
+#endif
+
+	segs = skb_gso_segment(pkt, features);
+	if (IS_ERR_OR_NULL(segs))
+		return _FAIL;
+
+	for (seg = segs; seg != NULL; seg = seg->next)
+		rtw_mstat_update(MSTAT_TYPE_SKB, MSTAT_ALLOC_SUCCESS, seg->truesize);
+
+	queued = rtw_xmit_gso(padapter, segs);
+
+	// the segments own references to its pages, the super-packet itself is done
+	rtw_os_pkt_complete(padapter, pkt);
+
+	pxmitpriv->tx_pkts += queued;
+
+	return _SUCCESS;
+}
+#endif //CONFIG_RTW_TX_GSO
+
 int _rtw_xmit_entry(_pkt *pkt, _nic_hdl pnetdev)
 {
 	_adapter *padapter = (_adapter *)rtw_netdev_priv(pnetdev);
@@ -420,6 +680,43 @@ _func_enter_;
 	if (rtw_check_xmit_resource(padapter, pkt) == _TRUE)
 		return NETDEV_TX_BUSY;
 
+#ifdef CONFIG_RTW_TX_GSO
+	if (skb_is_gso(pkt)) {
+		// all segments or none, a partly sent super-packet only costs retransmissions
+		if (pxmitpriv->free_xmitframe_cnt < skb_shinfo(pkt)->gso_segs) {
+			pxmitpriv->tx_gso_busy++;
+		#if (LINUX_VERSION_CODE>=KERNEL_VERSION(2,6,35))
+			queue = skb_get_queue_mapping(pkt);
+			netif_stop_subqueue(padapter->pnetdev, queue);
+			set_bit(queue, &pxmitpriv->tx_gso_stopped);
+		#else
+			netif_stop_queue(padapter->pnetdev);
+			set_bit(0, &pxmitpriv->tx_gso_stopped);
+		#endif
+			// frames freed before the bit was set didn't see it
+			smp_mb();
+			rtw_os_gso_wake_queue(padapter);
+			return NETDEV_TX_BUSY;
+		}
+
+		if (rtw_os_xmit_gso(padapter, pkt) == _FAIL) {
+			#ifdef DBG_TX_DROP_FRAME
+			DBG_871X("DBG_TX_DROP_FRAME %s skb_gso_segment fail\n", __FUNCTION__);
+			#endif
+			goto drop_packet;
+		}
+		goto exit;
+	}
+
+	// checksum offload is advertised along with TSO, finish what the hardware doesn't do
+	if (pkt->ip_summed == CHECKSUM_PARTIAL
+	#ifdef CONFIG_TCP_CSUM_OFFLOAD_TX
+		&& pkt->protocol != htons(ETH_P_IP)
+	#endif
+		&& skb_checksum_help(pkt))
+		goto drop_packet;
+#endif //CONFIG_RTW_TX_GSO
+
 #ifdef CONFIG_TX_MCAST2UNI
 	if ( !rtw_mc2u_disable
 		&& check_fwstate(pmlmepriv, WIFI_AP_STATE) == _TRUE